@@ -6,6 +6,7 @@
 #include "AccountManagerPopup.hpp"
 #include "FirebaseAuth.hpp"
 #include "BetterSaveLogger.hpp"
+#include "RateLimiter.hpp"
 
 AccountManagerPopup* AccountManagerPopup::create() {
     auto ret = new AccountManagerPopup();
@@ -131,39 +132,37 @@ void AccountManagerPopup::deleteAllUserData() {
     showStatus("Deleting data...", {255, 255, 100});
     
     std::string userId = FirebaseAuth::get()->getUserId();
-    std::string token = FirebaseAuth::get()->getIdToken();
     
     BetterSaveLogger::get()->info("AccountManager", "Deleting all user data");
     
     // Delete saveData
-    std::string saveDataUrl = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/users/{}/saveData.json?auth={}",
-        userId, token
-    );
-    
-    // Delete by setting to null (Firebase REST API)
-    web::WebRequest req1 = web::WebRequest();
-    req1.userAgent("");
-    matjson::Value nullValue;
-    req1.bodyJSON(nullValue);
-    
-    req1.patch(saveDataUrl).listen([this, userId, token](web::WebResponse* resp) {
+    std::string saveDataUrl = FirebaseAuth::get()->getDatabaseUrl(fmt::format("users/{}/saveData", userId));
+    
+    // Delete by setting to null (Firebase REST API), through the shared database throttle
+    RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [saveDataUrl]() -> std::optional<web::WebTask> {
+        web::WebRequest req1 = web::WebRequest();
+        req1.userAgent("");
+        matjson::Value nullValue;
+        req1.bodyJSON(nullValue);
+        return req1.patch(saveDataUrl);
+    }, [this, userId](web::WebResponse* resp) {
         if (resp->ok()) {
             BetterSaveLogger::get()->info("AccountManager", "Deleted saveData");
             
-            // Delete chunks
-            std::string chunksUrl = fmt::format(
-                "https://gdbettersave-default-rtdb.firebaseio.com/users/{}/chunks.json?auth={}",
-                userId, token
-            );
+            // Delete chunks, with the generations, index pages and key nodes they're kept in
+            std::string chunksUrl = FirebaseAuth::get()->getDatabaseUrl(fmt::format("users/{}", userId));
             
             // Delete by setting to null (Firebase REST API)
-            web::WebRequest req2 = web::WebRequest();
-            req2.userAgent("");
-            matjson::Value nullValue;
-            req2.bodyJSON(nullValue);
-            
-            req2.patch(chunksUrl).listen([this](web::WebResponse* resp2) {
+            RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [chunksUrl]() -> std::optional<web::WebTask> {
+                web::WebRequest req2 = web::WebRequest();
+                req2.userAgent("");
+                matjson::Value saveParts;
+                for (const char* part : {"generations", "chunks", "pages", "keys"}) {
+                    saveParts[part] = matjson::Value();
+                }
+                req2.bodyJSON(saveParts);
+                return req2.patch(chunksUrl);
+            }, [this](web::WebResponse* resp2) {
                 if (resp2->ok()) {
                     showStatus("All data deleted successfully!", {100, 255, 100});
                     BetterSaveLogger::get()->success("AccountManager", "All user data deleted");
@@ -219,7 +218,7 @@ void AccountManagerPopup::deleteFirebaseAccount() {
         } else {
             showStatus("Error deleting account", {255, 100, 100});
             auto error = resp->string().unwrapOr("Unknown error");
-            BetterSaveLogger::get()->error("AccountManager", fmt::format("Failed to delete account: {}", error));
+            BetterSaveLogger::get()->error("AccountManager", "Failed to delete account: {}", error);
             
             FLAlertLayer::create(
                 "Error",
@@ -8,6 +8,8 @@
 #include "FirebaseAuth.hpp"
 #include "BetterSaveLogger.hpp"
 #include "ProgressPopup.hpp"
+#include "RateLimiter.hpp"
+#include "Awaitables.hpp"
 #include <filesystem>
 #include <fstream>
 
@@ -148,16 +150,14 @@ void AdminPanel::onUnbanAccount(CCObject*) {
 void AdminPanel::onViewBannedList(CCObject*) {
     showStatus("Loading banned users...", {255, 255, 100});
     
-    std::string token = FirebaseAuth::get()->getIdToken();
-    std::string url = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/banned.json?auth={}",
-        token
-    );
-    
-    web::WebRequest req = web::WebRequest();
-    req.userAgent("");
+    std::string url = FirebaseAuth::get()->getDatabaseUrl("banned");
     
-    req.get(url).listen([this](web::WebResponse* resp) {
+    // Shares the throttle with uploads and downloads, a busy server slows admin requests too
+    RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [url]() -> std::optional<web::WebTask> {
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        return req.get(url);
+    }, [this](web::WebResponse* resp) {
         if (resp->ok()) {
             auto data = resp->string().unwrapOr("{}");
             auto jsonResult = matjson::parse(data);
@@ -209,118 +209,125 @@ void AdminPanel::onViewBannedList(CCObject*) {
 }
 
 void AdminPanel::downloadUserDataByEmail(const std::string& email) {
+    bettersave::core::spawn(fetchUserData(email), [](std::exception_ptr error) {
+        if (!error) return;
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            BetterSaveLogger::get()->error("Admin", "User data download failed: {}", e.what());
+        }
+    });
+}
+
+bettersave::core::Task<void> AdminPanel::fetchUserData(std::string email) {
+    // Keeps the popup alive until both requests have answered, even if it's closed meanwhile
+    Ref<AdminPanel> self = this;
     showStatus("Looking up user...", {255, 255, 100});
     
-    BetterSaveLogger::get()->info("Admin", fmt::format("Looking up user by email: {}", email));
+    BetterSaveLogger::get()->info("Admin", "Looking up user by email: {}", email);
     
     // First, we need to find the userId by email
     // Unfortunately Firebase doesn't have a direct REST API for this
     // We'll use a workaround: search through users
     
-    std::string token = FirebaseAuth::get()->getIdToken();
-    std::string url = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/userEmails/{}.json?auth={}",
+    std::string url = FirebaseAuth::get()->getDatabaseUrl(fmt::format("userEmails/{}",
         // Replace @ and . with - for Firebase key
         std::string(email).replace(email.find('@'), 1, "-")
-                         .replace(email.find('.'), 1, "-"),
-        token
-    );
+                         .replace(email.find('.'), 1, "-")));
     
-    web::WebRequest req = web::WebRequest();
-    req.userAgent("");
+    auto lookup = sendRequest(RateLimiter::DATABASE_REQUEST, [url]() {
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        return req.get(url);
+    });
+    auto resp = co_await std::move(lookup);
+    if (!resp.ok()) {
+        showStatus("User not found or no data", {255, 100, 100});
+        FLAlertLayer::create("Error", "User not found or has no save data.", "OK")->show();
+        co_return;
+    }
     
-    req.get(url).listen([this, email, token](web::WebResponse* resp) {
-        if (!resp->ok()) {
-            showStatus("User not found or no data", {255, 100, 100});
-            FLAlertLayer::create("Error", "User not found or has no save data.", "OK")->show();
-            return;
-        }
-        
-        auto data = resp->string().unwrapOr("null");
-        auto jsonResult = matjson::parse(data);
-        
-        if (!jsonResult.isOk() || jsonResult.unwrap().isNull()) {
-            showStatus("User has no save data", {255, 100, 100});
-            FLAlertLayer::create("Error", 
-                "User not found in database.\n\nNote: Users must upload at least once\nto appear in the system.",
-                "OK")->show();
-            return;
-        }
-        
-        std::string userId = jsonResult.unwrap().asString().unwrapOr("");
-        if (userId.empty()) {
-            showStatus("Invalid user data", {255, 100, 100});
-            return;
-        }
-        
-        BetterSaveLogger::get()->info("Admin", fmt::format("Found userId: {}", userId));
-        showStatus("Downloading user data...", {255, 255, 100});
-        
-        // Now download the actual save data
-        std::string metaUrl = fmt::format(
-            "https://gdbettersave-default-rtdb.firebaseio.com/users/{}/saveData.json?auth={}",
-            userId, token
-        );
-        
+    auto data = resp.string().unwrapOr("null");
+    auto jsonResult = matjson::parse(data);
+    
+    if (!jsonResult.isOk() || jsonResult.unwrap().isNull()) {
+        showStatus("User has no save data", {255, 100, 100});
+        FLAlertLayer::create("Error", 
+            "User not found in database.\n\nNote: Users must upload at least once\nto appear in the system.",
+            "OK")->show();
+        co_return;
+    }
+    
+    std::string userId = jsonResult.unwrap().asString().unwrapOr("");
+    if (userId.empty()) {
+        showStatus("Invalid user data", {255, 100, 100});
+        co_return;
+    }
+    
+    BetterSaveLogger::get()->info("Admin", "Found userId: {}", userId);
+    showStatus("Downloading user data...", {255, 255, 100});
+    
+    // Now download the actual save data
+    std::string metaUrl = FirebaseAuth::get()->getDatabaseUrl(fmt::format("users/{}/saveData", userId));
+    
+    auto metaRequest = sendRequest(RateLimiter::DATABASE_REQUEST, [metaUrl]() {
         web::WebRequest metaReq = web::WebRequest();
         metaReq.userAgent("");
-        
-        metaReq.get(metaUrl).listen([this, userId, token, email](web::WebResponse* metaResp) {
-            if (!metaResp->ok()) {
-                showStatus("No save data found", {255, 100, 100});
-                return;
-            }
-            
-            auto metaData = metaResp->string().unwrapOr("{}");
-            auto metaJson = matjson::parse(metaData).unwrapOr(matjson::Value());
-            
-            if (metaJson.isNull()) {
-                showStatus("User has no save data", {255, 100, 100});
-                return;
-            }
-            
-            int gmChunks = metaJson["gmChunks"].asInt().unwrapOr(0);
-            int llChunks = metaJson["llChunks"].asInt().unwrapOr(0);
-            
-            BetterSaveLogger::get()->info("Admin", fmt::format("Downloading {} GM + {} LL chunks", gmChunks, llChunks));
-            
-            // Download to Desktop/BetterSave_Admin/email/
-            #ifdef GEODE_IS_WINDOWS
-                std::string userProfile = getenv("USERPROFILE");
-                std::filesystem::path targetDir = std::filesystem::path(userProfile) / "Desktop" / "BetterSave_Admin" / email;
-            #else
-                std::filesystem::path targetDir = std::filesystem::path(getenv("HOME")) / "Desktop" / "BetterSave_Admin" / email;
-            #endif
-            
-            try {
-                std::filesystem::create_directories(targetDir);
-            } catch (const std::exception& e) {
-                showStatus("Failed to create directory", {255, 100, 100});
-                return;
-            }
-            
-            showStatus("Downloading chunks...", {100, 200, 255});
-            
-            // Download chunks (simplified - would need full implementation like SaveManagerPopup)
-            // For now, just save the metadata
-            std::ofstream metaFile(targetDir / "metadata.json");
-            metaFile << metaData;
-            metaFile.close();
-            
-            showStatus("Download complete!", {100, 255, 100});
-            FLAlertLayer::create("Success",
-                fmt::format("User data downloaded to:\n{}", targetDir.string()),
-                "OK")->show();
-        });
+        return metaReq.get(metaUrl);
     });
+    auto metaResp = co_await std::move(metaRequest);
+    if (!metaResp.ok()) {
+        showStatus("No save data found", {255, 100, 100});
+        co_return;
+    }
+    
+    auto metaData = metaResp.string().unwrapOr("{}");
+    auto metaJson = matjson::parse(metaData).unwrapOr(matjson::Value());
+    
+    if (metaJson.isNull()) {
+        showStatus("User has no save data", {255, 100, 100});
+        co_return;
+    }
+    
+    int gmChunks = metaJson["gmChunks"].asInt().unwrapOr(0);
+    int llChunks = metaJson["llChunks"].asInt().unwrapOr(0);
+    
+    BetterSaveLogger::get()->info("Admin", "Downloading {} GM + {} LL chunks", gmChunks, llChunks);
+    
+    // Download to Desktop/BetterSave_Admin/email/
+    #ifdef GEODE_IS_WINDOWS
+        std::string userProfile = getenv("USERPROFILE");
+        std::filesystem::path targetDir = std::filesystem::path(userProfile) / "Desktop" / "BetterSave_Admin" / email;
+    #else
+        std::filesystem::path targetDir = std::filesystem::path(getenv("HOME")) / "Desktop" / "BetterSave_Admin" / email;
+    #endif
+    
+    try {
+        std::filesystem::create_directories(targetDir);
+    } catch (const std::exception& e) {
+        showStatus("Failed to create directory", {255, 100, 100});
+        co_return;
+    }
+    
+    showStatus("Downloading chunks...", {100, 200, 255});
+    
+    // Download chunks (simplified - would need full implementation like SaveManagerPopup)
+    // For now, just save the metadata
+    std::ofstream metaFile(targetDir / "metadata.json");
+    metaFile << metaData;
+    metaFile.close();
+    
+    showStatus("Download complete!", {100, 255, 100});
+    FLAlertLayer::create("Success",
+        fmt::format("User data downloaded to:\n{}", targetDir.string()),
+        "OK")->show();
 }
 
 void AdminPanel::banAccountByEmail(const std::string& email) {
     showStatus("Banning account...", {255, 255, 100});
     
-    BetterSaveLogger::get()->info("Admin", fmt::format("Banning account: {}", email));
+    BetterSaveLogger::get()->info("Admin", "Banning account: {}", email);
     
-    std::string token = FirebaseAuth::get()->getIdToken();
     
     // Store ban in /banned/{userId}
     matjson::Value banData;
@@ -333,19 +340,17 @@ void AdminPanel::banAccountByEmail(const std::string& email) {
     std::replace(emailKey.begin(), emailKey.end(), '@', '-');
     std::replace(emailKey.begin(), emailKey.end(), '.', '-');
     
-    std::string url = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/banned/{}.json?auth={}",
-        emailKey, token
-    );
-    
-    web::WebRequest req = web::WebRequest();
-    req.userAgent("");
-    req.bodyJSON(banData);
+    std::string url = FirebaseAuth::get()->getDatabaseUrl(fmt::format("banned/{}", emailKey));
     
-    req.put(url).listen([this, email](web::WebResponse* resp) {
+    RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [url, banData]() -> std::optional<web::WebTask> {
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        req.bodyJSON(banData);
+        return req.put(url);
+    }, [this, email](web::WebResponse* resp) {
         if (resp->ok()) {
             showStatus("Account banned successfully", {100, 255, 100});
-            BetterSaveLogger::get()->success("Admin", fmt::format("Banned account: {}", email));
+            BetterSaveLogger::get()->success("Admin", "Banned account: {}", email);
             FLAlertLayer::create("Success", 
                 fmt::format("{} has been banned.\nThey can only download, not upload.", email),
                 "OK")->show();
@@ -363,22 +368,19 @@ void AdminPanel::unbanAccountByEmail(const std::string& email) {
     std::replace(emailKey.begin(), emailKey.end(), '@', '-');
     std::replace(emailKey.begin(), emailKey.end(), '.', '-');
     
-    std::string token = FirebaseAuth::get()->getIdToken();
-    std::string url = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/banned/{}.json?auth={}",
-        emailKey, token
-    );
+    std::string url = FirebaseAuth::get()->getDatabaseUrl(fmt::format("banned/{}", emailKey));
     
     // Delete by setting to null (Firebase REST API)
-    web::WebRequest req = web::WebRequest();
-    req.userAgent("");
-    matjson::Value nullValue;
-    req.bodyJSON(nullValue);
-    
-    req.patch(url).listen([this, email](web::WebResponse* resp) {
+    RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [url]() -> std::optional<web::WebTask> {
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        matjson::Value nullValue;
+        req.bodyJSON(nullValue);
+        return req.patch(url);
+    }, [this, email](web::WebResponse* resp) {
         if (resp->ok()) {
             showStatus("Account unbanned", {100, 255, 100});
-            BetterSaveLogger::get()->success("Admin", fmt::format("Unbanned account: {}", email));
+            BetterSaveLogger::get()->success("Admin", "Unbanned account: {}", email);
             FLAlertLayer::create("Success", fmt::format("{} has been unbanned.", email), "OK")->show();
         } else {
             showStatus("Failed to unban", {255, 100, 100});
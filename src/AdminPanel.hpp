@@ -8,6 +8,7 @@
 #include <Geode/Geode.hpp>
 #include <Geode/ui/Popup.hpp>
 #include <Geode/ui/TextInput.hpp>
+#include "core/Task.hpp"
 
 using namespace geode::prelude;
 
@@ -24,6 +25,8 @@ protected:
     void showStatus(const std::string& message, ccColor3B color);
     
     void downloadUserDataByEmail(const std::string& email);
+    // Looks the user up, then fetches their metadata
+    bettersave::core::Task<void> fetchUserData(std::string email);
     void banAccountByEmail(const std::string& email);
     void unbanAccountByEmail(const std::string& email);
     
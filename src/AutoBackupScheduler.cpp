@@ -7,27 +7,109 @@
 #include "SettingsManager.hpp"
 #include "BetterSaveLogger.hpp"
 #include "FirebaseAuth.hpp"
-#include "SaveManagerPopup.hpp"
+#include "SyncEngine.hpp"
+#include "ManifestStore.hpp"
+#include "GameplayGuard.hpp"
+#include <Geode/loader/Dirs.hpp>
+#include <algorithm>
 
 AutoBackupScheduler* AutoBackupScheduler::s_instance = nullptr;
 
+// Whether the cloud save is still the one committed. Throws if the manifest can't be fetched.
+static bettersave::core::Task<void> compareCloudSave(CommittedManifest committed, std::function<void(bool)> onCompared) {
+    auto fetching = SyncEngine::get()->fetchCloudManifest();
+    auto meta = co_await std::move(fetching);
+    bool cloudMatches = false;
+    if (meta) {
+        // A GM save stored key by key is rebuilt with the game's encoding on restore, so the
+        // file differs from the one uploaded while its plist doesn't
+        bool gmMatches = committed.gameManager.keyNodes > 0
+            ? meta->gmPlistChecksum == committed.gameManager.plistChecksum
+            : meta->gmChecksum == committed.gameManager.checksum;
+        cloudMatches = meta->timestamp == committed.timestamp && gmMatches && meta->llChecksum == committed.localLevels.checksum;
+    }
+    onCompared(cloudMatches);
+}
+
 AutoBackupScheduler::AutoBackupScheduler() {
-    m_lastBackupTime = std::chrono::system_clock::now();
+    m_lastBackupTime = std::chrono::steady_clock::now();
 }
 
 void AutoBackupScheduler::start() {
     m_isRunning = true;
-    m_lastBackupTime = std::chrono::system_clock::now();
+    m_lastBackupTime = std::chrono::steady_clock::now();
     BetterSaveLogger::get()->info("AutoBackup", "Auto-backup scheduler started");
+    
+    // The save may have changed since the last session, check once the interval is up
+    markDirty();
 }
 
 void AutoBackupScheduler::stop() {
     m_isRunning = false;
+    CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(
+        schedule_selector(AutoBackupScheduler::onBackupTimer), this);
     BetterSaveLogger::get()->info("AutoBackup", "Auto-backup scheduler stopped");
 }
 
+void AutoBackupScheduler::markDirty() {
+    GameplayGuard::ScopedTimer timer;
+    auto now = std::chrono::steady_clock::now();
+    if (!m_isDirty) {
+        m_isDirty = true;
+        m_dirtySince = now;
+    }
+    
+    if (!m_isRunning) return;
+    
+    // Trailing debounce, capped so the first save of a burst isn't deferred forever
+    float dirtyFor = std::chrono::duration<float>(now - m_dirtySince).count();
+    float delay = std::clamp(MAX_COALESCE_SECONDS - dirtyFor, 0.f, COALESCE_WINDOW_SECONDS);
+    
+    scheduleBackup(std::max(delay, secondsUntilIntervalElapsed()));
+}
+
+void AutoBackupScheduler::scheduleBackup(float delaySeconds) {
+    auto scheduler = CCDirector::sharedDirector()->getScheduler();
+    
+    // Rescheduling an existing selector only changes its interval, so drop it first
+    scheduler->unscheduleSelector(schedule_selector(AutoBackupScheduler::onBackupTimer), this);
+    scheduler->scheduleSelector(schedule_selector(AutoBackupScheduler::onBackupTimer), this, 0.f, 0, delaySeconds, false);
+}
+
+void AutoBackupScheduler::onBackupTimer(float) {
+    GameplayGuard::ScopedTimer timer;
+    CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(
+        schedule_selector(AutoBackupScheduler::onBackupTimer), this);
+    
+    if (!m_isDirty) return;
+    
+    // Never start reading/encoding a save mid-level, wait for a menu or pause screen
+    if (GameplayGuard::isGameplayActive()) {
+        BetterSaveLogger::get()->info("AutoBackup", "Gameplay active, deferring backup");
+        GameplayGuard::get()->runWhenIdle([this]() {
+            checkAndBackup();
+        });
+        return;
+    }
+    
+    // Saved again while the interval hadn't passed yet (e.g. settings changed), wait the rest
+    float remaining = secondsUntilIntervalElapsed();
+    if (remaining > 0.f) {
+        scheduleBackup(remaining);
+        return;
+    }
+    
+    checkAndBackup();
+}
+
+float AutoBackupScheduler::secondsUntilIntervalElapsed() {
+    auto& settings = SettingsManager::get()->getSettings();
+    auto elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_lastBackupTime).count();
+    return std::max(0.f, settings.autoBackupIntervalMinutes * 60.f - elapsed);
+}
+
 bool AutoBackupScheduler::shouldBackup() {
-    if (!m_isRunning) return false;
+    if (!m_isRunning || !m_isDirty) return false;
     
     auto& settings = SettingsManager::get()->getSettings();
     if (!settings.autoBackupEnabled) return false;
@@ -35,13 +117,11 @@ bool AutoBackupScheduler::shouldBackup() {
     // Check if user is logged in
     if (!FirebaseAuth::get()->isLoggedIn()) return false;
     
-    auto now = std::chrono::system_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::minutes>(now - m_lastBackupTime);
-    
-    return elapsed.count() >= settings.autoBackupIntervalMinutes;
+    return secondsUntilIntervalElapsed() <= 0.f;
 }
 
 void AutoBackupScheduler::checkAndBackup() {
+    // If this returns false the save stays dirty and the next GD save reschedules us
     if (shouldBackup()) {
         performAutoBackup();
     }
@@ -50,23 +130,78 @@ void AutoBackupScheduler::checkAndBackup() {
 void AutoBackupScheduler::performAutoBackup() {
     BetterSaveLogger::get()->info("AutoBackup", "Performing automatic backup...");
     
-    // Reset timer first
+    // Reset timer first. A failed upload marks the save dirty again below.
     resetTimer();
+    m_isDirty = false;
     
-    // Create a temporary SaveManagerPopup to use its upload function
-    auto popup = SaveManagerPopup::create();
-    popup->uploadSaveData();
+    // Compare the save files against the last committed manifest before touching the network
+    auto savePath = geode::dirs::getSaveDir();
+    auto committed = ManifestStore::get()->getLastCommitted();
+    bool gmChanged = !committed.valid || !ManifestStore::get()->matches(savePath / "CCGameManager.dat", committed.gameManager);
+    bool llChanged = !committed.valid || !ManifestStore::get()->matches(savePath / "CCLocalLevels.dat", committed.localLevels);
     
-    // Show notification
-    auto& settings = SettingsManager::get()->getSettings();
-    if (settings.showNotifications) {
-        Notification::create("BetterSave: Auto-Backup Started", NotificationIcon::Info, 3.0f)->show();
+    if (!gmChanged && !llChanged) {
+        m_skippedBackups++;
+        BetterSaveLogger::get()->info("AutoBackup", "Save unchanged since last backup, skipping upload");
+        logMetrics();
+        return;
     }
     
-    BetterSaveLogger::get()->info("AutoBackup", "Automatic backup triggered");
+    auto startUpload = [this](bool onlyChanged) {
+        if (onlyChanged) m_deltaBackups++; else m_fullBackups++;
+        logMetrics();
+        
+        // Auto-backups run headless, only a notification is shown
+        SyncEngine::get()->upload(onlyChanged, [this](bool success, const std::string& message) {
+            if (!success) {
+                BetterSaveLogger::get()->error("AutoBackup", "Automatic backup failed: {}", message);
+                // Failed, cancelled or dropped from the queue, the save still needs backing up
+                markDirty();
+            }
+            if (SettingsManager::get()->getSettings().showNotifications) {
+                Notification::create(success ? "BetterSave: Auto-Backup Complete" : "BetterSave: Auto-Backup Failed",
+                    success ? NotificationIcon::Success : NotificationIcon::Error, 3.0f)->show();
+            }
+        });
+        
+        // Show notification
+        auto& settings = SettingsManager::get()->getSettings();
+        if (settings.showNotifications) {
+            Notification::create("BetterSave: Auto-Backup Started", NotificationIcon::Info, 3.0f)->show();
+        }
+        
+        BetterSaveLogger::get()->info("AutoBackup", "Automatic backup triggered");
+    };
+    
+    if (gmChanged && llChanged) {
+        startUpload(false);
+        return;
+    }
+    
+    // Only one file changed. Re-using the other file's chunks is only safe if nobody
+    // (e.g. another device) replaced the cloud save since we committed it.
+    auto onCompared = [startUpload](bool cloudMatches) {
+        if (!cloudMatches) {
+            BetterSaveLogger::get()->warning("AutoBackup", "Cloud save differs from last commit, doing a full upload");
+        }
+        // The metadata check may have come back after a level started
+        GameplayGuard::get()->runWhenIdle([startUpload, cloudMatches]() {
+            startUpload(cloudMatches);
+        });
+    };
+    bettersave::core::spawn(compareCloudSave(committed, onCompared), [onCompared](std::exception_ptr error) {
+        // Couldn't read the cloud manifest, nothing says the cloud save is still ours
+        if (error) onCompared(false);
+    });
+}
+
+void AutoBackupScheduler::logMetrics() {
+    BetterSaveLogger::get()->info("AutoBackup",
+        "Metrics: {} skipped (unchanged), {} delta uploads, {} full uploads",
+        m_skippedBackups, m_deltaBackups, m_fullBackups);
 }
 
 void AutoBackupScheduler::resetTimer() {
-    m_lastBackupTime = std::chrono::system_clock::now();
+    m_lastBackupTime = std::chrono::steady_clock::now();
 }
 
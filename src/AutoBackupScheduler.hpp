@@ -9,11 +9,30 @@
 
 using namespace geode::prelude;
 
-class AutoBackupScheduler {
+// Backups are event driven: GD's save hook marks the save dirty and a one-shot
+// cocos timer fires once the burst of saves has settled. Nothing runs per frame.
+class AutoBackupScheduler : public CCObject {
 private:
     static AutoBackupScheduler* s_instance;
-    std::chrono::system_clock::time_point m_lastBackupTime;
+    std::chrono::steady_clock::time_point m_lastBackupTime;
+    std::chrono::steady_clock::time_point m_dirtySince;
     bool m_isRunning = false;
+    bool m_isDirty = false;
+    
+    // Saves within this window of each other are coalesced into one backup...
+    static constexpr float COALESCE_WINDOW_SECONDS = 10.f;
+    // ...but a constant stream of saves can't postpone the backup longer than this
+    static constexpr float MAX_COALESCE_SECONDS = 60.f;
+    
+    // Change detection metrics for this session
+    int m_skippedBackups = 0;
+    int m_deltaBackups = 0;
+    int m_fullBackups = 0;
+    
+    void logMetrics();
+    void scheduleBackup(float delaySeconds);
+    void onBackupTimer(float dt);
+    float secondsUntilIntervalElapsed();
     
 public:
     static AutoBackupScheduler* get() {
@@ -25,6 +44,9 @@ public:
 
     AutoBackupScheduler();
     
+    // Called whenever GD writes its save files
+    void markDirty();
+    
     void checkAndBackup();
     void performAutoBackup();
     bool shouldBackup();
@@ -32,4 +54,3 @@ public:
     void start();
     void stop();
 };
-
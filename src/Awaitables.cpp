@@ -0,0 +1,67 @@
+/**
+ * BetterSave - Awaitables
+ * Created by: sidastuff
+ */
+
+#include "Awaitables.hpp"
+#include "RateLimiter.hpp"
+#include <atomic>
+#include <memory>
+
+using bettersave::core::CallbackAwaiter;
+using bettersave::core::CancellationToken;
+using bettersave::core::CancellationTokenPtr;
+
+bettersave::core::Task<web::WebResponse> sendRequest(std::string action, std::function<web::WebTask()> makeRequest,
+                                                     CancellationTokenPtr token, size_t requestBytes) {
+    while (true) {
+        if (token) {
+            auto resumed = waitUntilResumed(token);
+            co_await std::move(resumed);
+            token->throwIfCancelled();
+        }
+
+        // nullopt if the request was held back at send time, the loop waits and queues it again
+        CallbackAwaiter<std::optional<web::WebResponse>> sent([&](std::function<void(std::optional<web::WebResponse>)> resume) {
+            RateLimiter::get()->send(action, [token, makeRequest, resume]() -> std::optional<web::WebTask> {
+                if (token && token->state() != CancellationToken::State::Running) {
+                    // Resumed once send() has released the slot, not from inside it
+                    Loader::get()->queueInMainThread([resume]() { resume(std::nullopt); });
+                    return std::nullopt;
+                }
+                return makeRequest();
+            }, [resume](web::WebResponse* response) {
+                resume(*response);
+            }, requestBytes);
+        });
+        auto response = co_await sent;
+        if (response) {
+            co_return std::move(*response);
+        }
+    }
+}
+
+bettersave::core::Task<void> waitUntilResumed(CancellationTokenPtr token) {
+    if (!token->isPaused()) {
+        co_return;
+    }
+
+    // Raw pointer in the listener, the token owns it and our frame owns the token
+    CallbackAwaiter<void> resumed([token = token.get()](std::function<void()> resume) {
+        // The listener and the check after adding it may both see the change, only one wakes us
+        auto woken = std::make_shared<std::atomic<bool>>(false);
+        auto listenerId = std::make_shared<int>(0);
+        auto wake = [token, woken, listenerId, resume]() {
+            if (woken->exchange(true)) return;
+            token->removeListener(*listenerId);
+            Loader::get()->queueInMainThread(resume);
+        };
+        *listenerId = token->addListener([wake](CancellationToken::State state) {
+            if (state != CancellationToken::State::Paused) wake();
+        });
+        if (!token->isPaused()) wake();
+        // Woken on another thread before the id was stored
+        if (woken->load()) token->removeListener(*listenerId);
+    });
+    co_await resumed;
+}
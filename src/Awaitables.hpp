@@ -0,0 +1,57 @@
+/**
+ * BetterSave - Awaitables
+ * Coroutine versions of the mod's callback APIs: database requests, background work and paused
+ * tokens. Each one resumes its coroutine on the main thread.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <Geode/Geode.hpp>
+#include <Geode/utils/web.hpp>
+#include <Geode/loader/Loader.hpp>
+#include "core/Cancellation.hpp"
+#include "core/Task.hpp"
+#include "core/ThreadPool.hpp"
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+using namespace geode::prelude;
+
+// RateLimiter::send() as a coroutine, the response is refcounted so returning it copies nothing.
+// With a token, nothing is sent while it's paused (including throttled retries) and
+// OperationCancelled is thrown once it's cancelled. makeRequest runs once per attempt, requestBytes
+// is the size of the body it sends (see RateLimiter::send).
+bettersave::core::Task<web::WebResponse> sendRequest(std::string action, std::function<web::WebTask()> makeRequest,
+                                                     bettersave::core::CancellationTokenPtr token = nullptr, size_t requestBytes = 0);
+
+// Returns once the token isn't paused anymore (right away if it isn't)
+bettersave::core::Task<void> waitUntilResumed(bettersave::core::CancellationTokenPtr token);
+
+// Runs work on the shared thread pool and resumes with its result (or exception) on the main thread.
+// work is moved to the pool, so it should own everything it touches.
+template <class Work>
+bettersave::core::Task<std::invoke_result_t<Work>> runInBackground(Work work) {
+    using Result = std::invoke_result_t<Work>;
+    std::optional<Result> result;
+    std::exception_ptr error;
+
+    bettersave::core::CallbackAwaiter<void> done([&result, &error, &work](std::function<void()> resume) {
+        bettersave::core::ThreadPool::get()->submit([&result, &error, work = std::move(work), resume]() mutable {
+            try {
+                result.emplace(work());
+            } catch (...) {
+                error = std::current_exception();
+            }
+            Loader::get()->queueInMainThread(resume);
+        });
+    });
+    co_await done;
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    co_return std::move(*result);
+}
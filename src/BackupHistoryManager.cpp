@@ -43,7 +43,7 @@ void BackupHistoryManager::addBackupEntry(const std::string& slotName, const std
     }
     
     saveToFile();
-    BetterSaveLogger::get()->info("History", fmt::format("Backup entry added: {} ({})", slotName, isAuto ? "auto" : "manual"));
+    BetterSaveLogger::get()->info("History", "Backup entry added: {} ({})", slotName, isAuto ? "auto" : "manual");
 }
 
 std::vector<BackupEntry> BackupHistoryManager::getHistory() {
@@ -78,7 +78,7 @@ void BackupHistoryManager::removeSlot(const std::string& slotName) {
         m_history.end()
     );
     saveToFile();
-    BetterSaveLogger::get()->info("History", fmt::format("Removed slot: {}", slotName));
+    BetterSaveLogger::get()->info("History", "Removed slot: {}", slotName);
 }
 
 void BackupHistoryManager::saveToFile() {
@@ -104,7 +104,7 @@ void BackupHistoryManager::saveToFile() {
             file.close();
         }
     } catch (const std::exception& e) {
-        BetterSaveLogger::get()->error("History", fmt::format("Failed to save history: {}", e.what()));
+        BetterSaveLogger::get()->error("History", "Failed to save history: {}", e.what());
     }
 }
 
@@ -163,10 +163,10 @@ void BackupHistoryManager::loadFromFile() {
             m_history.push_back(entry);
         }
         
-        BetterSaveLogger::get()->info("History", fmt::format("Loaded {} backup entries", m_history.size()));
+        BetterSaveLogger::get()->info("History", "Loaded {} backup entries", m_history.size());
         
     } catch (const std::exception& e) {
-        BetterSaveLogger::get()->error("History", fmt::format("Failed to load history: {}", e.what()));
+        BetterSaveLogger::get()->error("History", "Failed to load history: {}", e.what());
     }
 }
 
@@ -164,7 +164,7 @@ void BackupHistoryPopup::onSlotSelect(CCObject* sender) {
         [this, slotName](auto, bool btn2) {
             if (btn2) {
                 // Close this popup and trigger download with selected slot
-                BetterSaveLogger::get()->info("History", fmt::format("Restoring from backup: {}", slotName));
+                BetterSaveLogger::get()->info("History", "Restoring from backup: {}", slotName);
                 FLAlertLayer::create("Restore Started", fmt::format("Restoring from backup '{}'...", slotName).c_str(), "OK")->show();
                 this->onClose(nullptr);
                 // TODO: Integrate with download functionality
@@ -1,16 +1,25 @@
 #include "BetterSaveLogger.hpp"
+#include "core/Json.hpp"
+#include "core/Trace.hpp"
 #include <Geode/loader/Dirs.hpp>
 #include <matjson.hpp>
 #include <fstream>
 #include <sstream>
 #include <chrono>
-#include <iomanip>
+#include <ctime>
 
 BetterSaveLogger* BetterSaveLogger::s_instance = nullptr;
 
-BetterSaveLogger::BetterSaveLogger() {
-    m_logFilePath = geode::dirs::getSaveDir() / "bettersave_logs.json";
+BetterSaveLogger::BetterSaveLogger() : m_logFile(geode::dirs::getSaveDir() / "bettersave_logs.jsonl") {
+    m_legacyLogPath = geode::dirs::getSaveDir() / "bettersave_logs.json";
+    importLegacyLog();
     loadFromDisk();
+
+    // The logger lives for the whole session, so the flusher is never joined
+    std::thread([this]() {
+        bettersave::core::Tracer::get()->setThreadName("BetterSave logger");
+        runFlusher();
+    }).detach();
 }
 
 std::string BetterSaveLogger::getLevelString(LogLevel level) {
@@ -23,188 +32,308 @@ std::string BetterSaveLogger::getLevelString(LogLevel level) {
     }
 }
 
-std::string BetterSaveLogger::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+LogLevel BetterSaveLogger::parseLevelString(const std::string& level) {
+    if (level == "WARNING") return LogLevel::Warning;
+    if (level == "ERROR") return LogLevel::Error;
+    if (level == "SUCCESS") return LogLevel::Success;
+    return LogLevel::Info;
 }
 
-void BetterSaveLogger::log(LogLevel level, const std::string& category, const std::string& message) {
-    LogEntry entry;
-    entry.timestamp = getCurrentTimestamp();
+const std::string& BetterSaveLogger::formatTimestamp(std::chrono::system_clock::time_point time) {
+    auto second = std::chrono::system_clock::to_time_t(time);
+    if (second != m_timestampSecond || m_timestampText.empty()) {
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&second));
+        m_timestampSecond = second;
+        m_timestampText = buffer;
+    }
+    return m_timestampText;
+}
+
+void BetterSaveLogger::log(LogLevel level, const char* category, const std::string& message) {
+    enqueue(level, category, LazyMessage(message));
+}
+
+void BetterSaveLogger::enqueue(LogLevel level, const char* category, LazyMessage message) {
+    QueuedLog entry;
+    entry.time = std::chrono::system_clock::now();
     entry.level = level;
     entry.category = category;
-    entry.message = message;
-    
-    m_logs.push_back(entry);
-    
-    // Also log to Geode's console
-    std::string fullMessage = fmt::format("[BetterSave:{}] {}", category, message);
-    switch (level) {
-        case LogLevel::Info:
-            geode::log::info("{}", fullMessage);
-            break;
-        case LogLevel::Warning:
-            geode::log::warn("{}", fullMessage);
-            break;
-        case LogLevel::Error:
-            geode::log::error("{}", fullMessage);
-            break;
-        case LogLevel::Success:
-            geode::log::info("✓ {}", fullMessage);
-            break;
-    }
-    
-    // Keep only last 500 logs in memory
-    if (m_logs.size() > 500) {
-        m_logs.erase(m_logs.begin(), m_logs.begin() + 100);
+    entry.message = std::move(message);
+
+    // Never block the caller: if the flusher has fallen this far behind, drop the entry
+    if (!m_queue.tryPush(std::move(entry))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
-    
-    // Save to disk immediately for critical logs
+    m_enqueued.fetch_add(1, std::memory_order_release);
+
+    // Critical logs get written without waiting for the next save interval
     if (level == LogLevel::Error || level == LogLevel::Success) {
-        saveToDisk();
+        forceSave();
+    }
+}
+
+size_t BetterSaveLogger::drainQueue() {
+    std::vector<LogEntry> batch;
+    QueuedLog queued;
+    while (m_queue.tryPop(queued)) {
+        LogEntry entry;
+        entry.timestamp = formatTimestamp(queued.time);
+        entry.level = queued.level;
+        entry.category = std::move(queued.category);
+        entry.message = queued.message.str();
+        queued.message = LazyMessage();
+        batch.push_back(std::move(entry));
+    }
+    if (batch.empty()) {
+        return 0;
+    }
+
+    // Mirror to Geode's console from here so the caller never pays for it
+    for (const auto& item : batch) {
+        std::string fullMessage = fmt::format("[BetterSave:{}] {}", item.category, item.message);
+        switch (item.level) {
+            case LogLevel::Info:
+                geode::log::info("{}", fullMessage);
+                break;
+            case LogLevel::Warning:
+                geode::log::warn("{}", fullMessage);
+                break;
+            case LogLevel::Error:
+                geode::log::error("{}", fullMessage);
+                break;
+            case LogLevel::Success:
+                geode::log::info("✓ {}", fullMessage);
+                break;
+        }
+    }
+
+    std::lock_guard lock(m_logsMutex);
+    for (auto& item : batch) {
+        m_unwritten.push_back(item);
+        m_logs.push_back(std::move(item));
+    }
+    // Keep only last 500 logs in memory
+    while (m_logs.size() > MAX_HISTORY) {
+        m_logs.pop_front();
     }
+    return batch.size();
 }
 
-void BetterSaveLogger::info(const std::string& category, const std::string& message) {
-    log(LogLevel::Info, category, message);
+void BetterSaveLogger::runFlusher() {
+    uint64_t drained = 0;
+    auto lastSave = std::chrono::steady_clock::now();
+
+    while (true) {
+        {
+            std::unique_lock lock(m_flushMutex);
+            m_flushWake.wait_for(lock, DRAIN_INTERVAL, [this]() { return m_saveRequested.load(); });
+        }
+
+        drained += drainQueue();
+
+        // A flush() waiting on entries drained after its request was consumed still needs a save
+        bool requested = m_saveRequested.exchange(false) || m_flushTarget.load() > m_persisted;
+        auto now = std::chrono::steady_clock::now();
+        bool dirty;
+        {
+            std::lock_guard lock(m_logsMutex);
+            dirty = !m_unwritten.empty() || m_clearPending;
+        }
+        if (dirty && (requested || now - lastSave >= SAVE_INTERVAL)) {
+            saveToDisk();
+            lastSave = now;
+            dirty = false;
+        }
+
+        if (!dirty) {
+            std::lock_guard lock(m_flushMutex);
+            m_persisted = drained;
+        }
+        m_flushDone.notify_all();
+    }
 }
 
-void BetterSaveLogger::warning(const std::string& category, const std::string& message) {
-    log(LogLevel::Warning, category, message);
+void BetterSaveLogger::info(const char* category, const std::string& message) {
+    if constexpr (isLogLevelEnabled(LogLevel::Info)) {
+        log(LogLevel::Info, category, message);
+    }
 }
 
-void BetterSaveLogger::error(const std::string& category, const std::string& message) {
-    log(LogLevel::Error, category, message);
+void BetterSaveLogger::warning(const char* category, const std::string& message) {
+    if constexpr (isLogLevelEnabled(LogLevel::Warning)) {
+        log(LogLevel::Warning, category, message);
+    }
 }
 
-void BetterSaveLogger::success(const std::string& category, const std::string& message) {
+void BetterSaveLogger::error(const char* category, const std::string& message) {
+    if constexpr (isLogLevelEnabled(LogLevel::Error)) {
+        log(LogLevel::Error, category, message);
+    }
+}
+
+void BetterSaveLogger::success(const char* category, const std::string& message) {
     log(LogLevel::Success, category, message);
 }
 
 std::vector<LogEntry> BetterSaveLogger::getAllLogs() {
-    return m_logs;
+    std::lock_guard lock(m_logsMutex);
+    return std::vector<LogEntry>(m_logs.begin(), m_logs.end());
 }
 
 std::vector<LogEntry> BetterSaveLogger::getRecentLogs(size_t count) {
+    std::lock_guard lock(m_logsMutex);
     if (m_logs.size() <= count) {
-        return m_logs;
+        return std::vector<LogEntry>(m_logs.begin(), m_logs.end());
     }
     return std::vector<LogEntry>(m_logs.end() - count, m_logs.end());
 }
 
 void BetterSaveLogger::clearLogs() {
-    m_logs.clear();
-    saveToDisk();
+    {
+        std::lock_guard lock(m_logsMutex);
+        m_logs.clear();
+        m_unwritten.clear();
+        m_clearPending = true;
+    }
+    forceSave();
 }
 
 void BetterSaveLogger::forceSave() {
-    saveToDisk();
+    m_saveRequested.store(true);
+    m_flushWake.notify_one();
 }
 
+void BetterSaveLogger::flush() {
+    uint64_t target = m_enqueued.load(std::memory_order_acquire);
+    uint64_t current = m_flushTarget.load();
+    while (current < target && !m_flushTarget.compare_exchange_weak(current, target)) {}
+    forceSave();
+
+    // Bounded so a wedged disk can't hang the game on exit
+    std::unique_lock lock(m_flushMutex);
+    m_flushDone.wait_for(lock, std::chrono::seconds(2), [this, target]() { return m_persisted >= target; });
+}
+
+std::string BetterSaveLogger::serializeEntry(const LogEntry& entry) {
+    std::string line = "{\"timestamp\":";
+    bettersave::core::appendJsonString(line, entry.timestamp);
+    line += ",\"level\":";
+    bettersave::core::appendJsonString(line, getLevelString(entry.level));
+    line += ",\"category\":";
+    bettersave::core::appendJsonString(line, entry.category);
+    line += ",\"message\":";
+    bettersave::core::appendJsonString(line, entry.message);
+    line += "}";
+    return line;
+}
+
+std::optional<LogEntry> BetterSaveLogger::parseEntry(const std::string& line) {
+    auto object = bettersave::core::parseFlatJsonObject(line);
+    if (!object) {
+        return std::nullopt;
+    }
+
+    LogEntry entry;
+    entry.timestamp = bettersave::core::getString(*object, "timestamp").value_or("");
+    entry.level = parseLevelString(bettersave::core::getString(*object, "level").value_or(""));
+    entry.category = bettersave::core::getString(*object, "category").value_or("");
+    entry.message = bettersave::core::getString(*object, "message").value_or("");
+    return entry;
+}
+
+// Flusher thread only: appends what was drained since the last save
 void BetterSaveLogger::saveToDisk() {
-    try {
-        std::vector<matjson::Value> logsArray;
-        
-        for (const auto& entry : m_logs) {
-            matjson::Value logEntry;
-            logEntry["timestamp"] = entry.timestamp;
-            logEntry["level"] = getLevelString(entry.level);
-            logEntry["category"] = entry.category;
-            logEntry["message"] = entry.message;
-            logsArray.push_back(logEntry);
-        }
-        
-        matjson::Value logsJson = logsArray;
-        
-        std::ofstream file(m_logFilePath, std::ios::out | std::ios::trunc);
-        if (file.is_open()) {
-            file << logsJson.dump();
-            file.flush();  // Force write to disk
-            file.close();
-        }
-        
-    } catch (const std::exception& e) {
-        geode::log::error("Failed to save BetterSave logs: {}", e.what());
+    std::vector<LogEntry> pending;
+    bool clear;
+    {
+        std::lock_guard lock(m_logsMutex);
+        pending.swap(m_unwritten);
+        clear = m_clearPending;
+        m_clearPending = false;
+    }
+
+    if (clear) {
+        m_logFile.clear();
+    }
+
+    std::vector<std::string> lines;
+    lines.reserve(pending.size());
+    for (const auto& entry : pending) {
+        lines.push_back(serializeEntry(entry));
+    }
+    if (!m_logFile.append(lines)) {
+        geode::log::error("Failed to append {} BetterSave logs to disk", lines.size());
     }
 }
 
 void BetterSaveLogger::loadFromDisk() {
+    // Anything still queued would be lost when the history is replaced below
+    if (m_enqueued.load() > 0) {
+        flush();
+    }
+
+    std::deque<LogEntry> loaded;
+    for (const auto& line : m_logFile.readTail(MAX_HISTORY)) {
+        // A torn line from a crash mid-write is simply skipped
+        if (auto entry = parseEntry(line)) {
+            loaded.push_back(std::move(*entry));
+        }
+    }
+
+    geode::log::info("Loaded {} BetterSave logs from disk", loaded.size());
+    std::lock_guard lock(m_logsMutex);
+    m_logs = std::move(loaded);
+}
+
+// One-time move of the old single-array bettersave_logs.json into the line log
+void BetterSaveLogger::importLegacyLog() {
     try {
-        if (!std::filesystem::exists(m_logFilePath)) {
+        if (!std::filesystem::exists(m_legacyLogPath)) {
             return;
         }
         
-        std::ifstream file(m_logFilePath);
+        std::ifstream file(m_legacyLogPath);
         std::stringstream buffer;
         buffer << file.rdbuf();
         file.close();
         
         auto jsonResult = matjson::parse(buffer.str());
-        if (!jsonResult.isOk()) {
-            geode::log::error("Failed to parse BetterSave logs JSON");
+        if (!jsonResult.isOk() || !jsonResult.unwrap().isArray()) {
+            geode::log::error("Old BetterSave logs are unreadable, leaving them in place");
             return;
         }
         
-        auto logsJson = jsonResult.unwrap();
-        if (!logsJson.isArray()) {
-            return;
-        }
-        
-        m_logs.clear();
-        
-        // Properly iterate through JSON array
-        auto arrayResult = logsJson.as<std::vector<matjson::Value>>();
+        auto arrayResult = jsonResult.unwrap().as<std::vector<matjson::Value>>();
         if (!arrayResult.isOk()) {
             geode::log::error("Failed to convert logs JSON to array");
             return;
         }
         
-        auto logsArray = arrayResult.unwrap();
-        for (const auto& logJson : logsArray) {
-            try {
-                if (!logJson.isObject()) continue;
-                
-                LogEntry entry;
-                
-                if (logJson.contains("timestamp")) {
-                    auto result = logJson["timestamp"].asString();
-                    if (result.isOk()) entry.timestamp = result.unwrap();
-                }
-                
-                if (logJson.contains("level")) {
-                    auto result = logJson["level"].asString();
-                    if (result.isOk()) {
-                        std::string levelStr = result.unwrap();
-                        if (levelStr == "INFO") entry.level = LogLevel::Info;
-                        else if (levelStr == "WARNING") entry.level = LogLevel::Warning;
-                        else if (levelStr == "ERROR") entry.level = LogLevel::Error;
-                        else if (levelStr == "SUCCESS") entry.level = LogLevel::Success;
-                    }
-                }
-                
-                if (logJson.contains("category")) {
-                    auto result = logJson["category"].asString();
-                    if (result.isOk()) entry.category = result.unwrap();
-                }
-                
-                if (logJson.contains("message")) {
-                    auto result = logJson["message"].asString();
-                    if (result.isOk()) entry.message = result.unwrap();
-                }
-                
-                m_logs.push_back(entry);
-            } catch (const std::exception& e) {
-                geode::log::error("Error parsing log entry: {}", e.what());
-            }
+        auto readString = [](const matjson::Value& object, const char* key) -> std::string {
+            if (!object.contains(key)) return "";
+            return object[key].asString().unwrapOr("");
+        };
+        
+        std::vector<std::string> lines;
+        for (const auto& logJson : arrayResult.unwrap()) {
+            if (!logJson.isObject()) continue;
+            
+            LogEntry entry;
+            entry.timestamp = readString(logJson, "timestamp");
+            entry.level = parseLevelString(readString(logJson, "level"));
+            entry.category = readString(logJson, "category");
+            entry.message = readString(logJson, "message");
+            lines.push_back(serializeEntry(entry));
         }
         
-        geode::log::info("Loaded {} BetterSave logs from disk", m_logs.size());
+        if (m_logFile.append(lines)) {
+            std::filesystem::remove(m_legacyLogPath);
+            geode::log::info("Moved {} BetterSave logs to the line log", lines.size());
+        }
         
     } catch (const std::exception& e) {
-        geode::log::error("Failed to load BetterSave logs: {}", e.what());
+        geode::log::error("Failed to import old BetterSave logs: {}", e.what());
     }
 }
-
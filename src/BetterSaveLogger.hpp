@@ -1,8 +1,29 @@
 #pragma once
 #include <Geode/Geode.hpp>
+#include "core/LogFile.hpp"
+#include "core/MpscRing.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+// Log calls below this level compile to nothing: 0 = Info, 1 = Warning, 2 = Error.
+// Success is never compiled out.
+#ifndef BETTERSAVE_MIN_LOG_LEVEL
+    #define BETTERSAVE_MIN_LOG_LEVEL 0
+#endif
+
 using namespace geode::prelude;
 
 enum class LogLevel {
@@ -12,22 +33,156 @@ enum class LogLevel {
     Success
 };
 
+constexpr bool isLogLevelEnabled(LogLevel level) {
+    return level == LogLevel::Success || static_cast<int>(level) >= BETTERSAVE_MIN_LOG_LEVEL;
+}
+
 struct LogEntry {
     std::string timestamp;
-    LogLevel level;
+    LogLevel level = LogLevel::Info;
     std::string message;
     std::string category;
 };
 
+// A format string plus copies of its arguments, formatted later on the flusher thread.
+// C strings and string_views are copied into std::string so nothing can dangle; argument
+// sets too big for the inline buffer are formatted right away instead.
+class LazyMessage {
+private:
+    static constexpr size_t INLINE_SIZE = 128;
+
+    template <class T>
+    using Stored = std::conditional_t<
+        std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*> ||
+            std::is_same_v<std::decay_t<T>, std::string_view>,
+        std::string, std::decay_t<T>>;
+
+    template <class... Args>
+    struct Capture {
+        fmt::string_view format;
+        std::tuple<Stored<Args>...> args;
+    };
+
+    alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+    std::string (*m_format)(const void* storage) = nullptr;
+    void (*m_relocate)(void* from, void* to) = nullptr;  // Move-construct into to, destroy from
+    void (*m_destroy)(void* storage) = nullptr;
+    std::string m_text;
+
+    void reset() {
+        if (m_destroy) m_destroy(m_storage);
+        m_format = nullptr;
+        m_relocate = nullptr;
+        m_destroy = nullptr;
+    }
+
+public:
+    LazyMessage() = default;
+    LazyMessage(std::string text) : m_text(std::move(text)) {}
+    ~LazyMessage() { reset(); }
+
+    LazyMessage(LazyMessage&& other) noexcept { *this = std::move(other); }
+    LazyMessage& operator=(LazyMessage&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_text = std::move(other.m_text);
+            if (other.m_format) {
+                other.m_relocate(other.m_storage, m_storage);
+                m_format = other.m_format;
+                m_relocate = other.m_relocate;
+                m_destroy = other.m_destroy;
+                other.m_format = nullptr;
+                other.m_relocate = nullptr;
+                other.m_destroy = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    template <class... Args>
+    static LazyMessage capture(fmt::format_string<Args...> format, Args&&... args) {
+        using Captured = Capture<Args...>;
+        LazyMessage message;
+        if constexpr (sizeof(Captured) <= INLINE_SIZE && alignof(Captured) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<Captured>) {
+            new (message.m_storage) Captured{static_cast<fmt::string_view>(format),
+                                                std::tuple<Stored<Args>...>(Stored<Args>(std::forward<Args>(args))...)};
+            message.m_format = [](const void* storage) {
+                auto* captured = static_cast<const Captured*>(storage);
+                return std::apply([captured](const auto&... values) {
+                    return fmt::vformat(captured->format, fmt::make_format_args(values...));
+                }, captured->args);
+            };
+            message.m_relocate = [](void* from, void* to) {
+                new (to) Captured(std::move(*static_cast<Captured*>(from)));
+                static_cast<Captured*>(from)->~Captured();
+            };
+            message.m_destroy = [](void* storage) {
+                static_cast<Captured*>(storage)->~Captured();
+            };
+        } else {
+            message.m_text = fmt::format(format, std::forward<Args>(args)...);
+        }
+        return message;
+    }
+
+    std::string str() const {
+        return m_format ? m_format(m_storage) : m_text;
+    }
+};
+
+// What log() hands to the flusher: no timestamp string or formatted text yet
+struct QueuedLog {
+    std::chrono::system_clock::time_point time;
+    LogLevel level = LogLevel::Info;
+    std::string category;
+    LazyMessage message;
+};
+
+// log() only stamps the entry and pushes it onto a lock-free ring. A background thread
+// drains the ring into the history and the Geode console, and appends batches to
+// bettersave_logs.jsonl (one JSON object per line, rotated by size).
 class BetterSaveLogger {
 private:
     static BetterSaveLogger* s_instance;
-    std::vector<LogEntry> m_logs;
-    std::filesystem::path m_logFilePath;
-    
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+    static constexpr size_t MAX_HISTORY = 500;
+    static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(100);
+    static constexpr auto SAVE_INTERVAL = std::chrono::seconds(2);
+
+    bettersave::core::MpscRing<QueuedLog> m_queue{QUEUE_CAPACITY};
+    std::atomic<uint64_t> m_enqueued{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    std::deque<LogEntry> m_logs;
+    std::vector<LogEntry> m_unwritten;  // Drained but not yet appended to the file
+    bool m_clearPending = false;
+    std::mutex m_logsMutex;
+    bettersave::core::SegmentedLog m_logFile;
+    std::filesystem::path m_legacyLogPath;  // bettersave_logs.json from older versions
+
+    // Flusher thread state
+    std::mutex m_flushMutex;
+    std::condition_variable m_flushWake;
+    std::condition_variable m_flushDone;
+    std::atomic<bool> m_saveRequested{false};
+    std::atomic<uint64_t> m_flushTarget{0};
+    uint64_t m_persisted = 0;
+    // Flusher thread only: timestamps are formatted once per second
+    std::time_t m_timestampSecond = 0;
+    std::string m_timestampText;
+
     std::string getLevelString(LogLevel level);
-    std::string getCurrentTimestamp();
+    static LogLevel parseLevelString(const std::string& level);
+    const std::string& formatTimestamp(std::chrono::system_clock::time_point time);
+    std::string serializeEntry(const LogEntry& entry);
+    static std::optional<LogEntry> parseEntry(const std::string& line);
+    void importLegacyLog();
+    void enqueue(LogLevel level, const char* category, LazyMessage message);
     void saveToDisk();
+    void runFlusher();
+    // Flusher thread only: moves queued entries into the history, returns how many
+    size_t drainQueue();
 
 public:
     static BetterSaveLogger* get() {
@@ -39,16 +194,47 @@ public:
 
     BetterSaveLogger();
     
-    void log(LogLevel level, const std::string& category, const std::string& message);
-    void info(const std::string& category, const std::string& message);
-    void warning(const std::string& category, const std::string& message);
-    void error(const std::string& category, const std::string& message);
-    void success(const std::string& category, const std::string& message);
+    // Categories are string literals. Prefer the format overloads: the arguments are
+    // copied and formatted on the flusher thread, and disabled levels cost nothing.
+    void log(LogLevel level, const char* category, const std::string& message);
+    void info(const char* category, const std::string& message);
+    void warning(const char* category, const std::string& message);
+    void error(const char* category, const std::string& message);
+    void success(const char* category, const std::string& message);
+
+    template <class... Args>
+    void info(const char* category, fmt::format_string<Args...> format, Args&&... args) {
+        if constexpr (isLogLevelEnabled(LogLevel::Info)) {
+            enqueue(LogLevel::Info, category, LazyMessage::capture(format, std::forward<Args>(args)...));
+        }
+    }
+
+    template <class... Args>
+    void warning(const char* category, fmt::format_string<Args...> format, Args&&... args) {
+        if constexpr (isLogLevelEnabled(LogLevel::Warning)) {
+            enqueue(LogLevel::Warning, category, LazyMessage::capture(format, std::forward<Args>(args)...));
+        }
+    }
+
+    template <class... Args>
+    void error(const char* category, fmt::format_string<Args...> format, Args&&... args) {
+        if constexpr (isLogLevelEnabled(LogLevel::Error)) {
+            enqueue(LogLevel::Error, category, LazyMessage::capture(format, std::forward<Args>(args)...));
+        }
+    }
+
+    template <class... Args>
+    void success(const char* category, fmt::format_string<Args...> format, Args&&... args) {
+        enqueue(LogLevel::Success, category, LazyMessage::capture(format, std::forward<Args>(args)...));
+    }
     
     std::vector<LogEntry> getAllLogs();
     std::vector<LogEntry> getRecentLogs(size_t count = 50);
     void clearLogs();
-    void loadFromDisk();
-    void forceSave();  // Force immediate save to disk
+    void loadFromDisk();  // Reads only the last MAX_HISTORY records
+    void forceSave();  // Ask the flusher to write the log file now, without waiting
+    void flush();      // Block (briefly) until everything logged so far is on disk
+
+    uint64_t getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
 };
 
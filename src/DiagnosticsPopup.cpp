@@ -0,0 +1,165 @@
+/**
+ * BetterSave - Diagnostics Popup
+ * Created by: sidastuff
+ */
+
+#include "DiagnosticsPopup.hpp"
+#include "LogsViewerPopup.hpp"
+#include "SyncEngine.hpp"
+#include "core/Metrics.hpp"
+
+DiagnosticsPopup* DiagnosticsPopup::create() {
+    auto ret = new DiagnosticsPopup();
+    if (ret && ret->initAnchored(400.f, 280.f)) {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+bool DiagnosticsPopup::setup() {
+    this->setTitle("BetterSave Diagnostics");
+    
+    auto winSize = this->m_mainLayer->getContentSize();
+    
+    // Info text
+    auto infoText = CCLabelBMFont::create(
+        "Transfer metrics for this session",
+        "bigFont.fnt"
+    );
+    infoText->setPosition(winSize.width / 2, winSize.height / 2 + 100);
+    infoText->setScale(0.4f);
+    this->m_mainLayer->addChild(infoText);
+    
+    auto metricsBG = CCScale9Sprite::create("square02b_001.png", { 0, 0, 80, 80 });
+    metricsBG->setContentSize({ 360, 160 });
+    metricsBG->setColor({ 0, 0, 0 });
+    metricsBG->setOpacity(100);
+    metricsBG->setPosition(winSize.width / 2, winSize.height / 2 + 10);
+    this->m_mainLayer->addChild(metricsBG);
+    
+    m_metricsArea = TextArea::create("Loading metrics...", "chatFont.fnt", 0.6f, 340.f, {0, 0}, 150.f, false);
+    m_metricsArea->setPosition({winSize.width / 2, winSize.height / 2 + 10});
+    this->m_mainLayer->addChild(m_metricsArea);
+    
+    // Button menu
+    m_buttonMenu = CCMenu::create();
+    m_buttonMenu->setPosition(0, 0);
+    this->m_mainLayer->addChild(m_buttonMenu);
+    
+    auto refreshBtn = CCMenuItemSpriteExtra::create(
+        CCSprite::createWithSpriteFrameName("GJ_updateBtn_001.png"),
+        this,
+        menu_selector(DiagnosticsPopup::onRefresh)
+    );
+    refreshBtn->setPosition(winSize.width / 2 - 140, winSize.height / 2 - 100);
+    m_buttonMenu->addChild(refreshBtn);
+    
+    auto exportBtn = ButtonSprite::create("Export", "goldFont.fnt", "GJ_button_01.png", 0.7f);
+    auto exportBtnItem = CCMenuItemSpriteExtra::create(
+        exportBtn,
+        this,
+        menu_selector(DiagnosticsPopup::onExport)
+    );
+    exportBtnItem->setPosition(winSize.width / 2 - 55, winSize.height / 2 - 100);
+    m_buttonMenu->addChild(exportBtnItem);
+    
+    auto logsBtn = ButtonSprite::create("Logs", "goldFont.fnt", "GJ_button_04.png", 0.7f);
+    auto logsBtnItem = CCMenuItemSpriteExtra::create(
+        logsBtn,
+        this,
+        menu_selector(DiagnosticsPopup::onLogs)
+    );
+    logsBtnItem->setPosition(winSize.width / 2 + 35, winSize.height / 2 - 100);
+    m_buttonMenu->addChild(logsBtnItem);
+    
+    auto resetBtn = ButtonSprite::create("Reset", "goldFont.fnt", "GJ_button_06.png", 0.7f);
+    auto resetBtnItem = CCMenuItemSpriteExtra::create(
+        resetBtn,
+        this,
+        menu_selector(DiagnosticsPopup::onReset)
+    );
+    resetBtnItem->setPosition(winSize.width / 2 + 120, winSize.height / 2 - 100);
+    m_buttonMenu->addChild(resetBtnItem);
+    
+    loadMetrics();
+    
+    return true;
+}
+
+void DiagnosticsPopup::loadMetrics() {
+    auto snapshot = bettersave::core::MetricsRegistry::get()->snapshot();
+    
+    if (snapshot.counters.empty() && snapshot.gauges.empty() && snapshot.histograms.empty()) {
+        m_metricsArea->setString("No metrics yet.\n\nUpload, download or check your save to collect some.");
+        return;
+    }
+    
+    std::string content;
+    
+    if (!snapshot.histograms.empty()) {
+        content += "<cy>Timings: p50 / p95 / p99 (count)</c>\n";
+        for (const auto& [name, summary] : snapshot.histograms) {
+            if (summary.count == 0) continue;
+            
+            // Durations are stored in microseconds, milliseconds read better here
+            bool isDuration = name.size() > 3 && name.compare(name.size() - 3, 3, "_us") == 0;
+            if (isDuration) {
+                content += fmt::format("{}: {:.1f} / {:.1f} / {:.1f} ms ({})\n",
+                    name.substr(0, name.size() - 3),
+                    summary.p50 / 1000.0, summary.p95 / 1000.0, summary.p99 / 1000.0, summary.count);
+            } else {
+                content += fmt::format("{}: {} / {} / {} ({})\n",
+                    name, summary.p50, summary.p95, summary.p99, summary.count);
+            }
+        }
+    }
+    
+    if (!snapshot.gauges.empty()) {
+        content += "\n<cy>Last operation</c>\n";
+        for (const auto& [name, value] : snapshot.gauges) {
+            content += fmt::format("{}: {:.2f}\n", name, value);
+        }
+    }
+    
+    if (!snapshot.counters.empty()) {
+        content += "\n<cy>Totals</c>\n";
+        for (const auto& [name, value] : snapshot.counters) {
+            content += fmt::format("{}: {}\n", name, value);
+        }
+    }
+    
+    m_metricsArea->setString(content);
+}
+
+void DiagnosticsPopup::onRefresh(CCObject*) {
+    loadMetrics();
+}
+
+void DiagnosticsPopup::onExport(CCObject*) {
+    auto path = SyncEngine::getMetricsPath();
+    if (bettersave::core::MetricsRegistry::get()->exportJson(path)) {
+        FLAlertLayer::create("Metrics Exported", fmt::format("Saved to:\n{}", path.string()), "OK")->show();
+    } else {
+        FLAlertLayer::create("Export Failed", "Could not write the metrics file.", "OK")->show();
+    }
+}
+
+void DiagnosticsPopup::onReset(CCObject*) {
+    geode::createQuickPopup(
+        "Reset Metrics",
+        "This will zero every BetterSave metric for this session.\nAre you sure?",
+        "Cancel", "Reset",
+        [this](auto, bool btn2) {
+            if (btn2) {
+                bettersave::core::MetricsRegistry::get()->reset();
+                loadMetrics();
+            }
+        }
+    );
+}
+
+void DiagnosticsPopup::onLogs(CCObject*) {
+    LogsViewerPopup::create()->show();
+}
@@ -0,0 +1,27 @@
+/**
+ * BetterSave - Diagnostics Popup
+ * Transfer metrics: request latency percentiles, throughput, stage and main-thread time
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <Geode/Geode.hpp>
+#include <Geode/ui/Popup.hpp>
+
+using namespace geode::prelude;
+
+class DiagnosticsPopup : public Popup<> {
+protected:
+    TextArea* m_metricsArea;
+    CCMenu* m_buttonMenu;
+
+    bool setup() override;
+    void onRefresh(CCObject*);
+    void onExport(CCObject*);
+    void onReset(CCObject*);
+    void onLogs(CCObject*);
+    void loadMetrics();
+
+public:
+    static DiagnosticsPopup* create();
+};
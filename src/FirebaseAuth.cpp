@@ -1,5 +1,7 @@
 #include "FirebaseAuth.hpp"
 #include "BetterSaveLogger.hpp"
+#include "SettingsManager.hpp"
+#include "RateLimiter.hpp"
 #include <Geode/utils/web.hpp>
 #include <Geode/loader/Dirs.hpp>
 #include <matjson.hpp>
@@ -7,8 +9,26 @@
 
 FirebaseAuth* FirebaseAuth::s_instance = nullptr;
 
+std::string FirebaseAuth::getDatabaseUrl(const std::string& path) const {
+    auto& databaseUrl = SettingsManager::get()->getSettings().databaseUrl;
+    return fmt::format("{}/{}.json?auth={}", databaseUrl.empty() ? DEFAULT_DATABASE_URL : databaseUrl, path, m_idToken);
+}
+
+// Repeated attempts are refused locally, with the time left, instead of being sent to Firebase
+static bool checkLoginLimit(const std::function<void(bool, const std::string&)>& callback) {
+    if (RateLimiter::get()->tryAcquire(RateLimiter::LOGIN)) {
+        return true;
+    }
+    auto wait = std::chrono::ceil<std::chrono::seconds>(RateLimiter::get()->timeUntilAllowed(RateLimiter::LOGIN));
+    BetterSaveLogger::get()->warning("Auth", "Too many login attempts, next one allowed in {}s", wait.count());
+    callback(false, fmt::format("Too many attempts, try again in {} seconds", wait.count()));
+    return false;
+}
+
 void FirebaseAuth::signUp(const std::string& email, const std::string& password,
                           std::function<void(bool, const std::string&)> callback) {
+    if (!checkLoginLimit(callback)) return;
+
     std::string url = fmt::format(
         "https://identitytoolkit.googleapis.com/v1/accounts:signUp?key={}",
         API_KEY
@@ -29,7 +49,7 @@ void FirebaseAuth::signUp(const std::string& email, const std::string& password,
                 this->handleAuthResponse(dataString, callback);
             } else {
                 auto error = response->string().unwrapOr("Unknown error");
-                BetterSaveLogger::get()->error("Auth", fmt::format("Signup failed: {}", error));
+                BetterSaveLogger::get()->error("Auth", "Signup failed: {}", error);
             
             // Parse error message
             std::string errorMsg = "Sign up failed";
@@ -51,6 +71,8 @@ void FirebaseAuth::signUp(const std::string& email, const std::string& password,
 
 void FirebaseAuth::signIn(const std::string& email, const std::string& password,
                           std::function<void(bool, const std::string&)> callback) {
+    if (!checkLoginLimit(callback)) return;
+
     std::string url = fmt::format(
         "https://identitytoolkit.googleapis.com/v1/accounts:signInWithPassword?key={}",
         API_KEY
@@ -71,7 +93,7 @@ void FirebaseAuth::signIn(const std::string& email, const std::string& password,
                 this->handleAuthResponse(dataString, callback);
             } else {
                 auto error = response->string().unwrapOr("Unknown error");
-                BetterSaveLogger::get()->error("Auth", fmt::format("Login failed: {}", error));
+                BetterSaveLogger::get()->error("Auth", "Login failed: {}", error);
             
             // Parse error message
             std::string errorMsg = "Sign in failed";
@@ -123,9 +145,9 @@ void FirebaseAuth::saveCredentials() {
         file << creds.dump();
         file.close();
         
-        BetterSaveLogger::get()->info("Auth", fmt::format("Credentials saved for: {}", m_email));
+        BetterSaveLogger::get()->info("Auth", "Credentials saved for: {}", m_email);
     } catch (const std::exception& e) {
-        BetterSaveLogger::get()->error("Auth", fmt::format("Failed to save credentials: {}", e.what()));
+        BetterSaveLogger::get()->error("Auth", "Failed to save credentials: {}", e.what());
     }
 }
 
@@ -169,11 +191,11 @@ bool FirebaseAuth::loadCredentials() {
         
         m_isLoggedIn = true;
         
-        BetterSaveLogger::get()->success("Auth", fmt::format("Credentials loaded for: {}", m_email));
+        BetterSaveLogger::get()->success("Auth", "Credentials loaded for: {}", m_email);
         return true;
         
     } catch (const std::exception& e) {
-        BetterSaveLogger::get()->error("Auth", fmt::format("Failed to load credentials: {}", e.what()));
+        BetterSaveLogger::get()->error("Auth", "Failed to load credentials: {}", e.what());
         return false;
     }
 }
@@ -230,6 +252,6 @@ void FirebaseAuth::handleAuthResponse(const std::string& response,
     // Save credentials for auto-login
     saveCredentials();
     
-    BetterSaveLogger::get()->success("Auth", fmt::format("User authenticated: {}", m_email));
+    BetterSaveLogger::get()->success("Auth", "User authenticated: {}", m_email);
     callback(true, "Authentication successful!");
 }
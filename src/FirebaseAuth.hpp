@@ -10,6 +10,7 @@ private:
     static constexpr const char* API_KEY = "placeholder";
     static constexpr const char* AUTH_DOMAIN = "gdbettersave.firebaseapp.com";
     static constexpr const char* PROJECT_ID = "gdbettersave";
+    static constexpr const char* DEFAULT_DATABASE_URL = "https://gdbettersave-default-rtdb.firebaseio.com";
     
     static FirebaseAuth* s_instance;
     std::string m_idToken;
@@ -59,6 +60,10 @@ public:
     
     // Get ID token for authenticated requests
     std::string getIdToken() const { return m_idToken; }
+    
+    // Authenticated REST URL for a database path (e.g. "users/<id>/saveData").
+    // Uses the databaseUrl setting if set, so a local stand-in server can be used.
+    std::string getDatabaseUrl(const std::string& path) const;
 
 private:
     void handleAuthResponse(const std::string& response, 
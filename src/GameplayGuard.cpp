@@ -0,0 +1,136 @@
+/**
+ * BetterSave - Gameplay Guard
+ * Created by: sidastuff
+ */
+
+#include "GameplayGuard.hpp"
+#include "SettingsManager.hpp"
+#include "BetterSaveLogger.hpp"
+#include "core/Metrics.hpp"
+
+GameplayGuard* GameplayGuard::s_instance = nullptr;
+
+bool GameplayGuard::isGameplayActive() {
+    if (!PlayLayer::get() && !LevelEditorLayer::get()) {
+        return false;
+    }
+
+    // Pause menus are a safe place to do work, the level isn't rendering gameplay
+    auto scene = CCDirector::sharedDirector()->getRunningScene();
+    if (scene && (scene->getChildByType<PauseLayer>(0) || scene->getChildByType<EditorPauseLayer>(0))) {
+        return false;
+    }
+
+    return true;
+}
+
+void GameplayGuard::runWhenIdle(std::function<void()> task) {
+    if (!isGameplayActive() && m_pendingTasks.empty()) {
+        ScopedTimer timer;
+        task();
+        return;
+    }
+
+    m_deferredTasks++;
+    m_pendingTasks.push_back(std::move(task));
+
+    // Only tick while there is something to drain
+    if (!m_drainScheduled) {
+        m_drainScheduled = true;
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(
+            schedule_selector(GameplayGuard::onDrain), this, 0.f, false);
+    }
+}
+
+void GameplayGuard::onDrain(float) {
+    if (isGameplayActive()) return;
+
+    auto budget = std::chrono::milliseconds(SettingsManager::get()->getSettings().backgroundFrameBudgetMs);
+    auto frameStart = std::chrono::steady_clock::now();
+
+    // The budget is at least 1ms, so the first task always fits
+    while (!m_pendingTasks.empty() && std::chrono::steady_clock::now() - frameStart < budget) {
+        auto task = std::move(m_pendingTasks.front());
+        m_pendingTasks.pop_front();
+        ScopedTimer timer;
+        task();
+    }
+
+    if (m_pendingTasks.empty()) {
+        m_drainScheduled = false;
+        CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(
+            schedule_selector(GameplayGuard::onDrain), this);
+    }
+}
+
+int GameplayGuard::addGameplayListener(std::function<void(bool)> listener) {
+    if (m_gameplayListeners.empty()) {
+        m_gameplayWasActive = isGameplayActive();
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(
+            schedule_selector(GameplayGuard::onCheckGameplay), this, GAMEPLAY_CHECK_SECONDS, false);
+    }
+    int listenerId = m_nextGameplayListenerId++;
+    m_gameplayListeners[listenerId] = std::move(listener);
+    return listenerId;
+}
+
+void GameplayGuard::removeGameplayListener(int listenerId) {
+    m_gameplayListeners.erase(listenerId);
+    if (m_gameplayListeners.empty()) {
+        CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(
+            schedule_selector(GameplayGuard::onCheckGameplay), this);
+    }
+}
+
+void GameplayGuard::onCheckGameplay(float) {
+    bool active = isGameplayActive();
+    if (active == m_gameplayWasActive) return;
+    m_gameplayWasActive = active;
+
+    // Copied, a listener may remove itself
+    auto listeners = m_gameplayListeners;
+    for (auto& [listenerId, listener] : listeners) {
+        listener(active);
+    }
+}
+
+void GameplayGuard::recordMainThreadTime(std::chrono::nanoseconds time, bool duringGameplay) {
+    static auto& menuHistogram = bettersave::core::MetricsRegistry::get()->histogram("main_thread.menu_us");
+    static auto& gameplayHistogram = bettersave::core::MetricsRegistry::get()->histogram("main_thread.gameplay_us");
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    (duringGameplay ? gameplayHistogram : menuHistogram).record(static_cast<uint64_t>(micros));
+
+    if (duringGameplay) {
+        m_gameplayTime += time;
+        m_gameplaySamples++;
+    } else {
+        m_menuTime += time;
+    }
+}
+
+void GameplayGuard::logReport() {
+    auto gameplayUs = std::chrono::duration_cast<std::chrono::microseconds>(m_gameplayTime).count();
+    auto menuUs = std::chrono::duration_cast<std::chrono::microseconds>(m_menuTime).count();
+
+    auto message = fmt::format("Main-thread time during gameplay: {}us ({} samples), in menus: {}us, deferred tasks: {}",
+        gameplayUs, m_gameplaySamples, menuUs, m_deferredTasks);
+    if (m_gameplaySamples == 0) {
+        BetterSaveLogger::get()->info("Gameplay", message);
+    } else {
+        BetterSaveLogger::get()->warning("Gameplay", message);
+    }
+}
+
+void GameplayGuard::resetStats() {
+    m_gameplayTime = std::chrono::nanoseconds(0);
+    m_menuTime = std::chrono::nanoseconds(0);
+    m_gameplaySamples = 0;
+    m_deferredTasks = 0;
+}
+
+GameplayGuard::ScopedTimer::ScopedTimer()
+    : m_start(std::chrono::steady_clock::now()), m_duringGameplay(GameplayGuard::isGameplayActive()) {}
+
+GameplayGuard::ScopedTimer::~ScopedTimer() {
+    GameplayGuard::get()->recordMainThreadTime(std::chrono::steady_clock::now() - m_start, m_duringGameplay);
+}
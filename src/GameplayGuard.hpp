@@ -0,0 +1,71 @@
+/**
+ * BetterSave - Gameplay Guard
+ * Keeps BetterSave work off the main thread while a level is being played
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <Geode/Geode.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+
+using namespace geode::prelude;
+
+class GameplayGuard : public CCObject {
+private:
+    static GameplayGuard* s_instance;
+    std::deque<std::function<void()>> m_pendingTasks;
+    bool m_drainScheduled = false;
+
+    std::map<int, std::function<void(bool)>> m_gameplayListeners;
+    int m_nextGameplayListenerId = 1;
+    bool m_gameplayWasActive = false;
+    // How often gameplay is checked for while anyone listens
+    static constexpr float GAMEPLAY_CHECK_SECONDS = 0.1f;
+
+    // Instrumentation: main-thread time BetterSave spent, split by scene type
+    std::chrono::nanoseconds m_gameplayTime{0};
+    std::chrono::nanoseconds m_menuTime{0};
+    int m_gameplaySamples = 0;
+    int m_deferredTasks = 0;
+
+    void onDrain(float dt);
+    void onCheckGameplay(float dt);
+
+public:
+    static GameplayGuard* get() {
+        if (!s_instance) {
+            s_instance = new GameplayGuard();
+        }
+        return s_instance;
+    }
+
+    // True while a level (or the editor) is running and not paused
+    static bool isGameplayActive();
+
+    // Run now if we're in a menu or pause screen, otherwise queue until gameplay stops.
+    // Queued tasks are drained a few per frame, within the configured frame budget.
+    void runWhenIdle(std::function<void()> task);
+
+    // Work already running when a level starts: listener hears true when gameplay starts and
+    // false when it stops. Only checked while someone listens.
+    int addGameplayListener(std::function<void(bool active)> listener);
+    void removeGameplayListener(int listenerId);
+
+    void recordMainThreadTime(std::chrono::nanoseconds time, bool duringGameplay);
+    void logReport();
+    void resetStats();
+
+    // Measures a block of BetterSave main-thread work
+    class ScopedTimer {
+    private:
+        std::chrono::steady_clock::time_point m_start;
+        bool m_duringGameplay;
+
+    public:
+        ScopedTimer();
+        ~ScopedTimer();
+    };
+};
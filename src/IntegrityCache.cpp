@@ -0,0 +1,163 @@
+/**
+ * BetterSave - Integrity Cache
+ * Created by: sidastuff
+ */
+
+#include "IntegrityCache.hpp"
+#include "BetterSaveLogger.hpp"
+#include <Geode/loader/Dirs.hpp>
+#include <matjson.hpp>
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+IntegrityCache* IntegrityCache::s_instance = nullptr;
+
+IntegrityCache::IntegrityCache() {
+    m_cacheFilePath = geode::dirs::getSaveDir() / "bettersave_integrity_cache.json";
+    loadFromFile();
+}
+
+std::optional<FileSignature> IntegrityCache::getSignature(const std::filesystem::path& filePath) {
+    std::error_code ec;
+    FileSignature signature;
+
+    signature.size = std::filesystem::file_size(filePath, ec);
+    if (ec) return std::nullopt;
+
+    auto writeTime = std::filesystem::last_write_time(filePath, ec);
+    if (ec) return std::nullopt;
+    signature.mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+
+    #ifdef _WIN32
+        // Windows has no inode in stat(), use the NTFS file index instead
+        HANDLE handle = CreateFileW(filePath.wstring().c_str(), 0,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle != INVALID_HANDLE_VALUE) {
+            BY_HANDLE_FILE_INFORMATION info;
+            if (GetFileInformationByHandle(handle, &info)) {
+                signature.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+            }
+            CloseHandle(handle);
+        }
+    #else
+        struct stat st;
+        if (stat(filePath.string().c_str(), &st) == 0) {
+            signature.inode = static_cast<uint64_t>(st.st_ino);
+        }
+    #endif
+
+    return signature;
+}
+
+std::optional<IntegrityResult> IntegrityCache::lookup(const std::filesystem::path& filePath, const FileSignature& signature) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(filePath.string());
+    if (it == m_entries.end() || it->second.signature != signature) {
+        return std::nullopt;
+    }
+
+    auto result = it->second.result;
+    result.fromCache = true;
+    return result;
+}
+
+void IntegrityCache::store(const std::filesystem::path& filePath, const FileSignature& signature, const IntegrityResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& entry = m_entries[filePath.string()];
+        entry.signature = signature;
+        entry.result = result;
+        entry.result.fromCache = false;
+    }
+    saveToFile();
+}
+
+void IntegrityCache::invalidate(const std::filesystem::path& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.erase(filePath.string()) == 0) return;
+    }
+    saveToFile();
+}
+
+void IntegrityCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+    saveToFile();
+}
+
+void IntegrityCache::saveToFile() {
+    try {
+        // Held for the write too, scans store results from several threads at once
+        std::lock_guard<std::mutex> lock(m_mutex);
+        matjson::Value json;
+
+        for (const auto& [path, entry] : m_entries) {
+            matjson::Value cacheEntry;
+            cacheEntry["size"] = static_cast<int64_t>(entry.signature.size);
+            cacheEntry["mtime"] = entry.signature.mtime;
+            cacheEntry["inode"] = static_cast<int64_t>(entry.signature.inode);
+            cacheEntry["isValid"] = entry.result.isValid;
+            cacheEntry["message"] = entry.result.message;
+            cacheEntry["checksum"] = entry.result.checksum;
+            json[path] = cacheEntry;
+        }
+
+        std::ofstream file(m_cacheFilePath, std::ios::out | std::ios::trunc);
+        if (file.is_open()) {
+            file << json.dump();
+            file.close();
+        }
+    } catch (const std::exception& e) {
+        // geode::log rather than BetterSaveLogger, this can run on a scan thread
+        geode::log::error("Failed to save integrity cache: {}", e.what());
+    }
+}
+
+void IntegrityCache::loadFromFile() {
+    try {
+        if (!std::filesystem::exists(m_cacheFilePath)) {
+            return;
+        }
+
+        std::ifstream file(m_cacheFilePath);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        file.close();
+
+        auto jsonResult = matjson::parse(buffer.str());
+        if (!jsonResult.isOk() || !jsonResult.unwrap().isObject()) {
+            return;
+        }
+
+        auto json = jsonResult.unwrap();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+
+        for (const auto& [path, entryJson] : json) {
+            if (!entryJson.isObject()) continue;
+
+            CacheEntry entry;
+            entry.signature.size = static_cast<uint64_t>(entryJson["size"].asInt().unwrapOr(0));
+            entry.signature.mtime = static_cast<int64_t>(entryJson["mtime"].asInt().unwrapOr(0));
+            entry.signature.inode = static_cast<uint64_t>(entryJson["inode"].asInt().unwrapOr(0));
+            entry.result.isValid = entryJson["isValid"].asBool().unwrapOr(false);
+            entry.result.message = entryJson["message"].asString().unwrapOr("");
+            entry.result.checksum = entryJson["checksum"].asString().unwrapOr("");
+            entry.result.fileSize = static_cast<size_t>(entry.signature.size);
+
+            m_entries[path] = entry;
+        }
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->error("Integrity", "Failed to load integrity cache: {}", e.what());
+    }
+}
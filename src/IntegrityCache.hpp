@@ -0,0 +1,65 @@
+/**
+ * BetterSave - Integrity Cache
+ * Remembers integrity results per save file so unchanged files are never re-read
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <Geode/Geode.hpp>
+#include "SaveIntegrityChecker.hpp"
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+using namespace geode::prelude;
+
+// Cheap stat() fingerprint of a file. If any field changes, the file is reprocessed.
+struct FileSignature {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+
+    bool operator==(const FileSignature& other) const {
+        return size == other.size && mtime == other.mtime && inode == other.inode;
+    }
+    bool operator!=(const FileSignature& other) const { return !(*this == other); }
+};
+
+class IntegrityCache {
+private:
+    static IntegrityCache* s_instance;
+
+    struct CacheEntry {
+        FileSignature signature;
+        IntegrityResult result;
+    };
+
+    std::unordered_map<std::string, CacheEntry> m_entries;
+    std::filesystem::path m_cacheFilePath;
+    std::mutex m_mutex;
+
+    void saveToFile();
+    void loadFromFile();
+
+public:
+    // Integrity checks run on pool workers too, any of them may be the first caller
+    static IntegrityCache* get() {
+        static std::once_flag s_created;
+        std::call_once(s_created, []() { s_instance = new IntegrityCache(); });
+        return s_instance;
+    }
+
+    IntegrityCache();
+
+    // Read the stat signature of a file (nullopt if it doesn't exist)
+    static std::optional<FileSignature> getSignature(const std::filesystem::path& filePath);
+
+    // Returns the cached result if the file still has the given signature
+    std::optional<IntegrityResult> lookup(const std::filesystem::path& filePath, const FileSignature& signature);
+
+    // Store a freshly computed result and persist the cache
+    void store(const std::filesystem::path& filePath, const FileSignature& signature, const IntegrityResult& result);
+
+    void invalidate(const std::filesystem::path& filePath);
+    void clear();
+};
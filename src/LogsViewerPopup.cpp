@@ -83,9 +83,7 @@ bool LogsViewerPopup::setup() {
 }
 
 void LogsViewerPopup::loadLogs() {
-    // Force reload from disk to ensure we have latest logs
-    BetterSaveLogger::get()->loadFromDisk();
-    
+    // The in-memory history is always newer than the file, which is written in the background
     auto logs = BetterSaveLogger::get()->getRecentLogs(50);
     
     std::string logsContent;
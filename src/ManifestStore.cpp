@@ -0,0 +1,152 @@
+/**
+ * BetterSave - Manifest Store
+ * Created by: sidastuff
+ */
+
+#include "ManifestStore.hpp"
+#include "BetterSaveLogger.hpp"
+#include "FirebaseAuth.hpp"
+#include "SaveIntegrityChecker.hpp"
+#include <Geode/loader/Dirs.hpp>
+#include <matjson.hpp>
+#include <fstream>
+#include <sstream>
+
+ManifestStore* ManifestStore::s_instance = nullptr;
+
+static matjson::Value fileToJson(const CommittedFile& file) {
+    matjson::Value json;
+    json["checksum"] = file.checksum;
+    json["size"] = static_cast<int64_t>(file.signature.size);
+    json["mtime"] = file.signature.mtime;
+    json["inode"] = static_cast<int64_t>(file.signature.inode);
+    json["chunks"] = file.chunks;
+    json["chunkSize"] = file.chunkSize;
+    json["pages"] = file.pages;
+    json["generation"] = file.generation;
+    json["baseChecksum"] = file.baseChecksum;
+    json["patchGeneration"] = file.patchGeneration;
+    json["patchChunks"] = file.patchChunks;
+    json["patchPages"] = file.patchPages;
+    json["plistChecksum"] = file.plistChecksum;
+    json["keyNodes"] = file.keyNodes;
+    json["keyPages"] = file.keyPages;
+    return json;
+}
+
+static CommittedFile fileFromJson(const matjson::Value& json) {
+    CommittedFile file;
+    file.checksum = json["checksum"].asString().unwrapOr("");
+    file.signature.size = static_cast<uint64_t>(json["size"].asInt().unwrapOr(0));
+    file.signature.mtime = static_cast<int64_t>(json["mtime"].asInt().unwrapOr(0));
+    file.signature.inode = static_cast<uint64_t>(json["inode"].asInt().unwrapOr(0));
+    file.chunks = json["chunks"].as<int>().unwrapOr(0);
+    file.chunkSize = json["chunkSize"].as<int>().unwrapOr(0);
+    file.pages = json["pages"].as<int>().unwrapOr(0);
+    file.generation = json["generation"].asString().unwrapOr("");
+    file.baseChecksum = json["baseChecksum"].asString().unwrapOr("");
+    file.patchGeneration = json["patchGeneration"].asString().unwrapOr("");
+    file.patchChunks = json["patchChunks"].as<int>().unwrapOr(0);
+    file.patchPages = json["patchPages"].as<int>().unwrapOr(0);
+    file.plistChecksum = json["plistChecksum"].asString().unwrapOr("");
+    file.keyNodes = json["keyNodes"].as<int>().unwrapOr(0);
+    file.keyPages = json["keyPages"].as<int>().unwrapOr(0);
+    return file;
+}
+
+ManifestStore::ManifestStore() {
+    m_manifestFilePath = geode::dirs::getSaveDir() / "bettersave_manifest.json";
+    loadFromFile();
+}
+
+CommittedManifest ManifestStore::getLastCommitted() {
+    // A manifest committed by another account says nothing about this one's cloud save
+    if (!m_manifest.valid || m_manifest.userId != FirebaseAuth::get()->getUserId()) {
+        return CommittedManifest();
+    }
+    return m_manifest;
+}
+
+void ManifestStore::commit(const CommittedManifest& manifest) {
+    m_manifest = manifest;
+    m_manifest.valid = true;
+    saveToFile();
+    BetterSaveLogger::get()->info("Manifest", "Committed manifest (GM: {}, LL: {})",
+        manifest.gameManager.checksum, manifest.localLevels.checksum);
+}
+
+void ManifestStore::clear() {
+    m_manifest = CommittedManifest();
+    saveToFile();
+}
+
+bool ManifestStore::matches(const std::filesystem::path& filePath, const CommittedFile& committed) {
+    if (committed.checksum.empty()) return false;
+
+    auto signature = IntegrityCache::getSignature(filePath);
+    if (!signature) return false;
+
+    // Fast path: nothing touched the file since it was committed
+    if (*signature == committed.signature) return true;
+
+    // Touched but maybe not changed (GD rewrites identical saves), compare content
+    if (signature->size != committed.signature.size) return false;
+    auto result = SaveIntegrityChecker::checkFile(filePath);
+    if (result.checksum != committed.checksum) return false;
+
+    // Same content: remember the new signature so the next check is stat-only again
+    if (m_manifest.gameManager.checksum == committed.checksum && m_manifest.gameManager.signature == committed.signature) {
+        m_manifest.gameManager.signature = *signature;
+    }
+    if (m_manifest.localLevels.checksum == committed.checksum && m_manifest.localLevels.signature == committed.signature) {
+        m_manifest.localLevels.signature = *signature;
+    }
+    saveToFile();
+    return true;
+}
+
+void ManifestStore::saveToFile() {
+    try {
+        matjson::Value json;
+        json["valid"] = m_manifest.valid;
+        json["userId"] = m_manifest.userId;
+        json["timestamp"] = m_manifest.timestamp;
+        json["gameManager"] = fileToJson(m_manifest.gameManager);
+        json["localLevels"] = fileToJson(m_manifest.localLevels);
+
+        std::ofstream file(m_manifestFilePath, std::ios::out | std::ios::trunc);
+        if (file.is_open()) {
+            file << json.dump();
+            file.close();
+        }
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->error("Manifest", "Failed to save manifest: {}", e.what());
+    }
+}
+
+void ManifestStore::loadFromFile() {
+    try {
+        if (!std::filesystem::exists(m_manifestFilePath)) {
+            return;
+        }
+
+        std::ifstream file(m_manifestFilePath);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        file.close();
+
+        auto jsonResult = matjson::parse(buffer.str());
+        if (!jsonResult.isOk() || !jsonResult.unwrap().isObject()) {
+            return;
+        }
+
+        auto json = jsonResult.unwrap();
+        m_manifest.valid = json["valid"].asBool().unwrapOr(false);
+        m_manifest.userId = json["userId"].asString().unwrapOr("");
+        m_manifest.timestamp = static_cast<int64_t>(json["timestamp"].asInt().unwrapOr(0));
+        m_manifest.gameManager = fileFromJson(json["gameManager"]);
+        m_manifest.localLevels = fileFromJson(json["localLevels"]);
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->error("Manifest", "Failed to load manifest: {}", e.what());
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * BetterSave - Manifest Store
+ * Remembers what was last committed to the cloud so unchanged saves can be skipped
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <Geode/Geode.hpp>
+#include "IntegrityCache.hpp"
+#include <string>
+
+using namespace geode::prelude;
+
+struct CommittedFile {
+    std::string checksum;
+    FileSignature signature;
+    int chunks = 0;
+    // 0 if unknown (committed before chunk sizes were recorded)
+    int chunkSize = 0;
+    // Index pages, 0 for a file committed before chunks were paged
+    int pages = 0;
+    // Generation the chunks and pages are stored under, empty for a file committed before generations
+    std::string generation;
+    // For a file committed as a patch: the base the chunks above hold, and the patch's chunks and pages
+    std::string baseChecksum;
+    std::string patchGeneration;
+    int patchChunks = 0;
+    int patchPages = 0;
+    // For a file committed key by key: the plist's checksum, its nodes and their index pages
+    std::string plistChecksum;
+    int keyNodes = 0;
+    int keyPages = 0;
+};
+
+struct CommittedManifest {
+    bool valid = false;
+    std::string userId;
+    int64_t timestamp = 0;
+    CommittedFile gameManager;
+    CommittedFile localLevels;
+};
+
+class ManifestStore {
+private:
+    static ManifestStore* s_instance;
+    CommittedManifest m_manifest;
+    std::filesystem::path m_manifestFilePath;
+
+    void saveToFile();
+    void loadFromFile();
+
+public:
+    static ManifestStore* get() {
+        if (!s_instance) {
+            s_instance = new ManifestStore();
+        }
+        return s_instance;
+    }
+
+    ManifestStore();
+
+    // Last manifest committed by the logged in user (valid == false if none)
+    CommittedManifest getLastCommitted();
+
+    // Record a manifest after a successful upload or restore
+    void commit(const CommittedManifest& manifest);
+    void clear();
+
+    // True if the file on disk still matches the committed fingerprint.
+    // Checks the stat signature first and only falls back to the checksum if it changed.
+    bool matches(const std::filesystem::path& filePath, const CommittedFile& committed);
+};
@@ -168,3 +168,87 @@ void ProgressPopup::onClose(CCObject* sender) {
     Popup::onClose(sender);
 }
 
+void ProgressPopup::followSync(SyncOperation operation) {
+    m_operation = operation;
+    
+    if (operation == SyncOperation::Upload || operation == SyncOperation::Download) {
+        auto winSize = this->m_mainLayer->getContentSize();
+        
+        m_controlMenu = CCMenu::create();
+        m_controlMenu->setPosition(0, 0);
+        this->m_mainLayer->addChild(m_controlMenu);
+        
+        m_pauseSprite = ButtonSprite::create("Pause", "goldFont.fnt", "GJ_button_01.png", 0.6f);
+        auto pauseBtn = CCMenuItemSpriteExtra::create(
+            m_pauseSprite,
+            this,
+            menu_selector(ProgressPopup::onPauseResume)
+        );
+        pauseBtn->setPosition(winSize.width / 2 - 50, winSize.height / 2 - 82);
+        m_controlMenu->addChild(pauseBtn);
+        
+        auto cancelBtn = CCMenuItemSpriteExtra::create(
+            ButtonSprite::create("Cancel", "goldFont.fnt", "GJ_button_06.png", 0.6f),
+            this,
+            menu_selector(ProgressPopup::onCancelOperation)
+        );
+        cancelBtn->setPosition(winSize.width / 2 + 50, winSize.height / 2 - 82);
+        m_controlMenu->addChild(cancelBtn);
+    }
+    
+    // Stay alive until the operation reports back, even if the popup is closed
+    this->retain();
+    m_syncListenerId = SyncEngine::get()->addListener([this, operation](const SyncEvent& event) {
+        if (event.operation != operation) return;
+        
+        switch (event.type) {
+            case SyncEventType::Started:
+            case SyncEventType::Status:
+                setStatus(event.message, {255, 255, 100});
+                break;
+            case SyncEventType::Progress:
+                setStatus(event.message, {100, 200, 255});
+                setProgress(event.current, event.total);
+                break;
+            case SyncEventType::Completed:
+            case SyncEventType::Failed:
+                setStatus(event.message, event.type == SyncEventType::Completed
+                    ? ccColor3B{100, 255, 100} : ccColor3B{255, 100, 100});
+                enableCloseButton();
+                if (m_controlMenu) {
+                    m_controlMenu->setVisible(false);
+                }
+                SyncEngine::get()->removeListener(m_syncListenerId);
+                m_syncListenerId = 0;
+                this->release();
+                break;
+        }
+    });
+}
+
+void ProgressPopup::onPauseResume(CCObject*) {
+    auto engine = SyncEngine::get();
+    if (engine->isPaused(m_operation)) {
+        if (engine->resume(m_operation)) {
+            m_pauseSprite->setString("Pause");
+        }
+    } else if (engine->pause(m_operation)) {
+        m_pauseSprite->setString("Resume");
+    }
+}
+
+void ProgressPopup::onCancelOperation(CCObject*) {
+    auto operation = m_operation;
+    geode::createQuickPopup(
+        "Cancel",
+        operation == SyncOperation::Upload
+            ? "Stop this upload?\n\nYour cloud save stays as it was.\nChunks already sent are <cg>skipped next time</c>."
+            : "Stop this download?\n\nYour local save <cg>stays as it was</c>.",
+        "Keep Going", "Stop",
+        [operation](auto, bool btn2) {
+            if (btn2) {
+                SyncEngine::get()->cancel(operation);
+            }
+        }
+    );
+}
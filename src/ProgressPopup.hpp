@@ -1,6 +1,7 @@
 #pragma once
 #include <Geode/Geode.hpp>
 #include <Geode/ui/Popup.hpp>
+#include "SyncEngine.hpp"
 #include <functional>
 
 using namespace geode::prelude;
@@ -16,6 +17,10 @@ protected:
     bool m_fullscreenMode = false;
     CCLayerColor* m_blackBackground = nullptr;
     std::vector<CCNode*> m_hiddenLayers;
+    int m_syncListenerId = 0;
+    SyncOperation m_operation = SyncOperation::Upload;
+    CCMenu* m_controlMenu = nullptr;
+    ButtonSprite* m_pauseSprite = nullptr;
     
     bool setup() override;
     void onClose(CCObject* sender) override;
@@ -25,6 +30,9 @@ protected:
     void hideAllLayers();
     void restoreAllLayers();
     
+    void onPauseResume(CCObject*);
+    void onCancelOperation(CCObject*);
+    
 public:
     static ProgressPopup* create(const std::string& title, bool fullscreen = false);
     void setTitle(const std::string& title);
@@ -35,5 +43,9 @@ public:
     void enableCloseButton();
     void setFullscreenMode(bool fullscreen);
     void closePopup();
+    
+    // Mirror a SyncEngine operation's events until it completes or fails.
+    // Uploads and downloads also get Pause/Resume and Cancel buttons.
+    void followSync(SyncOperation operation);
 };
 
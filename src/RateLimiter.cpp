@@ -6,48 +6,258 @@
 
 #include "RateLimiter.hpp"
 #include "BetterSaveLogger.hpp"
+#include "core/Metrics.hpp"
+#include <algorithm>
+
+using bettersave::core::AdaptiveThrottle;
+using bettersave::core::MetricsRegistry;
+using bettersave::core::RatePolicy;
+using bettersave::core::ThrottleConfig;
 
 RateLimiter* RateLimiter::s_instance = nullptr;
 
-bool RateLimiter::checkLimit(const std::string& action, int maxRequests, int windowSeconds) {
-    auto now = std::chrono::system_clock::now();
-    
-    // Check if we have a limit for this action
-    if (m_limits.find(action) == m_limits.end()) {
-        // First request, create new limit
-        m_limits[action] = {1, now};
+RateLimiter::RateLimiter() {
+    // Well under the Realtime Database's per-client limits, with a burst that fills the
+    // connection pool. Uploads used to fire every chunk at once and fail together.
+    // That's the ceiling; 429/503s and slow responses bring it down until the server recovers.
+    ThrottleConfig database;
+    database.maxRate = 100;
+    database.maxConcurrency = 32;
+    setAdaptive(DATABASE_REQUEST, database);
+    // Five tries, then one more every 12 seconds
+    m_limits.try_emplace(LOGIN, RateLimit{bettersave::core::TokenBucket(RatePolicy{5.0 / 60.0, 5}), {}});
+}
+
+void RateLimiter::setPolicy(const std::string& action, RatePolicy policy) {
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_limits.try_emplace(action, RateLimit{bettersave::core::TokenBucket(policy), {}});
+    if (!inserted) {
+        it->second.bucket.setPolicy(policy);
+    }
+}
+
+std::optional<RatePolicy> RateLimiter::getPolicy(const std::string& action) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_limits.find(action);
+    if (it == m_limits.end()) {
+        return std::nullopt;
+    }
+    return it->second.bucket.policy();
+}
+
+void RateLimiter::setAdaptive(const std::string& action, ThrottleConfig config) {
+    std::lock_guard lock(m_mutex);
+    AdaptiveThrottle throttle(config);
+    RatePolicy policy{throttle.rate(), throttle.concurrency()};
+    auto [it, inserted] = m_limits.try_emplace(action, RateLimit{bettersave::core::TokenBucket(policy), {}});
+    it->second.bucket.setPolicy(policy);
+    it->second.throttle = throttle;
+}
+
+bool RateLimiter::admit(RateLimit& limit, std::chrono::steady_clock::time_point now) {
+    if (limit.throttle) {
+        if (limit.inFlight >= limit.throttle->concurrency() ||
+            limit.throttle->timeUntilResume(now) > std::chrono::steady_clock::duration::zero()) {
+            return false;
+        }
+    }
+    if (!limit.bucket.tryAcquire(now)) {
+        return false;
+    }
+    if (limit.throttle) {
+        limit.inFlight++;
+    }
+    return true;
+}
+
+bool RateLimiter::tryAcquire(const std::string& action) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_limits.find(action);
+    if (it == m_limits.end()) {
         return true;
     }
+    // Queued acquire() callers go first
+    return it->second.waiting.empty() && admit(it->second, std::chrono::steady_clock::now());
+}
+
+std::chrono::steady_clock::duration RateLimiter::timeUntilAllowed(const std::string& action) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_limits.find(action);
+    if (it == m_limits.end()) {
+        return std::chrono::steady_clock::duration::zero();
+    }
+    // Everyone already queued is admitted first, one interval apart
+    auto& limit = it->second;
+    auto now = std::chrono::steady_clock::now();
+    auto wait = limit.bucket.timeUntilAllowed(now, static_cast<int>(limit.waiting.size()) + 1);
+    if (limit.throttle) {
+        wait = std::max(wait, limit.throttle->timeUntilResume(now));
+    }
+    return wait;
+}
+
+void RateLimiter::acquire(const std::string& action, std::function<void()> task) {
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_limits.find(action);
+        if (it != m_limits.end() && (!it->second.waiting.empty() || !admit(it->second, std::chrono::steady_clock::now()))) {
+            // Time spent queued shows up in the diagnostics, separate from request latency
+            it->second.waiting.push_back([task = std::move(task), queuedAt = std::chrono::steady_clock::now()]() {
+                static auto& waitHistogram = MetricsRegistry::get()->histogram("rate_limit_wait_us");
+                auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queuedAt);
+                waitHistogram.record(static_cast<uint64_t>(waited.count()));
+                task();
+            });
+            scheduleDrain();
+            return;
+        }
+    }
+    task();
+}
+
+// Called with m_mutex held; the drain tick itself must be registered from the main thread
+void RateLimiter::scheduleDrain() {
+    if (m_drainScheduled) return;
+    m_drainScheduled = true;
+    Loader::get()->queueInMainThread([this]() {
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(
+            schedule_selector(RateLimiter::onDrain), this, 0.f, false);
+    });
+}
+
+void RateLimiter::onDrain(float) {
+    std::vector<std::function<void()>> ready;
+    bool pending = false;
+    {
+        std::lock_guard lock(m_mutex);
+        auto now = std::chrono::steady_clock::now();
+        for (auto& [action, limit] : m_limits) {
+            while (!limit.waiting.empty() && admit(limit, now)) {
+                ready.push_back(std::move(limit.waiting.front()));
+                limit.waiting.pop_front();
+            }
+            pending = pending || !limit.waiting.empty();
+        }
+        // Only tick while something is waiting
+        if (!pending) {
+            m_drainScheduled = false;
+            CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(
+                schedule_selector(RateLimiter::onDrain), this);
+        }
+    }
     
-    auto& limit = m_limits[action];
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - limit.windowStart);
+    // Outside the lock, tasks may acquire again
+    for (auto& task : ready) {
+        task();
+    }
+}
+
+void RateLimiter::release(const std::string& action) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_limits.find(action);
+    if (it != m_limits.end() && it->second.throttle) {
+        it->second.inFlight = std::max(0, it->second.inFlight - 1);
+    }
+}
+
+bool RateLimiter::reportResponse(const std::string& action, int status, std::chrono::steady_clock::duration latency, size_t bytes,
+                                 std::optional<std::chrono::steady_clock::duration> retryAfter) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_limits.find(action);
+    if (it == m_limits.end() || !it->second.throttle) {
+        return AdaptiveThrottle::isThrottleStatus(status);
+    }
     
-    // Check if window has expired
-    if (elapsed.count() >= windowSeconds) {
-        // Reset window
-        limit.count = 1;
-        limit.windowStart = now;
-        return true;
+    auto& limit = it->second;
+    limit.inFlight = std::max(0, limit.inFlight - 1);
+    double oldRate = limit.throttle->rate();
+    auto signal = limit.throttle->onResponse(status, latency, bytes, retryAfter);
+    double rate = limit.throttle->rate();
+    int concurrency = limit.throttle->concurrency();
+    limit.bucket.setPolicy(RatePolicy{rate, concurrency});
+    
+    MetricsRegistry::get()->gauge(fmt::format("throttle.{}.rate", action)).set(rate);
+    MetricsRegistry::get()->gauge(fmt::format("throttle.{}.concurrency", action)).set(concurrency);
+    if (rate < oldRate && signal == AdaptiveThrottle::Signal::Throttled) {
+        BetterSaveLogger::get()->warning("RateLimit", "Server answered {}, slowing {} requests to {:.1f}/s, {} at once",
+            status, action, rate, concurrency);
+    } else if (rate < oldRate) {
+        BetterSaveLogger::get()->warning("RateLimit", "Slow response ({} ms), slowing {} requests to {:.1f}/s, {} at once",
+            std::chrono::duration_cast<std::chrono::milliseconds>(latency).count(), action, rate, concurrency);
+    }
+    return signal == AdaptiveThrottle::Signal::Throttled;
+}
+
+void RateLimiter::send(const std::string& action, std::function<std::optional<web::WebTask>()> makeRequest,
+                       std::function<void(web::WebResponse*)> onResponse, size_t requestBytes) {
+    sendAttempt(action, std::move(makeRequest), std::move(onResponse), requestBytes, 1);
+}
+
+void RateLimiter::sendAttempt(const std::string& action, std::function<std::optional<web::WebTask>()> makeRequest,
+                              std::function<void(web::WebResponse*)> onResponse, size_t requestBytes, int attempt) {
+    acquire(action, [this, action, makeRequest, onResponse, requestBytes, attempt]() {
+        auto task = makeRequest();
+        if (!task) {
+            release(action);
+            return;
+        }
+        
+        auto sentAt = std::chrono::steady_clock::now();
+        task->listen([this, action, makeRequest, onResponse, requestBytes, attempt, sentAt](web::WebResponse* resp) {
+            std::optional<std::chrono::steady_clock::duration> retryAfter;
+            if (auto header = resp->header("Retry-After")) {
+                retryAfter = AdaptiveThrottle::parseRetryAfter(*header);
+            }
+            
+            bool throttled = reportResponse(action, resp->code(), std::chrono::steady_clock::now() - sentAt,
+                                            requestBytes + resp->data().size(), retryAfter);
+            if (throttled && attempt < MAX_SEND_ATTEMPTS) {
+                // Queued behind the throttle's pause, the drain tick sends it once that is over
+                MetricsRegistry::get()->counter("requests.throttled").add();
+                sendAttempt(action, makeRequest, onResponse, requestBytes, attempt + 1);
+                return;
+            }
+            onResponse(resp);
+        });
+    });
+}
+
+bool RateLimiter::checkLimit(const std::string& action, int maxRequests, int windowSeconds) {
+    std::lock_guard lock(m_mutex);
+    RatePolicy policy{static_cast<double>(maxRequests) / std::max(windowSeconds, 1), std::max(maxRequests, 1)};
+    auto [it, inserted] = m_limits.try_emplace(action, RateLimit{bettersave::core::TokenBucket(policy), {}});
+    if (!inserted) {
+        it->second.bucket.setPolicy(policy);
     }
     
-    // Within window, check count
-    if (limit.count >= maxRequests) {
-        BetterSaveLogger::get()->error("RateLimit", 
-            fmt::format("Rate limit exceeded for {}: {} requests in {} seconds", 
-                action, limit.count, elapsed.count()));
+    if (!it->second.bucket.tryAcquire()) {
+        BetterSaveLogger::get()->error("RateLimit", "Rate limit exceeded for {}: {} requests in {} seconds",
+            action, maxRequests, windowSeconds);
         return false;
     }
-    
-    // Increment and allow
-    limit.count++;
     return true;
 }
 
 void RateLimiter::reset(const std::string& action) {
-    m_limits.erase(action);
+    std::lock_guard lock(m_mutex);
+    auto it = m_limits.find(action);
+    if (it != m_limits.end()) {
+        auto& limit = it->second;
+        limit.bucket.reset();
+        if (limit.throttle) {
+            limit.throttle = AdaptiveThrottle(limit.throttle->config());
+            limit.bucket.setPolicy(RatePolicy{limit.throttle->rate(), limit.throttle->concurrency()});
+        }
+    }
 }
 
 void RateLimiter::clearAll() {
-    m_limits.clear();
+    std::lock_guard lock(m_mutex);
+    for (auto& [action, limit] : m_limits) {
+        limit.bucket.reset();
+        if (limit.throttle) {
+            limit.throttle = AdaptiveThrottle(limit.throttle->config());
+            limit.bucket.setPolicy(RatePolicy{limit.throttle->rate(), limit.throttle->concurrency()});
+        }
+    }
 }
-
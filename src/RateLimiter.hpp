@@ -1,26 +1,49 @@
 /**
  * BetterSave - Rate Limiter
- * Prevents DDOS and abuse
+ * Prevents DDOS and abuse, and paces database requests under the server's limits,
+ * backing off on its own when the server starts pushing back
  * Created by: sidastuff
  */
 
 #pragma once
 #include <Geode/Geode.hpp>
+#include "core/AdaptiveThrottle.hpp"
+#include "core/TokenBucket.hpp"
+#include <Geode/utils/web.hpp>
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 using namespace geode::prelude;
 
-class RateLimiter {
+class RateLimiter : public CCObject {
 private:
     static RateLimiter* s_instance;
     
     struct RateLimit {
-        int count = 0;
-        std::chrono::system_clock::time_point windowStart;
+        bettersave::core::TokenBucket bucket;
+        // acquire() callers waiting for the bucket, oldest first
+        std::deque<std::function<void()>> waiting;
+        // Adaptive actions also cap requests in flight and follow the throttle's rate
+        std::optional<bettersave::core::AdaptiveThrottle> throttle;
+        int inFlight = 0;
     };
     
+    std::mutex m_mutex;
     std::unordered_map<std::string, RateLimit> m_limits;
+    bool m_drainScheduled = false;
+    
+    RateLimiter();
+    // Called with m_mutex held, takes a token (and a slot for adaptive actions) if allowed
+    static bool admit(RateLimit& limit, std::chrono::steady_clock::time_point now);
+    void scheduleDrain();
+    void sendAttempt(const std::string& action, std::function<std::optional<web::WebTask>()> makeRequest,
+                     std::function<void(web::WebResponse*)> onResponse, size_t requestBytes, int attempt);
+    void onDrain(float dt);
     
 public:
     static RateLimiter* get() {
@@ -30,14 +53,49 @@ public:
         return s_instance;
     }
     
-    // Check if action is allowed
-    // Returns true if allowed, false if rate limited
+    // Named policies, set up with defaults in the constructor
+    // Every Realtime Database request (uploads, downloads, admin) shares this one, adaptively
+    static constexpr const char* DATABASE_REQUEST = "database";
+    static constexpr const char* LOGIN = "login";
+    // Attempts send() makes before handing a 429/503 to the caller
+    static constexpr int MAX_SEND_ATTEMPTS = 8;
+    
+    // Changing a policy keeps the action's history and queue
+    void setPolicy(const std::string& action, bettersave::core::RatePolicy policy);
+    std::optional<bettersave::core::RatePolicy> getPolicy(const std::string& action);
+    
+    // Let server responses steer the action: its bucket then follows the throttle's rate and
+    // concurrency, and every admitted request must be finished with reportResponse() or release()
+    void setAdaptive(const std::string& action, bettersave::core::ThrottleConfig config);
+    
+    // Actions without a policy are never limited
+    bool tryAcquire(const std::string& action);
+    std::chrono::steady_clock::duration timeUntilAllowed(const std::string& action);
+    
+    // Runs task on the main thread as soon as the action is allowed, in call order.
+    // Runs it right away (and inline) if nothing is queued and the bucket allows it.
+    void acquire(const std::string& action, std::function<void()> task);
+    
+    // Frees an adaptive action's slot without a response (the request was never sent)
+    void release(const std::string& action);
+    // Frees the slot and feeds the response to the throttle. True if the server pushed back.
+    // bytes is the request and response bodies together.
+    bool reportResponse(const std::string& action, int status, std::chrono::steady_clock::duration latency, size_t bytes,
+                        std::optional<std::chrono::steady_clock::duration> retryAfter);
+    
+    // acquire(), send, reportResponse(), and on a 429/503 or dropped connection send again once the
+    // throttle allows it. makeRequest runs once per attempt on the main thread and may return
+    // nullopt to drop the request (its batch already failed). onResponse gets the final response.
+    // requestBytes is the size of the body makeRequest sends, so a chunk isn't held to a page's pace.
+    void send(const std::string& action, std::function<std::optional<web::WebTask>()> makeRequest,
+              std::function<void(web::WebResponse*)> onResponse, size_t requestBytes = 0);
+    
+    // The old yes/no API: bursts of up to maxRequests, refilled at maxRequests per windowSeconds
     bool checkLimit(const std::string& action, int maxRequests, int windowSeconds);
     
-    // Reset a specific action's limit
+    // Reset a specific action's history and throttle (queued tasks still run)
     void reset(const std::string& action);
     
-    // Clear all limits
+    // Reset every action
     void clearAll();
 };
-
@@ -5,45 +5,53 @@
 
 #include "SaveIntegrityChecker.hpp"
 #include "BetterSaveLogger.hpp"
+#include "IntegrityCache.hpp"
+#include "core/Integrity.hpp"
+#include "core/SaveFiles.hpp"
+#include "core/ThreadPool.hpp"
+#include "core/Trace.hpp"
 #include <Geode/loader/Dirs.hpp>
 #include <fstream>
-#include <sstream>
-#include <iomanip>
+#include <atomic>
 
 std::string SaveIntegrityChecker::calculateChecksum(const std::vector<uint8_t>& data) {
-    // Simple CRC32-like checksum
-    uint32_t checksum = 0xFFFFFFFF;
-    
-    for (const auto& byte : data) {
-        checksum ^= byte;
-        for (int i = 0; i < 8; i++) {
-            if (checksum & 1) {
-                checksum = (checksum >> 1) ^ 0xEDB88320;
-            } else {
-                checksum >>= 1;
-            }
-        }
-    }
-    
-    checksum ^= 0xFFFFFFFF;
+    return calculateChecksum(data.data(), data.size());
+}
+
+std::string SaveIntegrityChecker::calculateChecksum(const uint8_t* data, size_t size) {
+    return bettersave::core::checksumHex(data, size);
+}
+
+// Validation shared by checkFile and checkData
+static IntegrityResult validateBytes(const uint8_t* data, size_t size) {
+    auto validation = bettersave::core::validateSaveBytes(data, size);
     
-    std::stringstream ss;
-    ss << std::hex << std::setw(8) << std::setfill('0') << checksum;
-    return ss.str();
+    IntegrityResult result;
+    result.isValid = validation.isValid;
+    result.message = validation.message;
+    result.fileSize = validation.size;
+    result.checksum = validation.checksum;
+    return result;
 }
 
 IntegrityResult SaveIntegrityChecker::checkFile(const std::filesystem::path& filePath) {
+    bettersave::core::TraceSpan span("check_file", "integrity");
+    span.arg("file", filePath.filename().string());
     IntegrityResult result;
-    result.isValid = false;
-    result.fileSize = 0;
-    result.checksum = "";
     
     try {
-        if (!std::filesystem::exists(filePath)) {
+        // Stat before reading, so a write that lands mid-read gets a new signature
+        auto signature = IntegrityCache::getSignature(filePath);
+        if (!signature) {
             result.message = "File does not exist";
             return result;
         }
         
+        if (auto cached = IntegrityCache::get()->lookup(filePath, *signature)) {
+            span.arg("cached", 1);
+            return *cached;
+        }
+        
         std::ifstream file(filePath, std::ios::binary);
         if (!file.is_open()) {
             result.message = "Failed to open file";
@@ -54,33 +62,8 @@ IntegrityResult SaveIntegrityChecker::checkFile(const std::filesystem::path& fil
         std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
         file.close();
         
-        result.fileSize = data.size();
-        
-        if (data.empty()) {
-            result.message = "File is empty";
-            return result;
-        }
-        
-        // Calculate checksum
-        result.checksum = calculateChecksum(data);
-        
-        // Basic integrity checks
-        if (result.fileSize < 100) {
-            result.message = "File size too small, likely corrupted";
-            return result;
-        }
-        
-        // Check for null bytes ratio (corrupted files often have excessive null bytes)
-        size_t nullCount = std::count(data.begin(), data.end(), 0);
-        double nullRatio = static_cast<double>(nullCount) / data.size();
-        
-        if (nullRatio > 0.9) {
-            result.message = "File contains too many null bytes, likely corrupted";
-            return result;
-        }
-        
-        result.isValid = true;
-        result.message = "File integrity check passed";
+        result = validateBytes(data.data(), data.size());
+        IntegrityCache::get()->store(filePath, *signature, result);
         
     } catch (const std::exception& e) {
         result.message = fmt::format("Error checking file: {}", e.what());
@@ -89,6 +72,24 @@ IntegrityResult SaveIntegrityChecker::checkFile(const std::filesystem::path& fil
     return result;
 }
 
+IntegrityResult SaveIntegrityChecker::checkData(const std::filesystem::path& filePath, const std::string& data) {
+    auto signature = IntegrityCache::getSignature(filePath);
+    if (signature) {
+        if (auto cached = IntegrityCache::get()->lookup(filePath, *signature)) {
+            return *cached;
+        }
+    }
+    
+    auto result = validateBytes(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    
+    // Only cache if the bytes we were given still match what's on disk
+    if (signature && signature->size == data.size()) {
+        IntegrityCache::get()->store(filePath, *signature, result);
+    }
+    
+    return result;
+}
+
 bool SaveIntegrityChecker::compareChecksums(const std::string& checksum1, const std::string& checksum2) {
     return checksum1 == checksum2;
 }
@@ -102,10 +103,11 @@ IntegrityResult SaveIntegrityChecker::checkGameManagerSave() {
     
     if (result.isValid) {
         BetterSaveLogger::get()->success("Integrity", 
-            fmt::format("CCGameManager.dat is valid (Size: {} bytes, Checksum: {})", result.fileSize, result.checksum));
+            "CCGameManager.dat is valid (Size: {} bytes, Checksum: {}{})", result.fileSize, result.checksum,
+                result.fromCache ? ", cached" : "");
     } else {
         BetterSaveLogger::get()->error("Integrity", 
-            fmt::format("CCGameManager.dat failed: {}", result.message));
+            "CCGameManager.dat failed: {}", result.message);
     }
     
     return result;
@@ -120,10 +122,11 @@ IntegrityResult SaveIntegrityChecker::checkLocalLevelsSave() {
     
     if (result.isValid) {
         BetterSaveLogger::get()->success("Integrity", 
-            fmt::format("CCLocalLevels.dat is valid (Size: {} bytes, Checksum: {})", result.fileSize, result.checksum));
+            "CCLocalLevels.dat is valid (Size: {} bytes, Checksum: {}{})", result.fileSize, result.checksum,
+                result.fromCache ? ", cached" : "");
     } else {
         BetterSaveLogger::get()->error("Integrity", 
-            fmt::format("CCLocalLevels.dat failed: {}", result.message));
+            "CCLocalLevels.dat failed: {}", result.message);
     }
     
     return result;
@@ -133,3 +136,69 @@ std::pair<IntegrityResult, IntegrityResult> SaveIntegrityChecker::checkAllSaves(
     return {checkGameManagerSave(), checkLocalLevelsSave()};
 }
 
+std::vector<std::string> SaveIntegrityChecker::getManagedSaveFiles() {
+    return bettersave::core::managedSaveFiles();
+}
+
+std::string SaveIntegrityChecker::recommendCopy(const SaveFileReport& primary, const SaveFileReport& backup) {
+    bool primaryUsable = primary.exists && primary.result.isValid;
+    bool backupUsable = backup.exists && backup.result.isValid;
+    
+    if (primaryUsable && backupUsable) {
+        // Both healthy: GD writes the primary last, so only prefer the backup if it is newer
+        return backup.modifiedTime > primary.modifiedTime ? backup.fileName : primary.fileName;
+    }
+    if (primaryUsable) return primary.fileName;
+    if (backupUsable) return backup.fileName;
+    return "";
+}
+
+void SaveIntegrityChecker::scanAllSavesAsync(std::function<void(const SaveFileReport&)> onFileChecked,
+                                             std::function<void(const IntegrityScanSummary&)> onComplete) {
+    auto saveDir = geode::dirs::getSaveDir();
+    auto fileNames = getManagedSaveFiles();
+    
+    auto reports = std::make_shared<std::vector<SaveFileReport>>(fileNames.size());
+    auto remaining = std::make_shared<std::atomic<int>>(static_cast<int>(fileNames.size()));
+    
+    BetterSaveLogger::get()->info("Integrity", "Scanning {} save files in parallel", fileNames.size());
+    // Load the cache here rather than on whichever worker gets to it first
+    IntegrityCache::get();
+    
+    for (size_t i = 0; i < fileNames.size(); i++) {
+        (*reports)[i].fileName = fileNames[i];
+        (*reports)[i].path = saveDir / fileNames[i];
+        
+        // Each file is hashed as its own pool task, results are handed back to the main thread
+        bettersave::core::ThreadPool::get()->submit([reports, remaining, i, onFileChecked, onComplete]() {
+            auto& report = (*reports)[i];
+            auto signature = IntegrityCache::getSignature(report.path);
+            report.exists = signature.has_value();
+            if (report.exists) {
+                report.modifiedTime = signature->mtime;
+                report.result = checkFile(report.path);
+            } else {
+                report.result.message = "File does not exist";
+            }
+            
+            Loader::get()->queueInMainThread([report, onFileChecked]() {
+                if (onFileChecked) onFileChecked(report);
+            });
+            
+            if (--(*remaining) == 0) {
+                Loader::get()->queueInMainThread([reports, onComplete]() {
+                    IntegrityScanSummary summary;
+                    summary.reports = *reports;
+                    summary.recommendedGameManager = recommendCopy((*reports)[0], (*reports)[1]);
+                    summary.recommendedLocalLevels = recommendCopy((*reports)[2], (*reports)[3]);
+                    
+                    BetterSaveLogger::get()->info("Integrity", "Scan finished, recommended copies: {}, {}",
+                        summary.recommendedGameManager.empty() ? "none" : summary.recommendedGameManager,
+                        summary.recommendedLocalLevels.empty() ? "none" : summary.recommendedLocalLevels);
+                    
+                    if (onComplete) onComplete(summary);
+                });
+            }
+        });
+    }
+}
@@ -6,23 +6,56 @@
 #pragma once
 #include <Geode/Geode.hpp>
 #include <string>
+#include <functional>
 
 using namespace geode::prelude;
 
 struct IntegrityResult {
-    bool isValid;
+    bool isValid = false;
     std::string message;
-    size_t fileSize;
+    size_t fileSize = 0;
     std::string checksum;
+    bool fromCache = false;
+};
+
+// One save artifact in a full scan (primary saves and GD's *2.dat backup copies)
+struct SaveFileReport {
+    std::string fileName;
+    std::filesystem::path path;
+    bool exists = false;
+    int64_t modifiedTime = 0;
+    IntegrityResult result;
+};
+
+struct IntegrityScanSummary {
+    std::vector<SaveFileReport> reports;
+    // File name of the healthiest copy of each save, empty if none is usable
+    std::string recommendedGameManager;
+    std::string recommendedLocalLevels;
 };
 
 class SaveIntegrityChecker {
 public:
+    // Uses the integrity cache, only re-reads the file if its stat signature changed
     static IntegrityResult checkFile(const std::filesystem::path& filePath);
+    // Validate bytes that were already read (e.g. by an upload) and cache the result
+    static IntegrityResult checkData(const std::filesystem::path& filePath, const std::string& data);
     static std::string calculateChecksum(const std::vector<uint8_t>& data);
+    static std::string calculateChecksum(const uint8_t* data, size_t size);
     static bool compareChecksums(const std::string& checksum1, const std::string& checksum2);
     static IntegrityResult checkGameManagerSave();
     static IntegrityResult checkLocalLevelsSave();
     static std::pair<IntegrityResult, IntegrityResult> checkAllSaves();
+    
+    // Every save file BetterSave manages, primary copy first
+    static std::vector<std::string> getManagedSaveFiles();
+    
+    // Check all managed save files in parallel. onFileChecked fires on the main thread
+    // as each file finishes, onComplete once all are done.
+    static void scanAllSavesAsync(std::function<void(const SaveFileReport&)> onFileChecked,
+                                  std::function<void(const IntegrityScanSummary&)> onComplete);
+    
+    // Pick the healthier of a primary save and its backup copy
+    static std::string recommendCopy(const SaveFileReport& primary, const SaveFileReport& backup);
 };
 
@@ -12,39 +12,37 @@
 // Delete old user data before uploading (fresh start)
 void SaveManagerPopup::deleteOldDataBeforeUpload(std::function<void()> callback) {
     std::string userId = FirebaseAuth::get()->getUserId();
-    std::string token = FirebaseAuth::get()->getIdToken();
     
     BetterSaveLogger::get()->info("Upload", "Deleting old data for fresh upload");
     
     // Delete saveData first
-    std::string saveDataUrl = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/users/{}/saveData.json?auth={}",
-        userId, token
-    );
+    std::string saveDataUrl = FirebaseAuth::get()->getDatabaseUrl(fmt::format("users/{}/saveData", userId));
     
-    // Delete by setting to null (Firebase REST API) 
-    web::WebRequest req1 = web::WebRequest();
-    req1.userAgent("");
-    matjson::Value nullValue;
-    req1.bodyJSON(nullValue);
-    
-    req1.patch(saveDataUrl).listen([callback, userId, token](web::WebResponse* resp) {
+    // Delete by setting to null (Firebase REST API), through the shared database throttle
+    RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [saveDataUrl]() -> std::optional<web::WebTask> {
+        web::WebRequest req1 = web::WebRequest();
+        req1.userAgent("");
+        matjson::Value nullValue;
+        req1.bodyJSON(nullValue);
+        return req1.patch(saveDataUrl);
+    }, [callback, userId](web::WebResponse* resp) {
         if (resp->ok()) {
             BetterSaveLogger::get()->info("Upload", "Deleted old saveData");
             
-            // Delete chunks
-            std::string chunksUrl = fmt::format(
-                "https://gdbettersave-default-rtdb.firebaseio.com/users/{}/chunks.json?auth={}",
-                userId, token
-            );
+            // Delete chunks, with the generations, index pages and key nodes they're kept in
+            std::string chunksUrl = FirebaseAuth::get()->getDatabaseUrl(fmt::format("users/{}", userId));
             
             // Delete by setting to null (Firebase REST API)
-            web::WebRequest req2 = web::WebRequest();
-            req2.userAgent("");
-            matjson::Value nullValue;
-            req2.bodyJSON(nullValue);
-            
-            req2.patch(chunksUrl).listen([callback](web::WebResponse* resp2) {
+            RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [chunksUrl]() -> std::optional<web::WebTask> {
+                web::WebRequest req2 = web::WebRequest();
+                req2.userAgent("");
+                matjson::Value saveParts;
+                for (const char* part : {"generations", "chunks", "pages", "keys"}) {
+                    saveParts[part] = matjson::Value();
+                }
+                req2.bodyJSON(saveParts);
+                return req2.patch(chunksUrl);
+            }, [callback](web::WebResponse* resp2) {
                 if (resp2->ok()) {
                     BetterSaveLogger::get()->info("Upload", "Deleted old chunks");
                 } else {
@@ -68,16 +66,13 @@ bool isBanned(const std::string& email, std::function<void(bool)> callback) {
     std::replace(emailKey.begin(), emailKey.end(), '@', '-');
     std::replace(emailKey.begin(), emailKey.end(), '.', '-');
     
-    std::string token = FirebaseAuth::get()->getIdToken();
-    std::string url = fmt::format(
-        "https://gdbettersave-default-rtdb.firebaseio.com/banned/{}.json?auth={}",
-        emailKey, token
-    );
-    
-    web::WebRequest req = web::WebRequest();
-    req.userAgent("");
+    std::string url = FirebaseAuth::get()->getDatabaseUrl(fmt::format("banned/{}", emailKey));
     
-    req.get(url).listen([callback](web::WebResponse* resp) {
+    RateLimiter::get()->send(RateLimiter::DATABASE_REQUEST, [url]() -> std::optional<web::WebTask> {
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        return req.get(url);
+    }, [callback](web::WebResponse* resp) {
         if (resp->ok()) {
             auto data = resp->string().unwrapOr("null");
             auto jsonResult = matjson::parse(data);
@@ -21,6 +21,7 @@ protected:
     void onCheckIntegrity(CCObject*);
     void onLogout(CCObject*);
     void onAccountManager(CCObject*);
+    void onDiagnostics(CCObject*);
     void onAdminPanel(CCObject*);
     void showStatus(const std::string& message, ccColor3B color);
     void showInfoDialog(const std::string& title, const std::string& message);
@@ -30,18 +31,15 @@ protected:
     void downloadToCustomLocation();
     void restartGame();
     void deleteOldDataBeforeUpload(std::function<void()> callback);
-    
-    static void downloadChunksParallel(const std::string& userId, const std::string& prefix,
-                                        int totalChunks, std::function<void(std::string)> onComplete,
-                                        ProgressPopup* progressPopup);
 
 public:
     static SaveManagerPopup* create();
     
     // Public methods for external access
-    void uploadSaveData(bool autoRestart = false);
-    static void uploadChunksParallel(const std::vector<std::string>& chunks, const std::string& userId,
-                                      const std::string& prefix, std::function<void()> onComplete,
-                                      ProgressPopup* progressPopup);
+    // onlyChanged skips files that still match the last committed manifest
+    void uploadSaveData(bool autoRestart = false, bool onlyChanged = false);
+    
+    // Upload with a progress popup, without needing an open SaveManagerPopup
+    static void startUpload(bool onlyChanged = false);
 };
 
@@ -11,6 +11,7 @@
 #include <sstream>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
 
 SettingsManager* SettingsManager::s_instance = nullptr;
 
@@ -28,6 +29,8 @@ void SettingsManager::saveToFile() {
         json["confirmBeforeDownload"] = m_settings.confirmBeforeDownload;
         json["confirmBeforeUpload"] = m_settings.confirmBeforeUpload;
         json["autoCheckIntegrity"] = m_settings.autoCheckIntegrity;
+        json["backgroundFrameBudgetMs"] = m_settings.backgroundFrameBudgetMs;
+        json["databaseUrl"] = m_settings.databaseUrl;
         
         std::ofstream file(m_settingsFilePath, std::ios::out | std::ios::trunc);
         if (file.is_open()) {
@@ -36,7 +39,7 @@ void SettingsManager::saveToFile() {
             BetterSaveLogger::get()->info("Settings", "Settings saved successfully");
         }
     } catch (const std::exception& e) {
-        BetterSaveLogger::get()->error("Settings", fmt::format("Failed to save settings: {}", e.what()));
+        BetterSaveLogger::get()->error("Settings", "Failed to save settings: {}", e.what());
     }
 }
 
@@ -78,11 +81,20 @@ void SettingsManager::loadFromFile() {
         if (json.contains("autoCheckIntegrity") && json["autoCheckIntegrity"].isBool()) {
             m_settings.autoCheckIntegrity = json["autoCheckIntegrity"].as<bool>().unwrapOr(true);
         }
+        if (json.contains("backgroundFrameBudgetMs") && json["backgroundFrameBudgetMs"].isNumber()) {
+            m_settings.backgroundFrameBudgetMs = std::clamp(json["backgroundFrameBudgetMs"].as<int>().unwrapOr(4), 1, 16);
+        }
+        if (json.contains("databaseUrl") && json["databaseUrl"].isString()) {
+            m_settings.databaseUrl = json["databaseUrl"].asString().unwrapOr("");
+            while (!m_settings.databaseUrl.empty() && m_settings.databaseUrl.back() == '/') {
+                m_settings.databaseUrl.pop_back();
+            }
+        }
         
         BetterSaveLogger::get()->info("Settings", "Settings loaded successfully");
         
     } catch (const std::exception& e) {
-        BetterSaveLogger::get()->error("Settings", fmt::format("Failed to load settings: {}", e.what()));
+        BetterSaveLogger::get()->error("Settings", "Failed to load settings: {}", e.what());
     }
 }
 
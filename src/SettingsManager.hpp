@@ -16,6 +16,8 @@ struct BetterSaveSettings {
     bool confirmBeforeDownload = true;
     bool confirmBeforeUpload = false;
     bool autoCheckIntegrity = true;
+    int backgroundFrameBudgetMs = 4;  // Max main-thread time per frame for deferred work
+    std::string databaseUrl;  // Realtime Database override (e.g. http://127.0.0.1:9000), empty = Firebase
 };
 
 class SettingsManager {
@@ -6,6 +6,7 @@
 #include "SettingsPopup.hpp"
 #include "SettingsManager.hpp"
 #include "BetterSaveLogger.hpp"
+#include "AutoBackupScheduler.hpp"
 
 SettingsPopup* SettingsPopup::create() {
     auto ret = new SettingsPopup();
@@ -169,6 +170,9 @@ void SettingsPopup::onSave(CCObject*) {
     
     SettingsManager::get()->updateSettings(settings);
     
+    // Re-arm the backup timer so a new interval or toggle takes effect right away
+    AutoBackupScheduler::get()->markDirty();
+    
     BetterSaveLogger::get()->success("Settings", "Settings saved successfully!");
     FLAlertLayer::create("Settings Saved", "Your BetterSave settings have been saved!", "OK")->show();
     
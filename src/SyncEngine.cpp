@@ -0,0 +1,1540 @@
+/**
+ * BetterSave - Sync Engine
+ * Created by: sidastuff
+ */
+
+#include "SyncEngine.hpp"
+#include "BetterSaveLogger.hpp"
+#include "SettingsManager.hpp"
+#include "FirebaseAuth.hpp"
+#include "ManifestStore.hpp"
+#include "IntegrityCache.hpp"
+#include "GameplayGuard.hpp"
+#include "RateLimiter.hpp"
+#include "Awaitables.hpp"
+#include <Geode/utils/web.hpp>
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Loader.hpp>
+#include "core/Delta.hpp"
+#include "core/Transfer.hpp"
+#include "core/SaveFiles.hpp"
+#include "core/Integrity.hpp"
+#include "core/KeySync.hpp"
+#include "core/Metrics.hpp"
+#include "core/UploadJournal.hpp"
+#include "core/ThreadPool.hpp"
+#include <fstream>
+#include <ctime>
+#include <thread>
+#include <chrono>
+#include <unordered_set>
+
+using bettersave::core::MetricsRegistry;
+using bettersave::core::TraceSpan;
+
+SyncEngine* SyncEngine::s_instance = nullptr;
+
+// How many local snapshots to keep before the oldest is pruned
+static constexpr size_t MAX_SNAPSHOTS = 5;
+
+// Chunk tasks started at once. The rate limiter decides how many requests are actually in
+// flight, this only bounds the coroutine frames a huge save creates up front.
+static constexpr size_t MAX_CHUNK_TASKS = 64;
+
+// Thrown inside the operation coroutines, the message is shown to the user as-is
+class SyncFailure : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+int SyncEngine::addListener(std::function<void(const SyncEvent&)> listener) {
+    int listenerId = m_nextListenerId++;
+    m_listeners[listenerId] = std::move(listener);
+    return listenerId;
+}
+
+void SyncEngine::removeListener(int listenerId) {
+    m_listeners.erase(listenerId);
+}
+
+void SyncEngine::emit(SyncOperation operation, SyncEventType type, const std::string& message, int current, int total) {
+    SyncEvent event;
+    event.operation = operation;
+    event.type = type;
+    event.message = message;
+    event.current = current;
+    event.total = total;
+
+    traceOperation(operation, type);
+
+    // Listeners may unsubscribe while handling an event
+    auto listeners = m_listeners;
+    for (auto& [listenerId, listener] : listeners) {
+        listener(event);
+    }
+}
+
+static const char* getOperationName(SyncOperation operation) {
+    switch (operation) {
+        case SyncOperation::Upload: return "upload";
+        case SyncOperation::Download: return "download";
+        case SyncOperation::Verify: return "verify";
+        case SyncOperation::Snapshot: return "snapshot";
+        default: return "unknown";
+    }
+}
+
+// Bytes moved by chunk requests, per direction
+static bettersave::core::Counter* getByteCounter(SyncOperation operation) {
+    switch (operation) {
+        case SyncOperation::Upload: return &MetricsRegistry::get()->counter("upload.bytes");
+        case SyncOperation::Download: return &MetricsRegistry::get()->counter("download.bytes");
+        default: return nullptr;
+    }
+}
+
+void SyncEngine::traceOperation(SyncOperation operation, SyncEventType type) {
+    if (type == SyncEventType::Started) {
+        auto& trace = m_operationTraces[operation];
+        trace.span = std::make_unique<TraceSpan>(getOperationName(operation), "sync", TraceSpan::Kind::Async);
+        trace.start = std::chrono::steady_clock::now();
+        auto* bytes = getByteCounter(operation);
+        trace.startBytes = bytes ? bytes->value() : 0;
+        return;
+    }
+    if (type != SyncEventType::Completed && type != SyncEventType::Failed) {
+        return;
+    }
+
+    auto it = m_operationTraces.find(operation);
+    if (it == m_operationTraces.end()) {
+        return;
+    }
+
+    bool completed = type == SyncEventType::Completed;
+    std::string name = getOperationName(operation);
+    auto* metrics = MetricsRegistry::get();
+    metrics->counter(name + (completed ? ".completed" : ".failed")).add();
+
+    auto* bytes = getByteCounter(operation);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - it->second.start).count();
+    if (completed && bytes && seconds > 0) {
+        auto transferred = bytes->value() - it->second.startBytes;
+        if (transferred > 0) {
+            metrics->gauge(name + ".mb_per_s").set(transferred / (1024.0 * 1024.0) / seconds);
+            metrics->histogram(name + ".throughput_kb_per_s").record(static_cast<uint64_t>(transferred / 1024.0 / seconds));
+        }
+    }
+
+    it->second.span->arg("result", completed ? "completed" : "failed");
+    m_operationTraces.erase(it);
+    exportDiagnostics();
+}
+
+std::filesystem::path SyncEngine::getJournalPath() {
+    return geode::dirs::getSaveDir() / "bettersave_upload_journal.json";
+}
+
+std::filesystem::path SyncEngine::getSignaturePath(const std::string& prefix) {
+    return geode::dirs::getSaveDir() / fmt::format("bettersave_signature_{}.json", prefix);
+}
+
+// nullopt if the file is missing or unreadable, that file is then just uploaded whole
+static std::optional<bettersave::core::BlockSignature> loadSignature(const std::string& prefix) {
+    auto text = bettersave::core::readFile(SyncEngine::getSignaturePath(prefix));
+    return text ? bettersave::core::parseSignature(*text) : std::nullopt;
+}
+
+// The game's own save file encoding (gzip, base64, XOR 11), CCGameManager.dat is stored key by key
+// in its decoded form. A file it can't decode (an encrypted macOS save) goes up in chunks instead.
+static bettersave::core::SaveFileCodec gameSaveCodec() {
+    bettersave::core::SaveFileCodec codec;
+    codec.decode = [](const std::string& file) -> std::optional<std::string> {
+        std::string plist = ZipUtils::decompressString(gd::string(file), true, 11);
+        if (plist.empty()) return std::nullopt;
+        return plist;
+    };
+    codec.encode = [](const std::string& plist) -> std::string {
+        return ZipUtils::compressString(gd::string(plist), true, 11);
+    };
+    return codec;
+}
+
+// A file to upload, planned against what was last committed for it
+static bettersave::core::SavePayload toPayload(const CommittedFile& committed, bool unchanged, std::string data, const std::string& checksum) {
+    bettersave::core::SavePayload payload;
+    payload.unchanged = unchanged;
+    payload.data = std::move(data);
+    payload.checksum = checksum;
+    payload.committedChunks = committed.chunks;
+    payload.committedChunkSize = committed.chunkSize;
+    payload.committedPages = committed.pages;
+    payload.committedGeneration = committed.generation;
+    payload.baseChecksum = committed.baseChecksum;
+    payload.committedPatchChunks = committed.patchChunks;
+    payload.committedPatchPages = committed.patchPages;
+    payload.committedPatchGeneration = committed.patchGeneration;
+    payload.plistChecksum = committed.plistChecksum;
+    payload.keyNodes = committed.keyNodes;
+    payload.keyPages = committed.keyPages;
+    return payload;
+}
+
+// What a manifest says about one file ("gm" or "ll"), for the manifest store
+static CommittedFile toCommitted(const bettersave::core::SaveManifest& manifest, const std::string& prefix, const std::string& checksum,
+                                 FileSignature signature) {
+    bool isGameManager = prefix == "gm";
+    CommittedFile file;
+    file.checksum = checksum;
+    file.signature = signature;
+    file.chunks = isGameManager ? manifest.gmChunks : manifest.llChunks;
+    file.chunkSize = isGameManager ? manifest.gmChunkSize : manifest.llChunkSize;
+    file.pages = isGameManager ? manifest.gmPages : manifest.llPages;
+    file.generation = isGameManager ? manifest.gmGeneration : manifest.llGeneration;
+    file.baseChecksum = isGameManager ? manifest.gmBaseChecksum : manifest.llBaseChecksum;
+    file.patchChunks = isGameManager ? manifest.gmPatchChunks : manifest.llPatchChunks;
+    file.patchPages = isGameManager ? manifest.gmPatchPages : manifest.llPatchPages;
+    file.patchGeneration = isGameManager ? manifest.gmPatchGeneration : manifest.llPatchGeneration;
+    if (isGameManager) {
+        file.plistChecksum = manifest.gmPlistChecksum;
+        file.keyNodes = manifest.gmKeyNodes;
+        file.keyPages = manifest.gmKeyPages;
+    }
+    return file;
+}
+
+// Stage boundaries of the run* coroutines: while the token is paused (by the user, or while a level
+// is played) nothing new is read, planned or decoded either. Throws OperationCancelled once cancelled.
+static bettersave::core::Task<void> holdWhilePaused(bettersave::core::CancellationTokenPtr token) {
+    auto resumed = waitUntilResumed(token);
+    co_await std::move(resumed);
+    token->throwIfCancelled();
+}
+
+// Whether the cloud manifest still points at a file's committed chunks, pages and nodes, so an
+// unchanged file can be skipped and keep pointing at them
+static bool cloudStillHas(const bettersave::core::SaveManifest& cloud, const std::string& prefix, const CommittedFile& committed) {
+    auto stored = toCommitted(cloud, prefix, prefix == "gm" ? cloud.gmChecksum : cloud.llChecksum, FileSignature());
+    // A GM save stored key by key is rebuilt with the game's encoding on restore, only its plist matches
+    bool sameFile = committed.keyNodes > 0 ? stored.plistChecksum == committed.plistChecksum : stored.checksum == committed.checksum;
+    return sameFile && stored.generation == committed.generation && stored.chunks == committed.chunks &&
+        stored.pages == committed.pages && stored.baseChecksum == committed.baseChecksum &&
+        stored.patchGeneration == committed.patchGeneration && stored.patchChunks == committed.patchChunks &&
+        stored.keyNodes == committed.keyNodes;
+}
+
+std::filesystem::path SyncEngine::getTracePath() {
+    return geode::dirs::getSaveDir() / "bettersave_trace.json";
+}
+
+std::filesystem::path SyncEngine::getMetricsPath() {
+    return geode::dirs::getSaveDir() / "bettersave_metrics.json";
+}
+
+void SyncEngine::exportDiagnostics() {
+    // Serializing the whole trace buffer takes a few milliseconds, keep it off the main thread
+    bettersave::core::ThreadPool::get()->submit([tracePath = getTracePath(), metricsPath = getMetricsPath()]() {
+        if (!bettersave::core::Tracer::get()->exportChromeTrace(tracePath)) {
+            geode::log::warn("Failed to write the BetterSave trace to {}", tracePath.string());
+        }
+        if (!MetricsRegistry::get()->exportJson(metricsPath)) {
+            geode::log::warn("Failed to write the BetterSave metrics to {}", metricsPath.string());
+        }
+    });
+}
+
+static std::optional<std::pair<FileSignature, FileSignature>> getSaveSignatures() {
+    auto savePath = geode::dirs::getSaveDir();
+    auto gmSignature = IntegrityCache::getSignature(savePath / "CCGameManager.dat");
+    auto llSignature = IntegrityCache::getSignature(savePath / "CCLocalLevels.dat");
+    if (!gmSignature || !llSignature) {
+        return std::nullopt;
+    }
+    return std::make_pair(*gmSignature, *llSignature);
+}
+
+bool SyncEngine::tryJoin(PendingOperation& target, const PendingOperation& request, bool running) {
+    if (target.operation != request.operation) {
+        return false;
+    }
+
+    switch (request.operation) {
+        case SyncOperation::Upload:
+            if (!running) {
+                // Hasn't read the save yet, so it will upload whatever is newest. Full wins over onlyChanged.
+                target.onlyChanged = target.onlyChanged && request.onlyChanged;
+                break;
+            }
+            // Only if the save hasn't changed since the running upload read it
+            if (!target.readSignatures || target.readSignatures != getSaveSignatures() ||
+                (target.onlyChanged && !request.onlyChanged)) {
+                return false;
+            }
+            break;
+        case SyncOperation::Download:
+            // Nothing can upload in between, so a second restore would download the same cloud save
+            if (target.targetDir != request.targetDir) {
+                return false;
+            }
+            break;
+        case SyncOperation::Snapshot:
+            // A running snapshot may already have copied older files
+            if (running) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    target.callbacks.insert(target.callbacks.end(), request.callbacks.begin(), request.callbacks.end());
+    return true;
+}
+
+void SyncEngine::schedule(PendingOperation request) {
+    auto name = getOperationName(request.operation);
+    if (m_current && tryJoin(*m_current, request, true)) {
+        BetterSaveLogger::get()->info("Sync", "Joined the running {}", name);
+        MetricsRegistry::get()->counter("operations.coalesced").add();
+        return;
+    }
+    for (auto& queued : m_queue) {
+        if (tryJoin(queued, request, false)) {
+            BetterSaveLogger::get()->info("Sync", "Merged {} into the one already queued", name);
+            MetricsRegistry::get()->counter("operations.coalesced").add();
+            return;
+        }
+    }
+
+    auto operation = request.operation;
+    m_queue.push_back(std::move(request));
+    if (m_current) {
+        BetterSaveLogger::get()->info("Sync", "Queued {} behind the running {}", name, getOperationName(m_current->operation));
+        emit(operation, SyncEventType::Status, fmt::format("Waiting for the running {} to finish...", getOperationName(m_current->operation)));
+        return;
+    }
+    startNext();
+}
+
+void SyncEngine::startNext() {
+    if (m_current || m_queue.empty()) {
+        return;
+    }
+    m_current = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    auto operation = m_current->operation;
+    auto onComplete = [this](bool success, const std::string& message) {
+        finishCurrent(success, message);
+    };
+    // A level may start while it runs (an auto-backup started on a pause menu, or queued behind one)
+    m_gameplayListenerId = GameplayGuard::get()->addGameplayListener([this](bool active) {
+        onGameplayChanged(active);
+    });
+    if (GameplayGuard::isGameplayActive()) {
+        onGameplayChanged(true);
+    }
+    // The operations report their own failures, this only catches what they didn't expect
+    auto onDone = [this, operation, onComplete](std::exception_ptr error) {
+        if (!error) return;
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            BetterSaveLogger::get()->error("Sync", "{} failed: {}", getOperationName(operation), e.what());
+            fail(operation, fmt::format("Error: {}", e.what()), onComplete);
+        } catch (...) {
+            fail(operation, "Unknown error", onComplete);
+        }
+    };
+    switch (operation) {
+        case SyncOperation::Upload:
+            bettersave::core::spawn(runUpload(m_current->onlyChanged, m_current->token, onComplete), onDone);
+            break;
+        case SyncOperation::Download:
+            if (m_current->targetDir.empty()) {
+                bettersave::core::spawn(runRestore(m_current->token, onComplete), onDone);
+            } else {
+                bettersave::core::spawn(runDownloadTo(m_current->targetDir, m_current->token, onComplete), onDone);
+            }
+            break;
+        case SyncOperation::Snapshot:
+            runSnapshot(onComplete);
+            break;
+        default:
+            finishCurrent(false, "Unknown operation");
+            break;
+    }
+}
+
+void SyncEngine::finishCurrent(bool success, const std::string& message) {
+    if (!m_current) {
+        return;
+    }
+    // Cleared before the callbacks, they may request the next operation themselves
+    auto callbacks = std::move(m_current->callbacks);
+    m_current.reset();
+    if (m_gameplayListenerId != 0) {
+        GameplayGuard::get()->removeGameplayListener(m_gameplayListenerId);
+        m_gameplayListenerId = 0;
+    }
+    for (auto& callback : callbacks) {
+        if (callback) callback(success, message);
+    }
+    startNext();
+}
+
+void SyncEngine::onGameplayChanged(bool active) {
+    if (!m_current || m_current->token->isCancelled()) {
+        return;
+    }
+    auto name = getOperationName(m_current->operation);
+    if (active && !m_current->token->isPaused()) {
+        m_current->pausedForGameplay = true;
+        m_current->token->pause();
+        BetterSaveLogger::get()->info("Sync", "Level started, holding the {} until it stops", name);
+    } else if (!active && m_current->pausedForGameplay) {
+        // A pause the user asked for stays
+        m_current->pausedForGameplay = false;
+        BetterSaveLogger::get()->info("Sync", "Gameplay stopped, continuing the {}", name);
+        m_current->token->resume();
+    }
+}
+
+bool SyncEngine::pause(SyncOperation operation) {
+    if (!m_current || m_current->operation != operation || m_current->token->isCancelled()) {
+        return false;
+    }
+    m_current->pausedForGameplay = false;
+    m_current->token->pause();
+    BetterSaveLogger::get()->info("Sync", "Paused {}", getOperationName(operation));
+    emit(operation, SyncEventType::Status, "Paused\nRequests already sent will finish");
+    return true;
+}
+
+bool SyncEngine::resume(SyncOperation operation) {
+    if (!m_current || m_current->operation != operation || !m_current->token->isPaused()) {
+        return false;
+    }
+    BetterSaveLogger::get()->info("Sync", "Resumed {}", getOperationName(operation));
+    emit(operation, SyncEventType::Status, "Resuming...");
+    m_current->pausedForGameplay = false;
+    m_current->token->resume();
+    return true;
+}
+
+bool SyncEngine::isPaused(SyncOperation operation) const {
+    return m_current && m_current->operation == operation && m_current->token->isPaused();
+}
+
+bool SyncEngine::cancel(SyncOperation operation) {
+    if (m_current && m_current->operation == operation) {
+        BetterSaveLogger::get()->info("Sync", "Cancelling {}", getOperationName(operation));
+        emit(operation, SyncEventType::Status, "Cancelling...");
+        // The operation notices at its next check and finishes through its usual failure path
+        m_current->token->cancel();
+        return true;
+    }
+
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if (it->operation != operation) continue;
+        auto callbacks = std::move(it->callbacks);
+        m_queue.erase(it);
+        BetterSaveLogger::get()->info("Sync", "Dropped the queued {}", getOperationName(operation));
+        emit(operation, SyncEventType::Failed, "Cancelled");
+        for (auto& callback : callbacks) {
+            if (callback) callback(false, "Cancelled");
+        }
+        return true;
+    }
+    return false;
+}
+
+void SyncEngine::upload(bool onlyChanged, std::function<void(bool, const std::string&)> onComplete) {
+    PendingOperation request;
+    request.operation = SyncOperation::Upload;
+    request.onlyChanged = onlyChanged;
+    request.callbacks.push_back(std::move(onComplete));
+    schedule(std::move(request));
+}
+
+void SyncEngine::restore(std::function<void(bool, const std::string&)> onComplete) {
+    PendingOperation request;
+    request.operation = SyncOperation::Download;
+    request.callbacks.push_back(std::move(onComplete));
+    schedule(std::move(request));
+}
+
+void SyncEngine::downloadTo(const std::filesystem::path& targetDir, std::function<void(bool, const std::string&)> onComplete) {
+    PendingOperation request;
+    request.operation = SyncOperation::Download;
+    request.targetDir = targetDir;
+    request.callbacks.push_back(std::move(onComplete));
+    schedule(std::move(request));
+}
+
+void SyncEngine::snapshot(std::function<void(bool, const std::string&)> onComplete) {
+    PendingOperation request;
+    request.operation = SyncOperation::Snapshot;
+    request.callbacks.push_back(std::move(onComplete));
+    schedule(std::move(request));
+}
+
+void SyncEngine::fail(SyncOperation operation, const std::string& message, std::function<void(bool, const std::string&)> onComplete) {
+    BetterSaveLogger::get()->forceSave();
+    emit(operation, SyncEventType::Failed, message);
+    if (onComplete) onComplete(false, message);
+}
+
+struct SyncEngine::UploadContext {
+    bettersave::core::UploadPlan plan;
+    TokenPtr token;
+    bettersave::core::UploadJournal journal;
+    int completed = 0;
+    int total = 0;
+};
+
+// What the planning step of an upload hands back to the main thread
+struct PlannedUpload {
+    bettersave::core::UploadPlan plan;
+    bool gmPatched = false;
+    bool llPatched = false;
+    // CCGameManager.dat went up key by key, and the paths and ids of the nodes sent
+    bool gmByKey = false;
+    std::vector<std::string> sentPaths;
+    std::vector<std::string> sentIds;
+    // Nodes the cloud has and the committed save won't list, removed after the commit
+    std::vector<std::string> staleIds;
+    // Serialized signatures of the files uploaded whole, saved once the upload is committed
+    std::optional<std::string> gmSignature;
+    std::optional<std::string> llSignature;
+};
+
+struct SyncEngine::DownloadContext {
+    std::string userId;
+    TokenPtr token;
+    int completed = 0;
+    int total = 0;
+};
+
+bettersave::core::Task<void> SyncEngine::runUpload(bool onlyChanged, TokenPtr token, std::function<void(bool, const std::string&)> onComplete) {
+    auto op = SyncOperation::Upload;
+    emit(op, SyncEventType::Started, "Reading save files...");
+
+    BetterSaveLogger::get()->info("Upload", "Starting upload process");
+    BetterSaveLogger::get()->forceSave();
+
+    // Use Geode's save directory (same location as download)
+    auto savePath = geode::dirs::getSaveDir();
+    auto gmPath = savePath / "CCGameManager.dat";
+    auto llPath = savePath / "CCLocalLevels.dat";
+
+    if (!std::filesystem::exists(gmPath) || !std::filesystem::exists(llPath)) {
+        BetterSaveLogger::get()->error("Upload", "Save files not found");
+        fail(op, "Save files not found!", onComplete);
+        co_return;
+    }
+
+    // Set once the chunks are planned, a stopped upload saves its journal for next time
+    std::shared_ptr<UploadContext> context;
+    try {
+        auto holding = holdWhilePaused(token);
+        co_await std::move(holding);
+
+        // With onlyChanged, files matching the last committed manifest are neither read nor re-uploaded
+        auto committed = ManifestStore::get()->getLastCommitted();
+        bool skipGM = onlyChanged && committed.valid && ManifestStore::get()->matches(gmPath, committed.gameManager);
+        bool skipLL = onlyChanged && committed.valid && ManifestStore::get()->matches(llPath, committed.localLevels);
+
+        // A skipped file keeps pointing at its committed chunks, which only works while the cloud
+        // still does too: another device's upload since then replaced them and may have removed
+        // them. A changed CCGameManager.dat also needs the manifest for the nodes the cloud already
+        // has, and once this upload is committed it says which generations nothing points at anymore.
+        std::optional<bettersave::core::SaveManifest> cloudManifest;
+        try {
+            auto fetching = fetchCloudManifest();
+            cloudManifest = co_await std::move(fetching);
+        } catch (const SyncFailure&) {
+            BetterSaveLogger::get()->warning("Upload", "Could not read the cloud manifest, uploading every file in full");
+        }
+        token->throwIfCancelled();
+        if (skipGM && !(cloudManifest && cloudStillHas(*cloudManifest, "gm", committed.gameManager))) {
+            BetterSaveLogger::get()->warning("Upload", "The cloud no longer holds the committed GM save, uploading it again");
+            skipGM = false;
+        }
+        if (skipLL && !(cloudManifest && cloudStillHas(*cloudManifest, "ll", committed.localLevels))) {
+            BetterSaveLogger::get()->warning("Upload", "The cloud no longer holds the committed LL save, uploading it again");
+            skipLL = false;
+        }
+
+        // Stat before reading so the committed signature never describes newer bytes than we sent
+        auto gmSignature = IntegrityCache::getSignature(gmPath).value_or(FileSignature());
+        auto llSignature = IntegrityCache::getSignature(llPath).value_or(FileSignature());
+        // Later upload requests for these exact files join this one instead of re-uploading them
+        if (m_current && m_current->operation == op) {
+            m_current->readSignatures = std::make_pair(gmSignature, llSignature);
+        }
+
+        // Read files
+        TraceSpan readSpan("read_save", "disk");
+        std::string gmData;
+        std::string llData;
+        if (!skipGM) {
+            std::ifstream gmFile(gmPath, std::ios::binary);
+            gmData.assign((std::istreambuf_iterator<char>(gmFile)), std::istreambuf_iterator<char>());
+        }
+        if (!skipLL) {
+            std::ifstream llFile(llPath, std::ios::binary);
+            llData.assign((std::istreambuf_iterator<char>(llFile)), std::istreambuf_iterator<char>());
+        }
+        readSpan.arg("gm_bytes", static_cast<int64_t>(gmData.size())).arg("ll_bytes", static_cast<int64_t>(llData.size()));
+        readSpan.end();
+
+        BetterSaveLogger::get()->info("Upload", "Read GM: {} bytes{}, LL: {} bytes{}",
+            gmData.size(), skipGM ? " (unchanged)" : "", llData.size(), skipLL ? " (unchanged)" : "");
+
+        // Validate the bytes we just read (free if the integrity cache already knows these files)
+        IntegrityResult gmIntegrity;
+        IntegrityResult llIntegrity;
+        if (skipGM) {
+            gmIntegrity.isValid = true;
+            gmIntegrity.checksum = committed.gameManager.checksum;
+        } else {
+            gmIntegrity = SaveIntegrityChecker::checkData(gmPath, gmData);
+        }
+        if (skipLL) {
+            llIntegrity.isValid = true;
+            llIntegrity.checksum = committed.localLevels.checksum;
+        } else {
+            llIntegrity = SaveIntegrityChecker::checkData(llPath, llData);
+        }
+
+        if (SettingsManager::get()->getSettings().autoCheckIntegrity && (!gmIntegrity.isValid || !llIntegrity.isValid)) {
+            auto reason = !gmIntegrity.isValid ? gmIntegrity.message : llIntegrity.message;
+            BetterSaveLogger::get()->error("Upload", "Refusing to upload corrupted save: {}", reason);
+            fail(op, fmt::format("Your local save failed the integrity check:\n{}", reason), onComplete);
+            co_return;
+        }
+
+        // Hex encode, split into larger chunks for faster upload, and frame each chunk
+        emit(op, SyncEventType::Status, "Encoding data...");
+        std::string userId = FirebaseAuth::get()->getUserId();
+        int64_t timestamp = (int64_t)std::time(nullptr);
+
+        // Chunks are sized to the connection, except when resuming a stopped upload of this same
+        // save: its journal only lines up with the chunk size it was planned with
+        size_t chunkSize = m_chunkSizer.chooseChunkSize(2 * std::max(gmData.size(), llData.size()));
+        std::optional<bettersave::core::UploadJournal> previousJournal;
+        if (auto text = bettersave::core::readFile(getJournalPath())) {
+            previousJournal = bettersave::core::parseJournal(*text);
+        }
+        if (previousJournal && previousJournal->covers(userId, gmIntegrity.checksum, llIntegrity.checksum)) {
+            chunkSize = previousJournal->chunkSize;
+        }
+        auto* metrics = MetricsRegistry::get();
+        metrics->gauge("chunking.chunk_size").set(static_cast<double>(chunkSize));
+        metrics->gauge("chunking.rtt_ms").set(m_chunkSizer.roundTripMs());
+        metrics->gauge("chunking.kb_per_s").set(m_chunkSizer.bytesPerSecond() / 1024.0);
+        metrics->gauge("chunking.resend_rate").set(m_chunkSizer.resendRate());
+
+        // A changed file goes up as a patch against its last whole upload, as long as that's
+        // still what the cloud has (another device may have uploaded since)
+        auto holdingBases = holdWhilePaused(token);
+        co_await std::move(holdingBases);
+        auto loadingBases = runInBackground([skipGM, skipLL]() {
+            return std::make_pair(skipGM ? std::nullopt : loadSignature("gm"), skipLL ? std::nullopt : loadSignature("ll"));
+        });
+        auto bases = co_await std::move(loadingBases);
+        token->throwIfCancelled();
+
+        // A stopped upload of this same save already wrote part of its generation, the journal
+        // says which chunks. Any other upload gets a generation of its own.
+        const auto* cloudManifestPtr = cloudManifest ? &*cloudManifest : nullptr;
+        std::string generation = bettersave::core::newGeneration(cloudManifestPtr);
+        if (previousJournal && previousJournal->covers(userId, gmIntegrity.checksum, llIntegrity.checksum) &&
+            !previousJournal->generation.empty() && !(cloudManifest && bettersave::core::usesGeneration(*cloudManifest, previousJournal->generation))) {
+            generation = previousJournal->generation;
+        }
+        std::vector<std::string> storedIds;
+        if (!skipGM && cloudManifest && cloudManifest->gmKeyNodes > 0) {
+            auto indexContext = std::make_shared<DownloadContext>();
+            indexContext->userId = userId;
+            indexContext->token = token;
+            try {
+                auto fetchingIndex = fetchKeyIndex(indexContext, cloudManifest->gmGeneration, cloudManifest->gmKeyNodes,
+                                                   cloudManifest->gmKeyPages);
+                storedIds = co_await std::move(fetchingIndex);
+            } catch (const SyncFailure&) {
+                BetterSaveLogger::get()->warning("Upload", "Could not read the cloud's GM key index, sending every key");
+            }
+            token->throwIfCancelled();
+        }
+
+        // Encoding copies the whole save a few times over, so it runs off the main thread
+        auto holdingPlan = holdWhilePaused(token);
+        co_await std::move(holdingPlan);
+        auto gmPayload = toPayload(committed.gameManager, skipGM, std::move(gmData), gmIntegrity.checksum);
+        auto llPayload = toPayload(committed.localLevels, skipLL, std::move(llData), llIntegrity.checksum);
+        auto planning = runInBackground([userId, generation, timestamp, token, chunkSize, gmPayload = std::move(gmPayload), llPayload = std::move(llPayload),
+                                         bases = std::move(bases), cloudManifest, storedIds = std::move(storedIds)]() mutable {
+            PlannedUpload planned;
+            // Key by key when the game's encoding decodes it, only the changed keys go up
+            if (!gmPayload.unchanged) {
+                if (auto changes = bettersave::core::prepareKeySync(gmPayload, userId, generation, gameSaveCodec(), storedIds, token.get())) {
+                    planned.gmByKey = true;
+                    planned.sentPaths = std::move(changes->sentPaths);
+                    planned.sentIds = std::move(changes->sentIds);
+                    planned.staleIds = std::move(changes->staleIds);
+                } else {
+                    planned.staleIds = storedIds;
+                }
+            }
+            if (cloudManifest && bases.first && !planned.gmByKey) {
+                planned.gmPatched = bettersave::core::preparePatch(gmPayload, *bases.first, *cloudManifest, "gm", token.get());
+            }
+            if (cloudManifest && bases.second) {
+                planned.llPatched = bettersave::core::preparePatch(llPayload, *bases.second, *cloudManifest, "ll", token.get());
+            }
+            // A file uploaded whole is the base the next upload patches against
+            if (!gmPayload.unchanged && !planned.gmPatched && !planned.gmByKey) {
+                planned.gmSignature = bettersave::core::serializeSignature(
+                    bettersave::core::computeSignature(gmPayload.data, gmPayload.checksum, token.get()));
+            }
+            if (!llPayload.unchanged && !planned.llPatched) {
+                planned.llSignature = bettersave::core::serializeSignature(
+                    bettersave::core::computeSignature(llPayload.data, llPayload.checksum, token.get()));
+            }
+            planned.plan = bettersave::core::planUpload(userId, generation, gmPayload, llPayload, timestamp, chunkSize, token.get());
+            return planned;
+        });
+        auto planned = co_await std::move(planning);
+        auto plan = std::move(planned.plan);
+
+        BetterSaveLogger::get()->info("Upload", "Split into {} GM chunks{}, {} LL chunks{} of {} characters (round trip {:.0f} ms, {:.0f} KB/s per request, {:.0f}% resent)",
+            plan.gmChunks.size(), planned.gmPatched ? " (patch)" : "", plan.llChunks.size(), planned.llPatched ? " (patch)" : "",
+            chunkSize, m_chunkSizer.roundTripMs(), m_chunkSizer.bytesPerSecond() / 1024.0, m_chunkSizer.resendRate() * 100.0);
+        if (planned.gmByKey) {
+            // The first few paths say what the session changed, a first upload would list them all
+            std::string paths;
+            for (size_t i = 0; i < std::min<size_t>(planned.sentPaths.size(), 5); i++) {
+                paths += (i > 0 ? ", " : "") + planned.sentPaths[i];
+            }
+            BetterSaveLogger::get()->info("Upload", "GM by key: {} of {} nodes changed{}", planned.sentPaths.size(), plan.manifest.gmKeyNodes,
+                paths.empty() ? "" : fmt::format(" ({}{})", paths, planned.sentPaths.size() > 5 ? ", ..." : ""));
+        }
+        BetterSaveLogger::get()->forceSave();
+
+        // Pick up where a paused, cancelled or failed upload of this same save stopped
+        auto journal = bettersave::core::UploadJournal::begin(userId, plan);
+        // A generation some stopped upload left behind that nothing points at, removed once committed
+        std::string abandonedGeneration;
+        if (previousJournal && previousJournal->matches(userId, plan)) {
+            journal = std::move(*previousJournal);
+        } else if (previousJournal && previousJournal->userId == userId && !previousJournal->generation.empty() &&
+                   previousJournal->generation != plan.generation && cloudManifest &&
+                   !bettersave::core::usesGeneration(*cloudManifest, previousJournal->generation)) {
+            abandonedGeneration = previousJournal->generation;
+        }
+        // The nodes a stopped upload sent stay recorded until some upload commits and removes them
+        std::unordered_set<std::string> journaledNodes(journal.gmNodes.begin(), journal.gmNodes.end());
+        if (previousJournal && previousJournal->userId == userId) {
+            for (const auto& id : previousJournal->gmNodes) {
+                if (journaledNodes.insert(id).second) journal.gmNodes.push_back(id);
+            }
+        }
+        for (const auto& id : planned.sentIds) {
+            if (journaledNodes.insert(id).second) journal.gmNodes.push_back(id);
+        }
+        bettersave::core::replaceFile(getJournalPath(), bettersave::core::serializeJournal(journal));
+
+        // Recorded locally once every chunk is up, so the next auto-backup can skip unchanged files
+        CommittedManifest manifest;
+        manifest.userId = userId;
+        manifest.timestamp = timestamp;
+        manifest.gameManager = skipGM ? committed.gameManager : toCommitted(plan.manifest, "gm", gmIntegrity.checksum, gmSignature);
+        manifest.localLevels = skipLL ? committed.localLevels : toCommitted(plan.manifest, "ll", llIntegrity.checksum, llSignature);
+
+        context = std::make_shared<UploadContext>();
+        context->plan = std::move(plan);
+        context->token = token;
+        context->journal = std::move(journal);
+
+        std::vector<bettersave::core::Task<void>> chunkUploads;
+        for (const char* prefix : {"gm", "ll"}) {
+            const auto& done = context->journal.done(prefix);
+            for (size_t i = 0; i < done.size(); i++) {
+                if (!done[i]) chunkUploads.push_back(uploadChunk(context, prefix, i));
+            }
+        }
+        context->total = static_cast<int>(context->plan.gmChunks.size() + context->plan.llChunks.size());
+        context->completed = context->total - static_cast<int>(chunkUploads.size());
+        if (context->completed > 0) {
+            BetterSaveLogger::get()->info("Upload", "Resuming: {} of {} chunks already uploaded", context->completed, context->total);
+        }
+        BetterSaveLogger::get()->info("Upload", "Starting parallel upload of {} chunks", chunkUploads.size());
+
+        // GM and LL chunks share one pool, LL starts while the last GM chunks are still in flight.
+        // They all go to this upload's generation, which nothing points at until the metadata goes
+        // up last: that's the commit point, a stopped upload leaves the cloud save as it was.
+        auto uploads = bettersave::core::whenAll(std::move(chunkUploads), MAX_CHUNK_TASKS, token.get());
+        co_await std::move(uploads);
+        token->throwIfCancelled();
+
+        // Pages are small and not journaled, a resumed upload sends them again
+        std::vector<bettersave::core::Task<void>> pageUploads;
+        for (size_t i = 0; i < context->plan.gmPages.size(); i++) pageUploads.push_back(uploadPage(context, "gm", i));
+        for (size_t i = 0; i < context->plan.llPages.size(); i++) pageUploads.push_back(uploadPage(context, "ll", i));
+        if (!pageUploads.empty()) {
+            emit(op, SyncEventType::Status, "Uploading chunk index...");
+            auto pageUpload = bettersave::core::whenAll(std::move(pageUploads), MAX_CHUNK_TASKS, token.get());
+            co_await std::move(pageUpload);
+            token->throwIfCancelled();
+        }
+
+        emit(op, SyncEventType::Status, "Uploading metadata...");
+        TraceSpan metaSpan;
+        auto metaBody = bettersave::core::serializeManifest(context->plan.manifest);
+        auto metaSentAt = std::chrono::steady_clock::now();
+        int metaAttempts = 0;
+        auto metaRequest = sendRequest(RateLimiter::DATABASE_REQUEST, [&metaBody, userId, &metaSpan, &metaSentAt, &metaAttempts]() {
+            web::WebRequest metaReq = web::WebRequest();
+            metaReq.userAgent("");
+            metaReq.header("Content-Type", "application/json");
+            metaReq.bodyString(metaBody);
+            // One span per attempt, a throttled retry ends the previous one
+            metaSpan = TraceSpan("metadata_put", "network", TraceSpan::Kind::Async);
+            metaSentAt = std::chrono::steady_clock::now();
+            metaAttempts++;
+            return metaReq.put(FirebaseAuth::get()->getDatabaseUrl(bettersave::core::manifestKey(userId)));
+        });
+        auto resp = co_await std::move(metaRequest);
+
+        metaSpan.arg("status", resp.code());
+        metaSpan.end();
+        MetricsRegistry::get()->counter("requests").add();
+        if (!resp.ok()) {
+            MetricsRegistry::get()->counter("requests.failed").add();
+            auto err = resp.string().unwrapOr("Unknown error");
+            BetterSaveLogger::get()->error("Upload", "Metadata failed: {}", err);
+            throw SyncFailure(fmt::format("Metadata upload failed\n{}", err));
+        }
+        m_chunkSizer.onTransfer(metaBody.size(), std::chrono::steady_clock::now() - metaSentAt, metaAttempts - 1);
+
+        std::error_code ec;
+        std::filesystem::remove(getJournalPath(), ec);
+        ManifestStore::get()->commit(manifest);
+        if (planned.gmSignature) bettersave::core::replaceFile(getSignaturePath("gm"), *planned.gmSignature);
+        if (planned.llSignature) bettersave::core::replaceFile(getSignaturePath("ll"), *planned.llSignature);
+        // Committed, what only the previous save pointed at can go
+        std::vector<std::string> replaced;
+        if (cloudManifest) {
+            replaced = bettersave::core::replacedKeys(userId, *cloudManifest, context->plan.manifest);
+        }
+        if (!abandonedGeneration.empty()) {
+            replaced.push_back(bettersave::core::generationKey(userId, abandonedGeneration));
+        }
+        if (!replaced.empty()) {
+            auto removing = removeKeys(std::move(replaced), "old chunks and pages");
+            co_await std::move(removing);
+        }
+        // Nodes this save no longer lists, and any a stopped upload sent that no save lists
+        auto nodeIds = std::move(planned.staleIds);
+        nodeIds.insert(nodeIds.end(), context->journal.gmNodes.begin(), context->journal.gmNodes.end());
+        if (!nodeIds.empty()) {
+            auto removing = removeUnlistedNodes(userId, std::move(nodeIds));
+            co_await std::move(removing);
+        }
+        BetterSaveLogger::get()->success("Upload", "All data uploaded successfully");
+        BetterSaveLogger::get()->forceSave();
+
+        emit(op, SyncEventType::Completed, "Upload complete!");
+        if (onComplete) onComplete(true, "Your save data has been uploaded to the cloud!");
+
+    } catch (const bettersave::core::OperationCancelled&) {
+        // Stopped uploads keep the journal for next time and the cloud keeps its previous manifest
+        if (!context) {
+            fail(op, "Upload cancelled.", onComplete);
+            co_return;
+        }
+        bettersave::core::replaceFile(getJournalPath(), bettersave::core::serializeJournal(context->journal));
+        BetterSaveLogger::get()->info("Upload", "Upload cancelled, {} chunks kept for the next upload", context->journal.completedCount());
+        fail(op, fmt::format("Upload cancelled.\n{} chunks already uploaded will be skipped next time.",
+            context->journal.completedCount()), onComplete);
+    } catch (const SyncFailure& e) {
+        if (context) {
+            bettersave::core::replaceFile(getJournalPath(), bettersave::core::serializeJournal(context->journal));
+        }
+        fail(op, e.what(), onComplete);
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->error("Upload", "Exception: {}", e.what());
+        fail(op, fmt::format("Error: {}", e.what()), onComplete);
+    }
+}
+
+bettersave::core::Task<void> SyncEngine::uploadChunk(std::shared_ptr<UploadContext> context, std::string prefix, size_t index) {
+    const auto& chunk = (prefix == "gm" ? context->plan.gmChunks : context->plan.llChunks)[index];
+
+    TraceSpan span;
+    auto sentAt = std::chrono::steady_clock::now();
+    int attempts = 0;
+    auto request = sendRequest(RateLimiter::DATABASE_REQUEST, [&chunk, &span, &sentAt, &attempts, &prefix, index]() {
+        span = TraceSpan("chunk_put", "network", TraceSpan::Kind::Async);
+        span.arg("chunk", prefix + std::to_string(index));
+        sentAt = std::chrono::steady_clock::now();
+        attempts++;
+        // Chunks are framed by the planner, send the body as-is instead of re-serializing it
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        req.header("Content-Type", "application/json");
+        req.bodyString(chunk.body);
+        return req.put(FirebaseAuth::get()->getDatabaseUrl(chunk.key));
+    }, context->token, chunk.body.size());
+    auto resp = co_await std::move(request);
+
+    GameplayGuard::ScopedTimer timer;
+    auto bodySize = static_cast<int64_t>(chunk.body.size());
+    span.arg("status", resp.code()).arg("bytes", bodySize);
+    span.end();
+    MetricsRegistry::get()->counter("requests").add();
+    if (!resp.ok()) {
+        MetricsRegistry::get()->counter("requests.failed").add();
+        auto err = resp.string().unwrapOr("Unknown");
+        BetterSaveLogger::get()->error("Upload", "Chunk {}{} failed: {}", prefix, index, err);
+        throw SyncFailure(fmt::format("Failed at {} chunk {}\n{}", prefix, index, err));
+    }
+
+    MetricsRegistry::get()->counter("upload.bytes").add(bodySize);
+    m_chunkSizer.onTransfer(chunk.body.size(), std::chrono::steady_clock::now() - sentAt, attempts - 1);
+    context->journal.done(prefix)[index] = true;
+    int completed = ++context->completed;
+    // Often enough that a crash loses little, rarely enough to stay cheap on huge saves
+    if (completed % 32 == 0) {
+        bettersave::core::replaceFile(getJournalPath(), bettersave::core::serializeJournal(context->journal));
+    }
+
+    emit(SyncOperation::Upload, SyncEventType::Progress, "Uploading chunks...", completed, context->total);
+}
+
+bettersave::core::Task<void> SyncEngine::uploadPage(std::shared_ptr<UploadContext> context, std::string prefix, size_t index) {
+    const auto& page = (prefix == "gm" ? context->plan.gmPages : context->plan.llPages)[index];
+
+    TraceSpan span;
+    auto sentAt = std::chrono::steady_clock::now();
+    int attempts = 0;
+    auto request = sendRequest(RateLimiter::DATABASE_REQUEST, [&page, &span, &sentAt, &attempts, &prefix, index]() {
+        span = TraceSpan("page_put", "network", TraceSpan::Kind::Async);
+        span.arg("page", prefix + std::to_string(index));
+        sentAt = std::chrono::steady_clock::now();
+        attempts++;
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        req.header("Content-Type", "application/json");
+        req.bodyString(page.body);
+        return req.put(FirebaseAuth::get()->getDatabaseUrl(page.key));
+    }, context->token, page.body.size());
+    auto resp = co_await std::move(request);
+
+    span.arg("status", resp.code());
+    span.end();
+    MetricsRegistry::get()->counter("requests").add();
+    if (!resp.ok()) {
+        MetricsRegistry::get()->counter("requests.failed").add();
+        auto err = resp.string().unwrapOr("Unknown");
+        BetterSaveLogger::get()->error("Upload", "Index page {}{} failed: {}", prefix, index, err);
+        throw SyncFailure(fmt::format("Failed at {} index page {}\n{}", prefix, index, err));
+    }
+    MetricsRegistry::get()->counter("upload.bytes").add(static_cast<int64_t>(page.body.size()));
+    m_chunkSizer.onTransfer(page.body.size(), std::chrono::steady_clock::now() - sentAt, attempts - 1);
+}
+
+// Checksums of every chunk of a file from its index pages, nullopt for a file from before paging
+static std::optional<std::vector<std::string>> getChunkChecksums(const std::string& prefix,
+                                                                 const std::vector<bettersave::core::IndexPage>& pages, int chunkCount) {
+    if (pages.empty()) {
+        return std::nullopt;
+    }
+    auto checksums = bettersave::core::joinPages(pages, chunkCount);
+    if (!checksums) {
+        throw SyncFailure(fmt::format("Cloud save is corrupted ({} index pages)", prefix));
+    }
+    return checksums;
+}
+
+// Reassembles one file from its chunk bodies and checks it against the cloud manifest (and each
+// chunk against its index page). Runs on a worker thread, so it only throws and leaves the
+// logging to the caller.
+static std::string decodeFile(const std::string& prefix, const std::vector<std::string>& bodies, const std::string& checksum,
+                              const std::optional<std::vector<std::string>>& chunkChecksums,
+                              const bettersave::core::CancellationToken* cancel) {
+    auto data = bettersave::core::decodeChunks(bodies, cancel, chunkChecksums ? &*chunkChecksums : nullptr);
+    if (!data) {
+        throw SyncFailure(fmt::format("Cloud save is corrupted ({} chunks)", prefix));
+    }
+    // Older saves have no checksums, newer ones must match what was uploaded
+    if (!checksum.empty() && bettersave::core::checksumHex(*data) != checksum) {
+        throw SyncFailure("Cloud save is corrupted (checksum mismatch)");
+    }
+    return std::move(*data);
+}
+
+// One file as downloaded: the chunks of its base and, if it was uploaded as one, of its patch
+struct DownloadedFile {
+    std::string prefix;
+    std::string checksum;
+    std::string baseChecksum;
+    std::vector<std::string> bodies;
+    std::optional<std::vector<std::string>> chunkChecksums;
+    std::vector<std::string> patchBodies;
+    std::optional<std::vector<std::string>> patchChecksums;
+};
+
+// Decodes the base, applies the patch over it and checks the result like decodeFile. The base's
+// signature is saved on the way, the next upload of this file can be a patch against it.
+static std::string rebuildFile(const DownloadedFile& file, const bettersave::core::CancellationToken* cancel) {
+    bool patched = !file.patchBodies.empty();
+    const auto& baseChecksum = patched ? file.baseChecksum : file.checksum;
+    auto base = decodeFile(file.prefix, file.bodies, baseChecksum, file.chunkChecksums, cancel);
+    if (!baseChecksum.empty()) {
+        auto signature = bettersave::core::computeSignature(base, baseChecksum, cancel);
+        bettersave::core::replaceFile(SyncEngine::getSignaturePath(file.prefix), bettersave::core::serializeSignature(signature));
+    }
+    if (!patched) {
+        return base;
+    }
+
+    auto patch = decodeFile(bettersave::core::patchPrefix(file.prefix), file.patchBodies, "", file.patchChecksums, cancel);
+    auto data = bettersave::core::applyPatch(base, patch);
+    if (!data) {
+        throw SyncFailure(fmt::format("Cloud save is corrupted ({} patch)", file.prefix));
+    }
+    if (!file.checksum.empty() && bettersave::core::checksumHex(*data) != file.checksum) {
+        throw SyncFailure("Cloud save is corrupted (checksum mismatch)");
+    }
+    return std::move(*data);
+}
+
+bettersave::core::Task<std::optional<bettersave::core::SaveManifest>> SyncEngine::fetchCloudManifest() {
+    TraceSpan metaSpan;
+    auto metaSentAt = std::chrono::steady_clock::now();
+    int metaAttempts = 0;
+    auto metaRequest = sendRequest(RateLimiter::DATABASE_REQUEST, [userId = FirebaseAuth::get()->getUserId(), &metaSpan, &metaSentAt, &metaAttempts]() {
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        metaSpan = TraceSpan("metadata_get", "network", TraceSpan::Kind::Async);
+        metaSentAt = std::chrono::steady_clock::now();
+        metaAttempts++;
+        return req.get(FirebaseAuth::get()->getDatabaseUrl(bettersave::core::manifestKey(userId)));
+    });
+    auto resp = co_await std::move(metaRequest);
+
+    metaSpan.arg("status", resp.code());
+    metaSpan.end();
+    MetricsRegistry::get()->counter("requests").add();
+    if (!resp.ok()) {
+        MetricsRegistry::get()->counter("requests.failed").add();
+        throw SyncFailure("No cloud save found");
+    }
+    m_chunkSizer.onTransfer(resp.data().size(), std::chrono::steady_clock::now() - metaSentAt, metaAttempts - 1);
+
+    // Firebase answers "null" when there is no save yet
+    co_return bettersave::core::parseManifest(resp.string().unwrapOr(""));
+}
+
+bettersave::core::Task<SyncEngine::CloudSave> SyncEngine::downloadCloudSave(TokenPtr token) {
+    auto context = std::make_shared<DownloadContext>();
+    context->userId = FirebaseAuth::get()->getUserId();
+    context->token = token;
+
+    auto fetching = fetchCloudManifest();
+    auto meta = co_await std::move(fetching);
+    if (!meta) {
+        throw SyncFailure("Invalid cloud save");
+    }
+    token->throwIfCancelled();
+
+    // Each file's base and patch are fetched like files of their own, all side by side
+    struct Part {
+        std::string generation;
+        std::string prefix;
+        int chunks;
+        int pages;
+    };
+    std::vector<Part> parts = {
+        {meta->gmGeneration, "gm", meta->gmChunks, meta->gmPages},
+        {meta->llGeneration, "ll", meta->llChunks, meta->llPages},
+        {meta->gmPatchGeneration, bettersave::core::patchPrefix("gm"), meta->gmPatchChunks, meta->gmPatchPages},
+        {meta->llPatchGeneration, bettersave::core::patchPrefix("ll"), meta->llPatchChunks, meta->llPatchPages},
+    };
+
+    // Every part's pages at once, a large save has many of them
+    std::vector<bettersave::core::Task<bettersave::core::IndexPage>> pageDownloads;
+    for (const auto& part : parts) {
+        for (int i = 0; i < part.pages; i++) pageDownloads.push_back(downloadPage(context, part.generation, part.prefix, i));
+    }
+    auto pageFetch = bettersave::core::whenAll(std::move(pageDownloads), MAX_CHUNK_TASKS, token.get());
+    auto pages = co_await std::move(pageFetch);
+    // A CCGameManager.dat stored key by key has no chunks, its nodes come down with the chunks
+    bool gmByKey = meta->gmKeyNodes > 0;
+    std::vector<std::string> nodeIds;
+    if (gmByKey) {
+        auto fetchingIndex = fetchKeyIndex(context, meta->gmGeneration, meta->gmKeyNodes, meta->gmKeyPages);
+        nodeIds = co_await std::move(fetchingIndex);
+    }
+    std::vector<std::optional<std::vector<std::string>>> checksums;
+    auto nextPage = pages.begin();
+    for (const auto& part : parts) {
+        std::vector<bettersave::core::IndexPage> partPages(std::make_move_iterator(nextPage), std::make_move_iterator(nextPage + part.pages));
+        nextPage += part.pages;
+        checksums.push_back(getChunkChecksums(part.prefix, partPages, part.chunks));
+    }
+
+    BetterSaveLogger::get()->info("Download", "Downloading {} GM + {} LL chunks in parallel ({} + {} of them patches)",
+        meta->gmChunks + meta->gmPatchChunks, meta->llChunks + meta->llPatchChunks, meta->gmPatchChunks, meta->llPatchChunks);
+    if (gmByKey) {
+        BetterSaveLogger::get()->info("Download", "Downloading {} GM nodes", nodeIds.size());
+    }
+    std::vector<bettersave::core::Task<std::string>> chunkDownloads;
+    for (const auto& part : parts) {
+        for (int i = 0; i < part.chunks; i++) {
+            chunkDownloads.push_back(downloadChunk(context, bettersave::core::chunkKey(context->userId, part.generation, part.prefix, i),
+                                                   part.prefix + " chunk " + std::to_string(i)));
+        }
+    }
+    for (const auto& id : nodeIds) {
+        chunkDownloads.push_back(downloadChunk(context, bettersave::core::nodeKey(context->userId, id), "GM node " + id));
+    }
+    context->total = static_cast<int>(chunkDownloads.size());
+    auto downloads = bettersave::core::whenAll(std::move(chunkDownloads), MAX_CHUNK_TASKS, token.get());
+    auto bodies = co_await std::move(downloads);
+    std::vector<std::vector<std::string>> partBodies;
+    auto nextBody = bodies.begin();
+    for (const auto& part : parts) {
+        partBodies.emplace_back(std::make_move_iterator(nextBody), std::make_move_iterator(nextBody + part.chunks));
+        nextBody += part.chunks;
+    }
+    std::vector<std::string> nodeBodies(std::make_move_iterator(nextBody), std::make_move_iterator(bodies.end()));
+
+    DownloadedFile gameManager{"gm", meta->gmChecksum, meta->gmBaseChecksum, std::move(partBodies[0]), std::move(checksums[0]),
+                               std::move(partBodies[2]), std::move(checksums[2])};
+    DownloadedFile localLevels{"ll", meta->llChecksum, meta->llBaseChecksum, std::move(partBodies[1]), std::move(checksums[1]),
+                               std::move(partBodies[3]), std::move(checksums[3])};
+
+    // Both files decode side by side off the main thread, framing is checked once all chunks arrived
+    auto holding = holdWhilePaused(token);
+    co_await std::move(holding);
+    std::vector<bettersave::core::Task<std::string>> decodes;
+    if (gmByKey) {
+        // Checked against the plist checksum, the encoded bytes differ from the file that was uploaded
+        decodes.push_back(runInBackground([bodies = std::move(nodeBodies), ids = std::move(nodeIds),
+                                           plistChecksum = meta->gmPlistChecksum, token]() {
+            auto codec = gameSaveCodec();
+            auto plist = bettersave::core::joinNodes(bodies, ids, plistChecksum, codec, token.get());
+            if (!plist) {
+                throw SyncFailure("Cloud save is corrupted (GM keys)");
+            }
+            return codec.encode(*plist);
+        }));
+    } else {
+        decodes.push_back(runInBackground([file = std::move(gameManager), token]() {
+            return rebuildFile(file, token.get());
+        }));
+    }
+    decodes.push_back(runInBackground([file = std::move(localLevels), token]() {
+        return rebuildFile(file, token.get());
+    }));
+    auto decoding = bettersave::core::whenAll(std::move(decodes));
+    auto files = co_await std::move(decoding);
+
+    BetterSaveLogger::get()->info("Download", "Decoded {} + {} bytes", files[0].size(), files[1].size());
+    co_return CloudSave{std::move(files[0]), std::move(files[1]), *meta};
+}
+
+bettersave::core::Task<std::string> SyncEngine::downloadChunk(std::shared_ptr<DownloadContext> context, std::string key, std::string label) {
+    TraceSpan span;
+    auto sentAt = std::chrono::steady_clock::now();
+    int attempts = 0;
+    auto request = sendRequest(RateLimiter::DATABASE_REQUEST, [&key, &label, &span, &sentAt, &attempts]() {
+        span = TraceSpan("chunk_get", "network", TraceSpan::Kind::Async);
+        span.arg("chunk", label);
+        sentAt = std::chrono::steady_clock::now();
+        attempts++;
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        return req.get(FirebaseAuth::get()->getDatabaseUrl(key));
+    }, context->token);
+    auto resp = co_await std::move(request);
+
+    GameplayGuard::ScopedTimer timer;
+    span.arg("status", resp.code()).arg("bytes", static_cast<int64_t>(resp.data().size()));
+    span.end();
+    MetricsRegistry::get()->counter("requests").add();
+    if (!resp.ok()) {
+        MetricsRegistry::get()->counter("requests.failed").add();
+        BetterSaveLogger::get()->error("Download", "{} failed", label);
+        throw SyncFailure(fmt::format("Failed at {}", label));
+    }
+
+    auto body = resp.string().unwrapOr("");
+    MetricsRegistry::get()->counter("download.bytes").add(static_cast<int64_t>(body.size()));
+    m_chunkSizer.onTransfer(body.size(), std::chrono::steady_clock::now() - sentAt, attempts - 1);
+    int completed = ++context->completed;
+    emit(SyncOperation::Download, SyncEventType::Progress, "Downloading chunks...", completed, context->total);
+    co_return body;
+}
+
+bettersave::core::Task<bettersave::core::IndexPage> SyncEngine::downloadPage(std::shared_ptr<DownloadContext> context, std::string generation,
+                                                                             std::string prefix, size_t index, size_t entryLength) {
+    TraceSpan span;
+    auto sentAt = std::chrono::steady_clock::now();
+    int attempts = 0;
+    auto request = sendRequest(RateLimiter::DATABASE_REQUEST, [userId = context->userId, &span, &sentAt, &attempts, &generation, &prefix, index]() {
+        span = TraceSpan("page_get", "network", TraceSpan::Kind::Async);
+        span.arg("page", prefix + std::to_string(index));
+        sentAt = std::chrono::steady_clock::now();
+        attempts++;
+        web::WebRequest req = web::WebRequest();
+        req.userAgent("");
+        return req.get(FirebaseAuth::get()->getDatabaseUrl(bettersave::core::pageKey(userId, generation, prefix, index)));
+    }, context->token);
+    auto resp = co_await std::move(request);
+
+    span.arg("status", resp.code());
+    span.end();
+    MetricsRegistry::get()->counter("requests").add();
+    auto page = resp.ok() ? bettersave::core::parsePage(resp.string().unwrapOr(""), entryLength) : std::nullopt;
+    if (!page) {
+        MetricsRegistry::get()->counter("requests.failed").add();
+        BetterSaveLogger::get()->error("Download", "Index page {}{} failed", prefix, index);
+        throw SyncFailure(fmt::format("Failed at {} index page {}", prefix, index));
+    }
+    MetricsRegistry::get()->counter("download.bytes").add(static_cast<int64_t>(resp.data().size()));
+    m_chunkSizer.onTransfer(resp.data().size(), std::chrono::steady_clock::now() - sentAt, attempts - 1);
+    co_return std::move(*page);
+}
+
+bettersave::core::Task<std::vector<std::string>> SyncEngine::fetchKeyIndex(std::shared_ptr<DownloadContext> context, std::string generation,
+                                                                           int nodes, int pages) {
+    std::vector<bettersave::core::Task<bettersave::core::IndexPage>> pageDownloads;
+    for (int i = 0; i < pages; i++) {
+        pageDownloads.push_back(downloadPage(context, generation, bettersave::core::KEY_PAGE_PREFIX, i, bettersave::core::NODE_ID_LENGTH));
+    }
+    auto pageFetch = bettersave::core::whenAll(std::move(pageDownloads), MAX_CHUNK_TASKS, context->token.get());
+    auto fetched = co_await std::move(pageFetch);
+    auto ids = bettersave::core::joinPages(fetched, nodes);
+    if (!ids) {
+        throw SyncFailure("Cloud save is corrupted (GM key index pages)");
+    }
+    co_return std::move(*ids);
+}
+
+bettersave::core::Task<void> SyncEngine::removeKeys(std::vector<std::string> keys, std::string what) {
+    // Setting a child to null deletes it with everything under it, one PATCH per parent covers them all
+    std::map<std::string, std::vector<std::string>> children;
+    for (const auto& key : keys) {
+        auto slash = key.rfind('/');
+        children[key.substr(0, slash)].push_back(key.substr(slash + 1));
+    }
+
+    size_t failed = 0;
+    for (const auto& entry : children) {
+        std::string parent = entry.first;
+        matjson::Value body;
+        for (const auto& child : entry.second) {
+            body[child] = matjson::Value();
+        }
+        auto request = sendRequest(RateLimiter::DATABASE_REQUEST, [&body, &parent]() {
+            web::WebRequest req = web::WebRequest();
+            req.userAgent("");
+            req.bodyJSON(body);
+            return req.patch(FirebaseAuth::get()->getDatabaseUrl(parent));
+        });
+        auto resp = co_await std::move(request);
+
+        MetricsRegistry::get()->counter("requests").add();
+        if (!resp.ok()) {
+            MetricsRegistry::get()->counter("requests.failed").add();
+            failed += entry.second.size();
+        }
+    }
+    if (failed > 0) {
+        // The committed save no longer points at them, left behind they only take up space
+        BetterSaveLogger::get()->warning("Upload", "Could not remove {} of {} {}", failed, keys.size(), what);
+        co_return;
+    }
+    BetterSaveLogger::get()->info("Upload", "Removed {} {}", keys.size(), what);
+}
+
+bettersave::core::Task<void> SyncEngine::removeUnlistedNodes(std::string userId, std::vector<std::string> ids) {
+    std::unordered_set<std::string> listed;
+    try {
+        auto fetching = fetchCloudManifest();
+        auto cloud = co_await std::move(fetching);
+        if (cloud && cloud->gmKeyNodes > 0) {
+            auto context = std::make_shared<DownloadContext>();
+            context->userId = userId;
+            // The upload is already committed, cancelling it no longer stops its cleanup
+            context->token = std::make_shared<bettersave::core::CancellationToken>();
+            auto fetchingIndex = fetchKeyIndex(context, cloud->gmGeneration, cloud->gmKeyNodes, cloud->gmKeyPages);
+            auto current = co_await std::move(fetchingIndex);
+            listed.insert(current.begin(), current.end());
+        }
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->warning("Upload", "Could not read the cloud's GM key index, keeping old GM nodes: {}", e.what());
+        co_return;
+    }
+
+    std::unordered_set<std::string> removed;
+    std::vector<std::string> keys;
+    for (const auto& id : ids) {
+        if (!listed.count(id) && removed.insert(id).second) keys.push_back(bettersave::core::nodeKey(userId, id));
+    }
+    if (!keys.empty()) {
+        auto removing = removeKeys(std::move(keys), "old GM nodes");
+        co_await std::move(removing);
+    }
+}
+
+bettersave::core::Task<void> SyncEngine::runRestore(TokenPtr token, std::function<void(bool, const std::string&)> onComplete) {
+    auto op = SyncOperation::Download;
+    emit(op, SyncEventType::Started, "Downloading metadata...");
+
+    CloudSave cloud;
+    try {
+        auto download = downloadCloudSave(token);
+        cloud = co_await std::move(download);
+        // Past this point the local save is being replaced, cancelling no longer applies
+        auto holding = holdWhilePaused(token);
+        co_await std::move(holding);
+    } catch (const bettersave::core::OperationCancelled&) {
+        fail(op, "Download cancelled.\nYour local save was not touched.", onComplete);
+        co_return;
+    } catch (const SyncFailure& e) {
+        BetterSaveLogger::get()->error("Download", "{}", e.what());
+        fail(op, e.what(), onComplete);
+        co_return;
+    }
+    const auto& gmData = cloud.gmData;
+    const auto& llData = cloud.llData;
+
+    emit(op, SyncEventType::Status, "Decoding and saving...");
+
+    // Get save directory (same location as uploaded from)
+    auto savePath = geode::dirs::getSaveDir();
+    auto gmPath = savePath / "CCGameManager.dat";
+    auto llPath = savePath / "CCLocalLevels.dat";
+    auto gmPath2 = savePath / "CCGameManager2.dat";
+    auto llPath2 = savePath / "CCLocalLevels2.dat";
+
+    // Keep a copy of what we're about to overwrite
+    if (auto snapshotDir = snapshotLocalSaves()) {
+        BetterSaveLogger::get()->info("Download", "Snapshot of local save: {}", snapshotDir->string());
+    } else {
+        BetterSaveLogger::get()->warning("Download", "Could not snapshot the local save before overwriting it");
+    }
+
+    // Delete existing files (including backups) if they exist
+    try {
+        for (const auto& path : {gmPath, llPath, gmPath2, llPath2}) {
+            if (std::filesystem::exists(path)) {
+                std::filesystem::remove(path);
+                BetterSaveLogger::get()->info("Download", "Deleted existing {}", path.filename().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->warning("Download", "Could not delete old files: {}", e.what());
+    }
+
+    // Write new files with FORCED syncing
+    try {
+        // Close any open file handles by forcing GameManager to save
+        GameManager::sharedState()->save();
+
+        // Additional delay to ensure GameManager finished writing
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        bettersave::core::writeFileSynced(gmPath, gmData);
+        BetterSaveLogger::get()->info("Download", "Wrote CCGameManager.dat ({} bytes)", gmData.size());
+
+        bettersave::core::writeFileSynced(llPath, llData);
+        BetterSaveLogger::get()->info("Download", "Wrote CCLocalLevels.dat ({} bytes)", llData.size());
+
+        // Verify both files exist and have correct size
+        if (!std::filesystem::exists(gmPath)) {
+            throw std::runtime_error("CCGameManager.dat was not created!");
+        }
+        if (!std::filesystem::exists(llPath)) {
+            throw std::runtime_error("CCLocalLevels.dat was not created!");
+        }
+
+        auto gmSize = std::filesystem::file_size(gmPath);
+        auto llSize = std::filesystem::file_size(llPath);
+
+        if (gmSize != static_cast<std::uintmax_t>(gmData.size())) {
+            throw std::runtime_error(fmt::format("CCGameManager.dat size wrong: expected {}, got {}", gmData.size(), gmSize));
+        }
+        if (llSize != static_cast<std::uintmax_t>(llData.size())) {
+            throw std::runtime_error(fmt::format("CCLocalLevels.dat size wrong: expected {}, got {}", llData.size(), llSize));
+        }
+
+        // The local save now equals the cloud save, the next auto-backup has nothing to upload
+        CommittedManifest manifest;
+        manifest.userId = FirebaseAuth::get()->getUserId();
+        manifest.timestamp = cloud.manifest.timestamp;
+        manifest.gameManager = toCommitted(cloud.manifest, "gm", SaveIntegrityChecker::checkData(gmPath, gmData).checksum,
+            IntegrityCache::getSignature(gmPath).value_or(FileSignature()));
+        manifest.localLevels = toCommitted(cloud.manifest, "ll", SaveIntegrityChecker::checkData(llPath, llData).checksum,
+            IntegrityCache::getSignature(llPath).value_or(FileSignature()));
+        ManifestStore::get()->commit(manifest);
+
+        emit(op, SyncEventType::Status, "Reloading game data...");
+        BetterSaveLogger::get()->success("Download", "VERIFIED: GM={} bytes, LL={} bytes", gmSize, llSize);
+        BetterSaveLogger::get()->forceSave();
+
+        // One final sync delay to ensure files are flushed to disk
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        // CRITICAL: Reload GameManager and LocalLevelManager from disk
+        // This prevents the old in-memory data from overwriting the downloaded files
+        Loader::get()->queueInMainThread([this, op, onComplete]() {
+            TraceSpan reloadSpan("reload_game_data", "game");
+            BetterSaveLogger::get()->info("Download", "Reloading GameManager from downloaded files");
+
+            // Call setup() to reload data from disk
+            // This loads the downloaded files into memory
+            GameManager::sharedState()->setup();
+            LocalLevelManager::sharedState()->setup();
+
+            BetterSaveLogger::get()->success("Download", "GameManager reloaded with new data");
+            reloadSpan.end();
+
+            emit(op, SyncEventType::Completed, "Download Complete!");
+            if (onComplete) onComplete(true, "Save data downloaded and loaded successfully!");
+        });
+
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->error("Download", "Failed to write files: {}", e.what());
+        fail(op, fmt::format("Could not write save files:\n{}", e.what()), onComplete);
+    }
+}
+
+bettersave::core::Task<void> SyncEngine::runDownloadTo(std::filesystem::path targetDir, TokenPtr token, std::function<void(bool, const std::string&)> onComplete) {
+    auto op = SyncOperation::Download;
+    emit(op, SyncEventType::Started, "Downloading metadata...");
+
+    BetterSaveLogger::get()->info("Download", "Custom download to: {}", targetDir.string());
+
+    CloudSave cloud;
+    try {
+        auto download = downloadCloudSave(token);
+        cloud = co_await std::move(download);
+        auto holding = holdWhilePaused(token);
+        co_await std::move(holding);
+    } catch (const bettersave::core::OperationCancelled&) {
+        fail(op, "Download cancelled.", onComplete);
+        co_return;
+    } catch (const SyncFailure& e) {
+        BetterSaveLogger::get()->error("Download", "{}", e.what());
+        fail(op, e.what(), onComplete);
+        co_return;
+    }
+
+    emit(op, SyncEventType::Status, "Decoding and saving...");
+
+    try {
+        // Save to custom location
+        auto gmPath = targetDir / "CCGameManager.dat";
+        auto llPath = targetDir / "CCLocalLevels.dat";
+
+        bettersave::core::writeFileSynced(gmPath, cloud.gmData);
+        BetterSaveLogger::get()->info("Download", "Saved to: {}", gmPath.string());
+
+        bettersave::core::writeFileSynced(llPath, cloud.llData);
+        BetterSaveLogger::get()->info("Download", "Saved to: {}", llPath.string());
+    } catch (const std::exception& e) {
+        BetterSaveLogger::get()->error("Download", "Failed to write files: {}", e.what());
+        fail(op, fmt::format("Could not write save files:\n{}", e.what()), onComplete);
+        co_return;
+    }
+
+    BetterSaveLogger::get()->success("Download", "Save downloaded to custom location");
+    emit(op, SyncEventType::Completed, "Download complete!");
+    if (onComplete) onComplete(true, fmt::format("Save files downloaded to:\n{}", targetDir.string()));
+}
+
+void SyncEngine::verify(std::function<void(const IntegrityScanSummary&)> onComplete) {
+    auto op = SyncOperation::Verify;
+    BetterSaveLogger::get()->info("Integrity", "Starting save integrity check");
+    emit(op, SyncEventType::Started, "Checking save integrity...");
+
+    auto checkedCount = std::make_shared<int>(0);
+    int totalFiles = static_cast<int>(SaveIntegrityChecker::getManagedSaveFiles().size());
+
+    SaveIntegrityChecker::scanAllSavesAsync(
+        [this, op, checkedCount, totalFiles](const SaveFileReport& report) {
+            (*checkedCount)++;
+
+            if (!report.exists) {
+                BetterSaveLogger::get()->info("Integrity", "{} not present", report.fileName);
+            } else if (report.result.isValid) {
+                BetterSaveLogger::get()->success("Integrity",
+                    "{} is valid (Size: {} bytes, Checksum: {}{})", report.fileName,
+                        report.result.fileSize, report.result.checksum, report.result.fromCache ? ", cached" : "");
+            } else {
+                BetterSaveLogger::get()->error("Integrity",
+                    "{} failed: {}", report.fileName, report.result.message);
+            }
+
+            emit(op, SyncEventType::Progress, fmt::format("Checked {}", report.fileName), *checkedCount, totalFiles);
+        },
+        [this, op, onComplete](const IntegrityScanSummary& summary) {
+            bool primariesValid = true;
+            for (const auto& report : summary.reports) {
+                bool isPrimary = report.fileName == "CCGameManager.dat" || report.fileName == "CCLocalLevels.dat";
+                if (isPrimary && (!report.exists || !report.result.isValid)) {
+                    primariesValid = false;
+                }
+            }
+
+            if (primariesValid) {
+                BetterSaveLogger::get()->success("Integrity", "All save files passed integrity check");
+                emit(op, SyncEventType::Completed, "Integrity check passed!");
+            } else {
+                BetterSaveLogger::get()->error("Integrity", "Save integrity check failed");
+                emit(op, SyncEventType::Failed, "Integrity check failed!");
+            }
+
+            if (onComplete) onComplete(summary);
+        }
+    );
+}
+
+std::optional<std::filesystem::path> SyncEngine::snapshotLocalSaves() {
+    try {
+        auto saveDir = geode::dirs::getSaveDir();
+        return bettersave::core::snapshotSaveFiles(saveDir, saveDir / "bettersave_snapshots", MAX_SNAPSHOTS);
+    } catch (const std::exception& e) {
+        geode::log::error("Failed to snapshot local saves: {}", e.what());
+        return std::nullopt;
+    }
+}
+
+void SyncEngine::runSnapshot(std::function<void(bool, const std::string&)> onComplete) {
+    auto op = SyncOperation::Snapshot;
+    emit(op, SyncEventType::Started, "Snapshotting local save...");
+
+    // Copying a large save would stall a frame, do it off the main thread
+    bettersave::core::ThreadPool::get()->submit([this, op, onComplete]() {
+        auto snapshotDir = snapshotLocalSaves();
+
+        Loader::get()->queueInMainThread([this, op, onComplete, snapshotDir]() {
+            if (!snapshotDir) {
+                BetterSaveLogger::get()->error("Snapshot", "Failed to snapshot local save");
+                fail(op, "Could not snapshot the local save", onComplete);
+                return;
+            }
+
+            BetterSaveLogger::get()->success("Snapshot", "Local save snapshot: {}", snapshotDir->string());
+            emit(op, SyncEventType::Completed, "Snapshot complete!");
+            if (onComplete) onComplete(true, snapshotDir->string());
+        });
+    });
+}
@@ -0,0 +1,194 @@
+/**
+ * BetterSave - Sync Engine
+ * UI-free owner of upload, download, verify and snapshot operations.
+ * Popups and the auto-backup scheduler only subscribe to its events.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <Geode/Geode.hpp>
+#include "IntegrityCache.hpp"
+#include "SaveIntegrityChecker.hpp"
+#include "core/Cancellation.hpp"
+#include "core/ChunkSizer.hpp"
+#include "core/KeySync.hpp"
+#include "core/Task.hpp"
+#include "core/Trace.hpp"
+#include "core/Transfer.hpp"
+#include "core/UploadJournal.hpp"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace geode::prelude;
+
+enum class SyncOperation {
+    Upload,
+    Download,
+    Verify,
+    Snapshot
+};
+
+enum class SyncEventType {
+    Started,
+    Status,
+    Progress,
+    Completed,
+    Failed
+};
+
+struct SyncEvent {
+    SyncOperation operation;
+    SyncEventType type;
+    std::string message;
+    int current = 0;
+    int total = 0;
+};
+
+class SyncEngine {
+private:
+    static SyncEngine* s_instance;
+    std::map<int, std::function<void(const SyncEvent&)>> m_listeners;
+    int m_nextListenerId = 1;
+    // Each running operation, from Started until Completed or Failed
+    struct OperationTrace {
+        std::unique_ptr<bettersave::core::TraceSpan> span;
+        std::chrono::steady_clock::time_point start;
+        // Transferred byte counter at the start, for the operation's MB/s
+        int64_t startBytes = 0;
+    };
+    std::map<SyncOperation, OperationTrace> m_operationTraces;
+
+    // Uploads, restores, downloads and snapshots run one at a time in request order, so an
+    // auto-backup can't race a manual upload or a restore into the same files and chunk paths.
+    // A request that would only redo the running or a queued operation joins it instead.
+    struct PendingOperation {
+        SyncOperation operation = SyncOperation::Upload;
+        bool onlyChanged = true;
+        // downloadTo's folder, empty for restore
+        std::filesystem::path targetDir;
+        // Save file signatures a running upload read
+        std::optional<std::pair<FileSignature, FileSignature>> readSignatures;
+        // Everyone who asked for it
+        std::vector<std::function<void(bool, const std::string&)>> callbacks;
+        // Shared by everyone who joined, pausing or cancelling affects them all
+        bettersave::core::CancellationTokenPtr token = std::make_shared<bettersave::core::CancellationToken>();
+        // Paused because a level started rather than by the user, resumed once gameplay stops
+        bool pausedForGameplay = false;
+    };
+    std::optional<PendingOperation> m_current;
+    // Set while an operation runs, see onGameplayChanged
+    int m_gameplayListenerId = 0;
+    std::deque<PendingOperation> m_queue;
+    // Fed by every database request, picks each upload's chunk size
+    bettersave::core::ChunkSizer m_chunkSizer;
+
+    void schedule(PendingOperation request);
+    bool tryJoin(PendingOperation& target, const PendingOperation& request, bool running);
+    void startNext();
+    void finishCurrent(bool success, const std::string& message);
+    // Holds the running operation while a level is played: requests already sent finish, nothing
+    // new is sent or started until gameplay stops
+    void onGameplayChanged(bool active);
+
+    void traceOperation(SyncOperation operation, SyncEventType type);
+    void emit(SyncOperation operation, SyncEventType type, const std::string& message, int current = 0, int total = 0);
+    void fail(SyncOperation operation, const std::string& message, std::function<void(bool, const std::string&)> onComplete);
+
+    using TokenPtr = bettersave::core::CancellationTokenPtr;
+    // Coroutines started by startNext(), each reports its own outcome through emit() and onComplete.
+    // Parameters are taken by value, the frames outlive the callers' arguments.
+    bettersave::core::Task<void> runUpload(bool onlyChanged, TokenPtr token, std::function<void(bool, const std::string&)> onComplete);
+    bettersave::core::Task<void> runRestore(TokenPtr token, std::function<void(bool, const std::string&)> onComplete);
+    bettersave::core::Task<void> runDownloadTo(std::filesystem::path targetDir, TokenPtr token, std::function<void(bool, const std::string&)> onComplete);
+    void runSnapshot(std::function<void(bool, const std::string&)> onComplete);
+
+    // Shared by the chunk tasks of one upload or download, defined in SyncEngine.cpp
+    struct UploadContext;
+    struct DownloadContext;
+    struct CloudSave {
+        std::string gmData;
+        std::string llData;
+        bettersave::core::SaveManifest manifest;
+    };
+
+    // Marks the chunk done in the upload journal once the server has it
+    bettersave::core::Task<void> uploadChunk(std::shared_ptr<UploadContext> context, std::string prefix, size_t index);
+    // A chunk or a CCGameManager.dat node, label names it in logs and errors
+    bettersave::core::Task<std::string> downloadChunk(std::shared_ptr<DownloadContext> context, std::string key, std::string label);
+    // Index pages go up once every chunk is there, and come down before the chunks
+    bettersave::core::Task<void> uploadPage(std::shared_ptr<UploadContext> context, std::string prefix, size_t index);
+    bettersave::core::Task<bettersave::core::IndexPage> downloadPage(std::shared_ptr<DownloadContext> context, std::string generation,
+                                                                     std::string prefix, size_t index,
+                                                                     size_t entryLength = bettersave::core::CHECKSUM_LENGTH);
+    // Node ids of a CCGameManager.dat stored key by key, from its index pages under generation
+    bettersave::core::Task<std::vector<std::string>> fetchKeyIndex(std::shared_ptr<DownloadContext> context, std::string generation,
+                                                                   int nodes, int pages);
+    // Removes keys the committed save no longer points at (old generations, nodes), one request per
+    // parent path. what names them in the log.
+    bettersave::core::Task<void> removeKeys(std::vector<std::string> keys, std::string what);
+    // Removes the nodes among ids that the cloud's index doesn't list. Nodes are shared by every
+    // generation, so the index is read again first: another device may have committed since.
+    bettersave::core::Task<void> removeUnlistedNodes(std::string userId, std::vector<std::string> ids);
+    // Both files, decoded and checked against the cloud manifest's checksums
+    bettersave::core::Task<CloudSave> downloadCloudSave(TokenPtr token);
+
+public:
+    static SyncEngine* get() {
+        if (!s_instance) {
+            s_instance = new SyncEngine();
+        }
+        return s_instance;
+    }
+
+    // Events are always delivered on the main thread
+    int addListener(std::function<void(const SyncEvent&)> listener);
+    void removeListener(int listenerId);
+
+    // Upload, restore, downloadTo and snapshot wait for the running one of them to finish.
+    // Upload the local save. onlyChanged skips files matching the last committed manifest.
+    void upload(bool onlyChanged, std::function<void(bool success, const std::string& message)> onComplete = nullptr);
+
+    // Download the cloud save over the local one (snapshotting it first) and reload it into the game
+    void restore(std::function<void(bool success, const std::string& message)> onComplete = nullptr);
+
+    // Download the cloud save into a folder without touching the local save
+    void downloadTo(const std::filesystem::path& targetDir,
+                    std::function<void(bool success, const std::string& message)> onComplete = nullptr);
+
+    // Pause, resume or cancel the running upload or download (cancel also drops a queued one).
+    // Requests already sent are allowed to finish, nothing new is sent while paused. A cancelled
+    // upload keeps its journal, the next upload of the same save skips the chunks already sent.
+    // False if there is no such operation.
+    bool pause(SyncOperation operation);
+    bool resume(SyncOperation operation);
+    bool cancel(SyncOperation operation);
+    bool isPaused(SyncOperation operation) const;
+    // Chunks of the last unfinished upload that already reached the server
+    static std::filesystem::path getJournalPath();
+    // Block signature of a file's ("gm" or "ll") last whole upload or download. A changed file is
+    // uploaded as a patch against it while the cloud still has that version.
+    static std::filesystem::path getSignaturePath(const std::string& prefix);
+
+    // The cloud's manifest, sent through the shared database throttle. nullopt if there is no cloud
+    // save yet. Throws if the request fails.
+    bettersave::core::Task<std::optional<bettersave::core::SaveManifest>> fetchCloudManifest();
+
+    // Check every local save file, progress is reported per file
+    void verify(std::function<void(const IntegrityScanSummary&)> onComplete = nullptr);
+
+    // Copy the local save files to bettersave_snapshots/<timestamp>, keeping the newest few
+    void snapshot(std::function<void(bool success, const std::string& message)> onComplete = nullptr);
+    static std::optional<std::filesystem::path> snapshotLocalSaves();
+
+    // Chrome trace of the recent operations (open in Perfetto) and the metrics registry as JSON,
+    // both rewritten after each operation finishes
+    static std::filesystem::path getTracePath();
+    static std::filesystem::path getMetricsPath();
+    static void exportDiagnostics();
+};
@@ -0,0 +1,363 @@
+/**
+ * BetterSave - Benchmarks
+ * Hot paths of the save pipeline over synthetic saves, reported as JSON.
+ * With zlib, the gd_*, edited_reupload and delta_reupload cases run on generated saves in the real GD format.
+ * Created by: sidastuff
+ */
+
+#include "core/Codec.hpp"
+#include "core/Delta.hpp"
+#include "core/Integrity.hpp"
+#include "core/Manifest.hpp"
+#include "core/MpscRing.hpp"
+#include "core/Transfer.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef BETTERSAVE_BENCH_ZLIB
+    #include "synth/GdFormat.hpp"
+    #include "synth/SaveGenerator.hpp"
+    #include <map>
+    #include <zlib.h>
+#endif
+
+using namespace bettersave::core;
+
+// Allocation counting: every operator new in the process goes through these
+static std::atomic<uint64_t> g_allocCount{0};
+static std::atomic<uint64_t> g_allocBytes{0};
+
+// Kept out of line so GCC doesn't pair the inlined delete's free() with the new expression at the
+// call site and warn about a mismatch (-Wmismatched-new-delete)
+[[gnu::noinline]] static void* countedAlloc(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] static void countedFree(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+namespace {
+
+constexpr size_t MB = 1024 * 1024;
+
+// Resets the kernel's peak RSS counter (Linux 4.0+), so each benchmark reports its own peak
+void resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs.is_open()) clearRefs << "5";
+}
+
+double peakRssMb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+        }
+    }
+    return 0;
+}
+
+// Stand-in for a save file on disk: base64 text XOR'd with 11, like GD writes it
+std::string syntheticSave(size_t size) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::mt19937_64 rng(size);
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t bits = rng();
+        for (size_t j = 0; j < 8 && i + j < size; j++) {
+            data[i + j] = static_cast<char>(alphabet[(bits >> (j * 6)) & 63] ^ 11);
+        }
+    }
+    return data;
+}
+
+std::vector<std::string> framedChunks(const std::string& save) {
+    std::vector<std::string> bodies;
+    for (const auto& chunk : splitChunks(hexEncode(save))) {
+        bodies.push_back(frameChunk(chunk));
+    }
+    return bodies;
+}
+
+// Wraps a benchmark body with allocation and peak RSS counters. bytesPerIteration drives MB/s.
+template <class Body>
+void measure(benchmark::State& state, size_t bytesPerIteration, Body&& body) {
+    resetPeakRss();
+    uint64_t allocsBefore = g_allocCount.load();
+    uint64_t bytesBefore = g_allocBytes.load();
+
+    for (auto _ : state) {
+        body();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytesPerIteration));
+    state.counters["allocs_per_iter"] = benchmark::Counter(
+        static_cast<double>(g_allocCount.load() - allocsBefore), benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes_per_iter"] = benchmark::Counter(
+        static_cast<double>(g_allocBytes.load() - bytesBefore), benchmark::Counter::kAvgIterations);
+    state.counters["peak_rss_mb"] = peakRssMb();
+}
+
+void BM_HexEncode(benchmark::State& state) {
+    auto save = syntheticSave(state.range(0) * MB);
+    measure(state, save.size(), [&] {
+        benchmark::DoNotOptimize(hexEncode(save));
+    });
+}
+
+void BM_HexDecode(benchmark::State& state) {
+    auto hex = hexEncode(syntheticSave(state.range(0) * MB));
+    measure(state, hex.size(), [&] {
+        benchmark::DoNotOptimize(hexDecode(hex));
+    });
+}
+
+void BM_SplitChunks(benchmark::State& state) {
+    auto hex = hexEncode(syntheticSave(state.range(0) * MB));
+    measure(state, hex.size(), [&] {
+        benchmark::DoNotOptimize(splitChunks(hex));
+    });
+}
+
+void BM_Checksum(benchmark::State& state) {
+    auto save = syntheticSave(state.range(0) * MB);
+    measure(state, save.size(), [&] {
+        benchmark::DoNotOptimize(checksumHex(save));
+    });
+}
+
+void BM_FrameChunks(benchmark::State& state) {
+    auto chunks = splitChunks(hexEncode(syntheticSave(state.range(0) * MB)));
+    size_t total = 0;
+    for (const auto& chunk : chunks) total += chunk.size();
+    measure(state, total, [&] {
+        for (const auto& chunk : chunks) {
+            benchmark::DoNotOptimize(frameChunk(chunk));
+        }
+    });
+}
+
+void BM_ParseChunks(benchmark::State& state) {
+    auto bodies = framedChunks(syntheticSave(state.range(0) * MB));
+    size_t total = 0;
+    for (const auto& body : bodies) total += body.size();
+    measure(state, total, [&] {
+        for (const auto& body : bodies) {
+            benchmark::DoNotOptimize(unframeChunk(body));
+        }
+    });
+}
+
+// Full upload side: hex, split and frame both files
+void BM_PlanUpload(benchmark::State& state) {
+    SavePayload gameManager;
+    gameManager.data = syntheticSave(state.range(0) * MB);
+    SavePayload localLevels;
+    localLevels.data = syntheticSave(state.range(0) * MB / 4);
+    measure(state, gameManager.data.size() + localLevels.data.size(), [&] {
+        benchmark::DoNotOptimize(planUpload("bench", newGeneration(), gameManager, localLevels, 0));
+    });
+}
+
+// Full download side: unframe, join and hex-decode
+void BM_Reassemble(benchmark::State& state) {
+    auto size = state.range(0) * MB;
+    auto bodies = framedChunks(syntheticSave(size));
+    measure(state, size, [&] {
+        benchmark::DoNotOptimize(decodeChunks(bodies));
+    });
+}
+
+// One log-sized entry through the logger's queue: the cost a log call pays on the caller's thread
+void BM_RingPushPop(benchmark::State& state) {
+    MpscRing<std::string> ring(4096);
+    std::string message(80, 'x');
+    std::string out;
+    measure(state, message.size(), [&] {
+        ring.tryPush(std::string(message));
+        ring.tryPop(out);
+        benchmark::DoNotOptimize(out);
+    });
+}
+
+#ifdef BETTERSAVE_BENCH_ZLIB
+void BM_Compress(benchmark::State& state) {
+    auto save = syntheticSave(state.range(0) * MB);
+    std::string out(compressBound(save.size()), '\0');
+    measure(state, save.size(), [&] {
+        uLongf outSize = out.size();
+        compress2(reinterpret_cast<Bytef*>(out.data()), &outSize,
+                  reinterpret_cast<const Bytef*>(save.data()), save.size(), Z_DEFAULT_COMPRESSION);
+        benchmark::DoNotOptimize(outSize);
+    });
+}
+
+void BM_Decompress(benchmark::State& state) {
+    auto save = syntheticSave(state.range(0) * MB);
+    std::string compressed(compressBound(save.size()), '\0');
+    uLongf compressedSize = compressed.size();
+    compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize,
+              reinterpret_cast<const Bytef*>(save.data()), save.size(), Z_DEFAULT_COMPRESSION);
+    std::string out(save.size(), '\0');
+    measure(state, save.size(), [&] {
+        uLongf outSize = out.size();
+        uncompress(reinterpret_cast<Bytef*>(out.data()), &outSize,
+                   reinterpret_cast<const Bytef*>(compressed.data()), compressedSize);
+        benchmark::DoNotOptimize(outSize);
+    });
+}
+
+// Realistic CCLocalLevels.dat of about sizeMb, plus the same save after one edit session.
+// Generated once per size since building the larger ones takes a while.
+struct GdDataset {
+    std::string original;
+    std::string edited;
+};
+
+const GdDataset& gdDataset(int64_t sizeMb) {
+    static std::map<int64_t, GdDataset> datasets;
+    auto it = datasets.find(sizeMb);
+    if (it != datasets.end()) return it->second;
+
+    bettersave::synth::GeneratorConfig config;
+    config.seed = static_cast<uint64_t>(sizeMb);
+    config.levelCount = 1;
+    config.targetLocalLevelsBytes = sizeMb * MB;
+    auto model = bettersave::synth::generateSave(config);
+
+    GdDataset dataset;
+    dataset.original = bettersave::synth::renderLocalLevels(model);
+    bettersave::synth::applyEdits(model, bettersave::synth::EditConfig{});
+    dataset.edited = bettersave::synth::renderLocalLevels(model);
+    return datasets.emplace(sizeMb, std::move(dataset)).first->second;
+}
+
+// XOR, base64 and gunzip a real-format save down to its plist
+void BM_GdDecode(benchmark::State& state) {
+    const auto& save = gdDataset(state.range(0)).original;
+    measure(state, save.size(), [&] {
+        benchmark::DoNotOptimize(bettersave::synth::decodeSaveFile(save));
+    });
+}
+
+void BM_GdEncode(benchmark::State& state) {
+    auto plist = *bettersave::synth::decodeSaveFile(gdDataset(state.range(0)).original);
+    measure(state, plist.size(), [&] {
+        benchmark::DoNotOptimize(bettersave::synth::encodeSaveFile(plist));
+    });
+}
+
+// Upload plan for an edited save, reporting how many chunks match the previous version's
+void BM_EditedReupload(benchmark::State& state) {
+    const auto& dataset = gdDataset(state.range(0));
+    auto previous = splitChunks(hexEncode(dataset.original));
+    SavePayload gameManager;
+    gameManager.unchanged = true;
+    SavePayload localLevels;
+    localLevels.data = dataset.edited;
+
+    size_t reused = 0;
+    size_t total = 0;
+    measure(state, dataset.edited.size(), [&] {
+        auto plan = planUpload("bench", newGeneration(), gameManager, localLevels, 0);
+        reused = 0;
+        total = plan.llChunks.size();
+        for (size_t i = 0; i < plan.llChunks.size() && i < previous.size(); i++) {
+            if (plan.llChunks[i].body == frameChunk(previous[i])) reused++;
+        }
+    });
+    state.counters["reused_chunk_ratio"] = total ? static_cast<double>(reused) / total : 0;
+}
+
+// Patch of an edited save against the previous version's signature, reporting its share of the file
+void BM_DeltaReupload(benchmark::State& state) {
+    const auto& dataset = gdDataset(state.range(0));
+    auto signature = computeSignature(dataset.original, checksumHex(dataset.original));
+
+    size_t patchSize = 0;
+    measure(state, dataset.edited.size(), [&] {
+        auto patch = computePatch(signature, dataset.edited);
+        patchSize = patch.size();
+        benchmark::DoNotOptimize(patch);
+    });
+    state.counters["patch_ratio"] = static_cast<double>(patchSize) / dataset.edited.size();
+}
+#endif
+
+}
+
+int main(int argc, char** argv) {
+    // --max-size-mb=N caps the synthetic save sizes (the largest cases need a few GB of RAM)
+    int64_t maxSizeMb = 500;
+    bool hasFormat = false;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+        if (std::strncmp(argv[i], "--max-size-mb=", 14) == 0) {
+            maxSizeMb = std::strtoll(argv[i] + 14, nullptr, 10);
+            continue;
+        }
+        if (std::strncmp(argv[i], "--benchmark_format=", 19) == 0) hasFormat = true;
+        args.push_back(argv[i]);
+    }
+
+    // JSON by default so runs can be diffed
+    static char jsonFormat[] = "--benchmark_format=json";
+    if (!hasFormat) args.push_back(jsonFormat);
+
+    std::vector<std::pair<const char*, void (*)(benchmark::State&)>> cases = {
+        {"hex_encode", BM_HexEncode},
+        {"hex_decode", BM_HexDecode},
+        {"split_chunks", BM_SplitChunks},
+        {"checksum", BM_Checksum},
+        {"frame_chunks", BM_FrameChunks},
+        {"parse_chunks", BM_ParseChunks},
+        {"plan_upload", BM_PlanUpload},
+        {"reassemble", BM_Reassemble},
+#ifdef BETTERSAVE_BENCH_ZLIB
+        {"compress", BM_Compress},
+        {"decompress", BM_Decompress},
+        {"gd_decode", BM_GdDecode},
+        {"gd_encode", BM_GdEncode},
+        {"edited_reupload", BM_EditedReupload},
+        {"delta_reupload", BM_DeltaReupload},
+#endif
+    };
+
+    for (const auto& [name, function] : cases) {
+        auto* bench = benchmark::RegisterBenchmark(name, function)->Unit(benchmark::kMillisecond)->UseRealTime();
+        for (int64_t sizeMb : {1, 10, 100, 500}) {
+            if (sizeMb <= maxSizeMb) bench->Arg(sizeMb);
+        }
+    }
+
+    benchmark::RegisterBenchmark("ring_push_pop", BM_RingPushPop);
+
+    int argCount = static_cast<int>(args.size());
+    benchmark::Initialize(&argCount, args.data());
+    if (benchmark::ReportUnrecognizedArguments(argCount, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
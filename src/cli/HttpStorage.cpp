@@ -0,0 +1,230 @@
+/**
+ * BetterSave - HTTP Storage
+ * Created by: sidastuff
+ */
+
+#include "HttpStorage.hpp"
+#include "core/Metrics.hpp"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace bettersave::cli {
+
+// One request at a time, so only the pause and the rate matter. Without Retry-After the pause
+// starts at the 100ms the fixed backoff used to.
+static bettersave::core::ThrottleConfig cliThrottleConfig() {
+    bettersave::core::ThrottleConfig config;
+    config.maxConcurrency = 1;
+    config.baseBackoff = std::chrono::milliseconds(100);
+    return config;
+}
+
+HttpStorage::HttpStorage(const std::string& url, std::string authToken)
+    : m_authToken(std::move(authToken)), m_throttle(cliThrottleConfig()) {
+    if (!isUrl(url)) {
+        throw std::invalid_argument("Only http:// URLs are supported: " + url);
+    }
+
+    std::string rest = url.substr(7);
+    size_t slash = rest.find('/');
+    std::string hostPort = rest.substr(0, slash);
+    m_basePath = slash == std::string::npos ? "" : rest.substr(slash);
+    while (!m_basePath.empty() && m_basePath.back() == '/') m_basePath.pop_back();
+
+    size_t colon = hostPort.rfind(':');
+    m_host = hostPort.substr(0, colon);
+    if (colon != std::string::npos) {
+        m_port = std::atoi(hostPort.c_str() + colon + 1);
+    }
+}
+
+HttpStorage::~HttpStorage() {
+    disconnect();
+}
+
+bool HttpStorage::isUrl(const std::string& location) {
+    return location.rfind("http://", 0) == 0;
+}
+
+bool HttpStorage::connect() {
+    if (m_socket >= 0) return true;
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    if (::getaddrinfo(m_host.c_str(), std::to_string(m_port).c_str(), &hints, &results) != 0) {
+        return false;
+    }
+
+    for (addrinfo* entry = results; entry; entry = entry->ai_next) {
+        int fd = ::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, entry->ai_addr, entry->ai_addrlen) == 0) {
+            int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            m_socket = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    ::freeaddrinfo(results);
+    return m_socket >= 0;
+}
+
+void HttpStorage::disconnect() {
+    if (m_socket >= 0) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+int HttpStorage::sendOnce(const std::string& method, const std::string& target, const std::string& body,
+                          std::string& responseBody) {
+    if (!connect()) return 0;
+
+    std::string request = method + " " + target + " HTTP/1.1\r\n";
+    request += "Host: " + m_host + ":" + std::to_string(m_port) + "\r\n";
+    request += "Content-Type: application/json\r\n";
+    request += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    request += "Connection: keep-alive\r\n\r\n";
+    request += body;
+
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t written = ::send(m_socket, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            disconnect();
+            return 0;
+        }
+        sent += written;
+    }
+    m_stats.bytesSent += request.size();
+
+    m_retryAfter.reset();
+    std::string buffer;
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        char chunk[16384];
+        ssize_t received = ::recv(m_socket, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            disconnect();
+            return 0;
+        }
+        buffer.append(chunk, received);
+    }
+
+    std::string head = buffer.substr(0, headerEnd);
+    int status = std::atoi(head.c_str() + head.find(' ') + 1);
+
+    size_t contentLength = 0;
+    bool closeAfter = false;
+    size_t position = head.find("\r\n");
+    while (position != std::string::npos && position < head.size()) {
+        size_t end = head.find("\r\n", position + 2);
+        std::string line = head.substr(position + 2, end == std::string::npos ? std::string::npos : end - position - 2);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            std::string name = line.substr(0, colon);
+            for (auto& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            size_t valueStart = line.find_first_not_of(' ', colon + 1);
+            std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+            if (name == "content-length") contentLength = std::strtoull(value.c_str(), nullptr, 10);
+            if (name == "connection" && value == "close") closeAfter = true;
+            if (name == "retry-after") m_retryAfter = bettersave::core::AdaptiveThrottle::parseRetryAfter(value);
+        }
+        position = end;
+    }
+
+    responseBody = buffer.substr(headerEnd + 4);
+    while (responseBody.size() < contentLength) {
+        char chunk[65536];
+        ssize_t received = ::recv(m_socket, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            disconnect();
+            return 0;
+        }
+        responseBody.append(chunk, received);
+    }
+    m_stats.bytesReceived += headerEnd + 4 + responseBody.size();
+
+    if (closeAfter) disconnect();
+    return status;
+}
+
+int HttpStorage::send(const std::string& method, const std::string& key, const std::string& body,
+                      std::string& responseBody) {
+    std::string target = m_basePath + "/" + key + ".json";
+    std::string query;
+    if (!m_authToken.empty()) query += "auth=" + m_authToken;
+    if (method != "GET") query += std::string(query.empty() ? "" : "&") + "print=silent";
+    if (!query.empty()) target += "?" + query;
+
+    auto* metrics = bettersave::core::MetricsRegistry::get();
+    int status = 0;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        if (attempt > 0) {
+            m_stats.retries++;
+            metrics->counter("requests.retried").add();
+        }
+        std::this_thread::sleep_for(m_throttle.timeUntilResume());
+        if (m_rateLimit) {
+            std::this_thread::sleep_for(m_rateLimit->timeUntilAllowed());
+            m_rateLimit->tryAcquire();
+        }
+        m_stats.requests++;
+        metrics->counter("requests").add();
+
+        auto sentAt = std::chrono::steady_clock::now();
+        status = sendOnce(method, target, body, responseBody);
+        auto signal = m_throttle.onResponse(status, std::chrono::steady_clock::now() - sentAt, body.size() + responseBody.size(),
+                                          m_retryAfter);
+        if (m_rateLimit) {
+            m_rateLimit->setPolicy({m_throttle.rate(), m_rateLimit->policy().burst});
+            metrics->gauge("throttle.database.rate").set(m_throttle.rate());
+        }
+        if (signal != bettersave::core::AdaptiveThrottle::Signal::Throttled) break;
+        metrics->counter("requests.throttled").add();
+    }
+    if (status < 200 || status >= 300) {
+        metrics->counter("requests.failed").add();
+    }
+    return status;
+}
+
+void HttpStorage::setRateLimit(bettersave::core::RatePolicy policy) {
+    auto config = cliThrottleConfig();
+    config.maxRate = policy.ratePerSecond;
+    config.minRate = std::min(config.minRate, policy.ratePerSecond);
+    m_throttle = bettersave::core::AdaptiveThrottle(config);
+    m_rateLimit.emplace(policy);
+}
+
+bool HttpStorage::put(const std::string& key, const std::string& body) {
+    std::string response;
+    int status = send("PUT", key, body, response);
+    return status >= 200 && status < 300;
+}
+
+std::optional<std::string> HttpStorage::get(const std::string& key) {
+    std::string response;
+    int status = send("GET", key, "", response);
+    if (status != 200 || response == "null") return std::nullopt;
+    return response;
+}
+
+bool HttpStorage::remove(const std::string& key) {
+    std::string response;
+    int status = send("DELETE", key, "", response);
+    return status >= 200 && status < 300;
+}
+
+}
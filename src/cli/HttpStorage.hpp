@@ -0,0 +1,64 @@
+/**
+ * BetterSave - HTTP Storage
+ * Storage backend speaking the Realtime Database REST API over plain HTTP (dev server / emulator)
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "core/AdaptiveThrottle.hpp"
+#include "core/Storage.hpp"
+#include "core/TokenBucket.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace bettersave::cli {
+
+struct HttpStats {
+    int requests = 0;
+    int retries = 0;
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+};
+
+class HttpStorage : public bettersave::core::Storage {
+private:
+    std::string m_host;
+    int m_port = 80;
+    std::string m_basePath;
+    std::string m_authToken;
+    int m_socket = -1;
+    HttpStats m_stats;
+    // Requests (retries included) wait for the bucket when a rate limit is set
+    std::optional<bettersave::core::TokenBucket> m_rateLimit;
+    // Pauses after 429/503 (as long as Retry-After asks) and steers the bucket's rate
+    bettersave::core::AdaptiveThrottle m_throttle;
+    // Retry-After of the last response, if it had one
+    std::optional<bettersave::core::AdaptiveThrottle::Clock::duration> m_retryAfter;
+
+    static constexpr int MAX_ATTEMPTS = 8;
+
+    bool connect();
+    void disconnect();
+    // One attempt; status is 0 if the connection failed or was dropped
+    int sendOnce(const std::string& method, const std::string& target, const std::string& body, std::string& responseBody);
+    // Retries dropped connections, 429 and 503 once the throttle allows it
+    int send(const std::string& method, const std::string& key, const std::string& body, std::string& responseBody);
+
+public:
+    // url: http://host[:port][/base], e.g. http://127.0.0.1:9000
+    HttpStorage(const std::string& url, std::string authToken);
+    ~HttpStorage() override;
+
+    static bool isUrl(const std::string& location);
+
+    bool put(const std::string& key, const std::string& body) override;
+    std::optional<std::string> get(const std::string& key) override;
+    bool remove(const std::string& key) override;
+
+    const HttpStats& stats() const { return m_stats; }
+    // The policy is the ceiling, the throttle lowers the rate while the server pushes back
+    void setRateLimit(bettersave::core::RatePolicy policy);
+};
+
+}
@@ -0,0 +1,347 @@
+/**
+ * BetterSave - Command Line Interface
+ * Back up, restore and verify Geometry Dash save directories without the game
+ * Created by: sidastuff
+ */
+
+#include "core/Integrity.hpp"
+#include "core/Metrics.hpp"
+#include "core/SaveFiles.hpp"
+#include "core/Storage.hpp"
+#include "core/Trace.hpp"
+#include "core/Transfer.hpp"
+#ifdef BETTERSAVE_CLI_HTTP
+#include "HttpStorage.hpp"
+#endif
+#ifdef BETTERSAVE_CLI_ZLIB
+#include "synth/GdFormat.hpp"
+#endif
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bettersave::core;
+
+namespace {
+
+// Ctrl+C cancels the transfer between chunks; a second one kills the process as usual
+std::atomic<bool> s_interrupted{false};
+CancellationToken s_cancel;
+
+void onInterrupt(int) {
+    s_interrupted.store(true);
+    std::signal(SIGINT, SIG_DFL);
+}
+
+// The token takes a lock, which a signal handler must not, so a watcher forwards the signal
+void watchForInterrupt() {
+    std::signal(SIGINT, onInterrupt);
+    std::thread([]() {
+        while (!s_interrupted.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        s_cancel.cancel();
+    }).detach();
+}
+
+struct Options {
+    std::vector<std::string> positional;
+    std::string userId = "local";
+    std::string authToken;
+    double maxRequestsPerSecond = 0;
+    std::string tracePath;
+    std::string metricsPath;
+    bool onlyChanged = false;
+    bool delta = false;
+    bool keys = false;
+    bool snapshot = true;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage:\n"
+        "  bettersave-cli backup <save-dir> <store-dir> [--user <id>] [--only-changed] [--delta] [--keys]\n"
+        "  bettersave-cli restore <store-dir> <save-dir> [--user <id>] [--no-snapshot]\n"
+        "  bettersave-cli verify <save-dir>\n"
+        "  bettersave-cli check <store-dir> [--user <id>]\n"
+        "  (backup, restore and check also take --auth <token>, and --max-rps <n> to pace HTTP requests)\n"
+        "  (any command takes --trace <file> to write a Chrome trace of where the time went,\n"
+        "   and --metrics <file> for request latency percentiles, throughput and totals as JSON)\n"
+        "\n"
+        "<store-dir> mirrors the cloud database layout (users/<id>/saveData.json,\n"
+        "users/<id>/generations/<g>/pages/*.json, users/<id>/generations/<g>/chunks/*.json).\n"
+        "It can also be an http:// database URL such as the dev server's, with --auth <token> if it needs one.\n"
+        "With --delta, a changed file is uploaded as a patch against its last whole upload, whose block\n"
+        "signature is kept in <save-dir>/bettersave_signatures.\n"
+        "With --keys, a changed CCGameManager.dat is stored key by key (users/<id>/keys/*.json) and only\n"
+        "the keys the store doesn't have are written. Needs a build with zlib, as does restoring such a save.\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--user") {
+            if (i + 1 >= argc) return false;
+            options.userId = argv[++i];
+        } else if (arg == "--auth") {
+            if (i + 1 >= argc) return false;
+            options.authToken = argv[++i];
+        } else if (arg == "--max-rps") {
+            if (i + 1 >= argc) return false;
+            options.maxRequestsPerSecond = std::atof(argv[++i]);
+        } else if (arg == "--trace") {
+            if (i + 1 >= argc) return false;
+            options.tracePath = argv[++i];
+        } else if (arg == "--metrics") {
+            if (i + 1 >= argc) return false;
+            options.metricsPath = argv[++i];
+        } else if (arg == "--only-changed") {
+            options.onlyChanged = true;
+        } else if (arg == "--delta") {
+            options.delta = true;
+        } else if (arg == "--keys") {
+            options.keys = true;
+        } else if (arg == "--no-snapshot") {
+            options.snapshot = false;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        } else {
+            options.positional.push_back(arg);
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<Storage> makeStorage(const std::string& location, const Options& options) {
+#ifdef BETTERSAVE_CLI_HTTP
+    if (bettersave::cli::HttpStorage::isUrl(location)) {
+        auto storage = std::make_unique<bettersave::cli::HttpStorage>(location, options.authToken);
+        if (options.maxRequestsPerSecond > 0) {
+            // A short burst, then steady pacing
+            storage->setRateLimit({options.maxRequestsPerSecond, 4});
+        }
+        return storage;
+    }
+#endif
+    return std::make_unique<DirectoryStorage>(location);
+}
+
+// GD's own save file layers, nullptr in a build without zlib
+const SaveFileCodec* saveFileCodec() {
+#ifdef BETTERSAVE_CLI_ZLIB
+    static const SaveFileCodec codec{
+        [](const std::string& file) { return bettersave::synth::decodeSaveFile(file); },
+        [](const std::string& plist) { return bettersave::synth::encodeSaveFile(plist); },
+    };
+    return &codec;
+#else
+    return nullptr;
+#endif
+}
+
+// Throughput and, for HTTP stores, request counts
+void printTransferStats(const Storage& storage, size_t bytes, std::chrono::steady_clock::time_point start) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = bytes / (1024.0 * 1024.0);
+    std::cout << "  " << megabytes << " MB in " << seconds << " s";
+    if (seconds > 0) std::cout << " (" << megabytes / seconds << " MB/s)";
+    std::cout << "\n";
+
+#ifdef BETTERSAVE_CLI_HTTP
+    if (auto http = dynamic_cast<const bettersave::cli::HttpStorage*>(&storage)) {
+        const auto& stats = http->stats();
+        std::cout << "  " << stats.requests << " requests, " << stats.retries << " retries, "
+                  << stats.bytesSent << " bytes sent, " << stats.bytesReceived << " bytes received\n";
+    }
+#endif
+}
+
+int runBackup(const Options& options) {
+    std::filesystem::path saveDir = options.positional[0];
+    auto storage = makeStorage(options.positional[1], options);
+
+    auto gameManager = readFile(saveDir / GAME_MANAGER_FILE);
+    auto localLevels = readFile(saveDir / LOCAL_LEVELS_FILE);
+    if (!gameManager || !localLevels) {
+        std::cerr << "Save files not found in " << saveDir.string() << "\n";
+        return 1;
+    }
+
+    // Same rule as the mod: never replace a good backup with a corrupted save
+    for (const auto& [name, data] : {std::pair{GAME_MANAGER_FILE, &*gameManager}, std::pair{LOCAL_LEVELS_FILE, &*localLevels}}) {
+        auto validation = validateSaveBytes(*data);
+        if (!validation.isValid) {
+            std::cerr << name << " failed the integrity check: " << validation.message << "\n";
+            return 1;
+        }
+    }
+
+    if (options.keys && !saveFileCodec()) {
+        std::cerr << "--keys needs a build with zlib\n";
+        return 2;
+    }
+
+    // A missing or unreadable signature just means that file is uploaded whole
+    auto signatureDir = saveDir / "bettersave_signatures";
+    DeltaBases bases;
+    if (options.delta) {
+        if (auto text = readFile(signatureDir / "CCGameManager.json")) bases.gameManager = parseSignature(*text);
+        if (auto text = readFile(signatureDir / "CCLocalLevels.json")) bases.localLevels = parseSignature(*text);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = backupSave(*storage, options.userId, *gameManager, *localLevels,
+                             static_cast<int64_t>(std::time(nullptr)), options.onlyChanged, &s_cancel,
+                             options.delta ? &bases : nullptr, options.keys ? saveFileCodec() : nullptr);
+    if (!result.success) {
+        std::cerr << "Backup failed: " << result.error << "\n";
+        return result.cancelled ? 130 : 1;
+    }
+
+    if (options.delta) {
+        std::error_code ec;
+        std::filesystem::create_directories(signatureDir, ec);
+        bool saved = !ec;
+        if (saved && bases.gameManager) saved = replaceFile(signatureDir / "CCGameManager.json", serializeSignature(*bases.gameManager));
+        if (saved && bases.localLevels) saved = replaceFile(signatureDir / "CCLocalLevels.json", serializeSignature(*bases.localLevels));
+        if (!saved) std::cerr << "Could not save the block signatures, the next backup uploads whole files\n";
+    }
+
+    std::cout << "Backed up " << saveDir.string() << " (" << result.chunksWritten << " chunks written";
+    if (result.gameManagerUnchanged) std::cout << ", " << GAME_MANAGER_FILE << " unchanged";
+    if (result.localLevelsUnchanged) std::cout << ", " << LOCAL_LEVELS_FILE << " unchanged";
+    if (result.gameManagerPatched) std::cout << ", " << GAME_MANAGER_FILE << " as a patch";
+    if (result.localLevelsPatched) std::cout << ", " << LOCAL_LEVELS_FILE << " as a patch";
+    if (result.gameManagerByKey) {
+        std::cout << ", " << GAME_MANAGER_FILE << " by key (" << result.keyNodesSent << " of "
+                  << result.manifest.gmKeyNodes << " nodes sent)";
+    }
+    std::cout << ")\n";
+    printTransferStats(*storage, gameManager->size() + localLevels->size(), start);
+    return 0;
+}
+
+int runRestore(const Options& options) {
+    auto storage = makeStorage(options.positional[0], options);
+    std::filesystem::path saveDir = options.positional[1];
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = restoreSave(*storage, options.userId, &s_cancel, saveFileCodec());
+    if (!result.success) {
+        std::cerr << "Restore failed: " << result.error << "\n";
+        return result.cancelled ? 130 : 1;
+    }
+
+    try {
+        std::filesystem::create_directories(saveDir);
+        if (options.snapshot) {
+            auto snapshotDir = snapshotSaveFiles(saveDir, saveDir / "bettersave_snapshots", 5);
+            std::cout << "Snapshot of the previous save: " << snapshotDir.string() << "\n";
+        }
+        writeFileSynced(saveDir / GAME_MANAGER_FILE, result.gameManagerData);
+        writeFileSynced(saveDir / LOCAL_LEVELS_FILE, result.localLevelsData);
+    } catch (const std::exception& e) {
+        std::cerr << "Restore failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "Restored " << result.gameManagerData.size() << " + " << result.localLevelsData.size()
+              << " bytes to " << saveDir.string() << "\n";
+    printTransferStats(*storage, result.gameManagerData.size() + result.localLevelsData.size(), start);
+    return 0;
+}
+
+int runVerify(const Options& options) {
+    std::filesystem::path saveDir = options.positional[0];
+    bool primariesValid = true;
+
+    for (const auto& fileName : managedSaveFiles()) {
+        bool isPrimary = fileName == GAME_MANAGER_FILE || fileName == LOCAL_LEVELS_FILE;
+        auto data = readFile(saveDir / fileName);
+        if (!data) {
+            std::cout << fileName << ": not present\n";
+            if (isPrimary) primariesValid = false;
+            continue;
+        }
+
+        auto validation = validateSaveBytes(*data);
+        std::cout << fileName << ": " << (validation.isValid ? "valid" : "INVALID")
+                  << " (" << validation.size << " bytes, checksum " << validation.checksum << ")";
+        if (!validation.isValid) std::cout << " - " << validation.message;
+        std::cout << "\n";
+        if (isPrimary && !validation.isValid) primariesValid = false;
+    }
+
+    return primariesValid ? 0 : 1;
+}
+
+int runCheck(const Options& options) {
+    auto storage = makeStorage(options.positional[0], options);
+    auto result = restoreSave(*storage, options.userId, &s_cancel, saveFileCodec());
+    if (!result.success) {
+        std::cerr << "Stored save is not usable: " << result.error << "\n";
+        return 1;
+    }
+
+    std::cout << "Stored save for " << options.userId << " is intact: ";
+    if (result.manifest.gmKeyNodes > 0) {
+        std::cout << result.manifest.gmKeyNodes << " nodes + ";
+    } else {
+        std::cout << result.manifest.gmChunks + result.manifest.gmPatchChunks << " + ";
+    }
+    std::cout << result.manifest.llChunks + result.manifest.llPatchChunks << " chunks, "
+              << result.gameManagerData.size() << " + " << result.localLevelsData.size() << " bytes\n";
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::string command = argv[1];
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    size_t expected = (command == "backup" || command == "restore") ? 2 : 1;
+    if (options.positional.size() != expected) {
+        printUsage();
+        return 2;
+    }
+
+    Tracer::get()->setEnabled(!options.tracePath.empty());
+    Tracer::get()->setThreadName("main");
+    watchForInterrupt();
+
+    int status;
+    if (command == "backup") status = runBackup(options);
+    else if (command == "restore") status = runRestore(options);
+    else if (command == "verify") status = runVerify(options);
+    else if (command == "check") status = runCheck(options);
+    else {
+        printUsage();
+        return 2;
+    }
+
+    if (!options.tracePath.empty() && !Tracer::get()->exportChromeTrace(options.tracePath)) {
+        std::cerr << "Could not write the trace to " << options.tracePath << "\n";
+    }
+    if (!options.metricsPath.empty() && !MetricsRegistry::get()->exportJson(options.metricsPath)) {
+        std::cerr << "Could not write the metrics to " << options.metricsPath << "\n";
+    }
+    return status;
+}
@@ -0,0 +1,101 @@
+/**
+ * BetterSave - Adaptive Throttle
+ * Created by: sidastuff
+ */
+
+#include "AdaptiveThrottle.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace bettersave::core {
+
+AdaptiveThrottle::AdaptiveThrottle(ThrottleConfig config)
+    : m_config(config), m_rate(config.maxRate), m_concurrency(config.maxConcurrency),
+      m_pausedUntil(Clock::time_point::min()), m_lastDecrease(Clock::time_point::min()),
+      m_lastRecovery(Clock::now()) {}
+
+void AdaptiveThrottle::decrease(double factor, Clock::time_point now) {
+    // A burst of failures from requests sent together is one signal, not many
+    if (m_lastDecrease != Clock::time_point::min() && now - m_lastDecrease < m_config.decreaseHoldoff) {
+        return;
+    }
+    m_rate = std::max(m_config.minRate, m_rate * factor);
+    m_concurrency = std::max(m_config.minConcurrency, static_cast<int>(m_concurrency * factor));
+    m_lastDecrease = now;
+    m_lastRecovery = now;
+}
+
+AdaptiveThrottle::Signal AdaptiveThrottle::onResponse(int status, Clock::duration latency, size_t bytes,
+                                                      std::optional<Clock::duration> retryAfter, Clock::time_point now) {
+    if (isThrottleStatus(status)) {
+        m_consecutiveThrottles++;
+        decrease(m_config.throttleFactor, now);
+
+        Clock::duration pause;
+        if (retryAfter) {
+            pause = *retryAfter;
+        } else {
+            int doublings = std::min(m_consecutiveThrottles - 1, 16);
+            pause = m_config.baseBackoff * (1 << doublings);
+        }
+        pause = std::min<Clock::duration>(pause, m_config.maxPause);
+        m_pausedUntil = std::max(m_pausedUntil, now + pause);
+        return Signal::Throttled;
+    }
+    m_consecutiveThrottles = 0;
+
+    double latencyMs = std::chrono::duration<double, std::milli>(latency).count();
+    bool large = m_config.largeRequestBytes > 0 && bytes >= m_config.largeRequestBytes;
+    if (large) {
+        // A chunk twice the size takes about twice as long, that's not the server slowing down
+        latencyMs *= static_cast<double>(m_config.largeRequestBytes) / static_cast<double>(bytes);
+    }
+    auto& baseline = m_baselines[large ? 1 : 0];
+    bool spike = baseline.samples >= 5 && latencyMs > baseline.averageMs * m_config.latencySpikeRatio;
+    if (spike && ++baseline.spikesInARow < m_config.spikesBeforeRebase) {
+        decrease(m_config.latencyFactor, now);
+        return Signal::LatencySpike;
+    }
+    if (spike) {
+        // Slow for this long, it's no spike anymore. Recovery starts again from the new pace.
+        baseline.samples = 0;
+    }
+    baseline.spikesInARow = 0;
+
+    // Single spikes stay out of the baseline so one slow response can't raise the bar for the next
+    baseline.samples++;
+    double weight = baseline.samples < 10 ? 1.0 / baseline.samples : 0.1;
+    baseline.averageMs += (latencyMs - baseline.averageMs) * weight;
+
+    // Additive increase: one step per quiet interval
+    if ((m_rate < m_config.maxRate || m_concurrency < m_config.maxConcurrency) &&
+        now - m_lastRecovery >= m_config.recoveryInterval) {
+        m_rate = std::min(m_config.maxRate, m_rate + m_config.maxRate * m_config.recoveryStep);
+        m_concurrency = std::min(m_config.maxConcurrency, m_concurrency + 1);
+        m_lastRecovery = now;
+    }
+    return Signal::Ok;
+}
+
+AdaptiveThrottle::Clock::duration AdaptiveThrottle::timeUntilResume(Clock::time_point now) const {
+    return m_pausedUntil > now ? m_pausedUntil - now : Clock::duration::zero();
+}
+
+std::optional<AdaptiveThrottle::Clock::duration> AdaptiveThrottle::parseRetryAfter(const std::string& value) {
+    size_t start = value.find_first_not_of(' ');
+    size_t end = value.find_last_not_of(' ');
+    if (start == std::string::npos) {
+        return std::nullopt;
+    }
+    int64_t seconds = 0;
+    for (size_t i = start; i <= end; i++) {
+        if (!std::isdigit(static_cast<unsigned char>(value[i])) || seconds > 86400) {
+            return std::nullopt;
+        }
+        seconds = seconds * 10 + (value[i] - '0');
+    }
+    return std::chrono::seconds(seconds);
+}
+
+}
@@ -0,0 +1,93 @@
+/**
+ * BetterSave - Adaptive Throttle
+ * Backs request rate and concurrency off when the server pushes back (429/503, latency spikes)
+ * and recovers them gradually once it stops
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace bettersave::core {
+
+struct ThrottleConfig {
+    double maxRate = 100;
+    double minRate = 1;
+    int maxConcurrency = 32;
+    int minConcurrency = 1;
+    // Multiplied into rate and concurrency on a 429/503 or dropped connection
+    double throttleFactor = 0.5;
+    // Gentler cut for a latency spike, the server is slowing down but still answering
+    double latencyFactor = 0.8;
+    // A response this many times slower than the running average counts as a spike
+    double latencySpikeRatio = 3.0;
+    // Requests moving at least this many bytes (chunks, large nodes) are sized to take a second or
+    // more and keep a baseline of their own, in time per this many bytes. Manifest and page
+    // requests answer in a round trip and would otherwise make every chunk look like a spike.
+    size_t largeRequestBytes = 16 * 1024;
+    // This many spikes in a row are how fast the server answers now, the baseline restarts from
+    // them instead of leaving them out for good
+    int spikesBeforeRebase = 5;
+    // Responses already in flight when the server pushed back don't cut again within this
+    std::chrono::milliseconds decreaseHoldoff{500};
+    // Every interval without trouble gives back this share of maxRate and one more slot
+    std::chrono::milliseconds recoveryInterval{1000};
+    double recoveryStep = 0.1;
+    // Pause after a 429/503 without Retry-After, doubled for each one in a row
+    std::chrono::milliseconds baseBackoff{500};
+    std::chrono::seconds maxPause{60};
+};
+
+class AdaptiveThrottle {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Signal {
+        Ok,
+        Throttled,
+        LatencySpike
+    };
+
+private:
+    ThrottleConfig m_config;
+    double m_rate;
+    int m_concurrency;
+    Clock::time_point m_pausedUntil;
+    Clock::time_point m_lastDecrease;
+    Clock::time_point m_lastRecovery;
+    int m_consecutiveThrottles = 0;
+
+    // Running average of healthy response times, the baseline for spikes
+    struct LatencyBaseline {
+        double averageMs = 0;
+        int samples = 0;
+        int spikesInARow = 0;
+    };
+    // Small requests, then large ones
+    LatencyBaseline m_baselines[2];
+
+    void decrease(double factor, Clock::time_point now);
+
+public:
+    explicit AdaptiveThrottle(ThrottleConfig config = {});
+
+    // status 0 means the connection failed or was dropped. bytes is what the request sent and
+    // received, bodies only.
+    Signal onResponse(int status, Clock::duration latency, size_t bytes, std::optional<Clock::duration> retryAfter,
+                      Clock::time_point now = Clock::now());
+
+    double rate() const { return m_rate; }
+    int concurrency() const { return m_concurrency; }
+    const ThrottleConfig& config() const { return m_config; }
+    // Zero unless a 429/503 asked us to stop sending for a while
+    Clock::duration timeUntilResume(Clock::time_point now = Clock::now()) const;
+
+    // Delta-seconds form only; an HTTP-date or garbage gives nullopt and the default backoff is used
+    static std::optional<Clock::duration> parseRetryAfter(const std::string& value);
+    static bool isThrottleStatus(int status) { return status == 0 || status == 429 || status == 503; }
+};
+
+}
@@ -0,0 +1,60 @@
+/**
+ * BetterSave - Cancellation
+ * Created by: sidastuff
+ */
+
+#include "Cancellation.hpp"
+#include <vector>
+
+namespace bettersave::core {
+
+void CancellationToken::setState(State state) {
+    std::vector<std::function<void(State)>> listeners;
+    {
+        std::lock_guard lock(m_mutex);
+        State current = m_state.load(std::memory_order_relaxed);
+        if (current == state || current == State::Cancelled) {
+            return;
+        }
+        m_state.store(state, std::memory_order_release);
+        for (auto& [id, listener] : m_listeners) {
+            listeners.push_back(listener);
+        }
+    }
+    m_changed.notify_all();
+
+    // Outside the lock, listeners may resume or cancel in turn
+    for (auto& listener : listeners) {
+        listener(state);
+    }
+}
+
+void CancellationToken::pause() {
+    setState(State::Paused);
+}
+
+void CancellationToken::resume() {
+    if (isPaused()) {
+        setState(State::Running);
+    }
+}
+
+bool CancellationToken::waitWhilePaused() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [this]() { return m_state.load(std::memory_order_relaxed) != State::Paused; });
+    return m_state.load(std::memory_order_relaxed) != State::Cancelled;
+}
+
+int CancellationToken::addListener(std::function<void(State)> listener) {
+    std::lock_guard lock(m_mutex);
+    int listenerId = m_nextListenerId++;
+    m_listeners[listenerId] = std::move(listener);
+    return listenerId;
+}
+
+void CancellationToken::removeListener(int listenerId) {
+    std::lock_guard lock(m_mutex);
+    m_listeners.erase(listenerId);
+}
+
+}
@@ -0,0 +1,64 @@
+/**
+ * BetterSave - Cancellation
+ * Cooperative cancel and pause for long transfers: stages check the token between units of work
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace bettersave::core {
+
+// Thrown by CPU stages (encoding, decoding) when their token is cancelled
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Operation cancelled") {}
+};
+
+class CancellationToken {
+public:
+    enum class State {
+        Running,
+        Paused,
+        Cancelled
+    };
+
+private:
+    std::atomic<State> m_state{State::Running};
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::map<int, std::function<void(State)>> m_listeners;
+    int m_nextListenerId = 1;
+
+    void setState(State state);
+
+public:
+    // Cancelling is final, pause and resume do nothing afterwards
+    void cancel() { setState(State::Cancelled); }
+    void pause();
+    void resume();
+
+    State state() const { return m_state.load(std::memory_order_acquire); }
+    bool isCancelled() const { return state() == State::Cancelled; }
+    bool isPaused() const { return state() == State::Paused; }
+
+    void throwIfCancelled() const {
+        if (isCancelled()) throw OperationCancelled();
+    }
+    // For worker threads: blocks while paused. False if the token is (or gets) cancelled.
+    bool waitWhilePaused();
+
+    // Called on the thread that changed the state, for code that can't block (the main thread)
+    int addListener(std::function<void(State)> listener);
+    void removeListener(int listenerId);
+};
+
+using CancellationTokenPtr = std::shared_ptr<CancellationToken>;
+
+}
@@ -0,0 +1,65 @@
+/**
+ * BetterSave - Chunk Sizer
+ * Created by: sidastuff
+ */
+
+#include "ChunkSizer.hpp"
+#include "Codec.hpp"
+#include <algorithm>
+
+namespace bettersave::core {
+
+// Sizes are rounded down to a multiple of this, which also keeps them even
+static constexpr size_t CHUNK_SIZE_STEP = 1000;
+
+// Plain average over the first samples so the first one doesn't stick, then exponential
+static void addSample(double& average, int& samples, double value) {
+    samples++;
+    double weight = samples < 10 ? 1.0 / samples : 0.1;
+    average += (value - average) * weight;
+}
+
+ChunkSizer::ChunkSizer(ChunkSizingConfig config) : m_config(config) {}
+
+void ChunkSizer::onTransfer(size_t bytes, Clock::duration latency, int resends) {
+    for (int i = 0; i < resends; i++) {
+        addSample(m_resendRate, m_attemptSamples, 1.0);
+    }
+    addSample(m_resendRate, m_attemptSamples, 0.0);
+
+    double latencyMs = std::chrono::duration<double, std::milli>(latency).count();
+    if (bytes <= m_config.smallRequestBytes) {
+        addSample(m_roundTripMs, m_roundTripSamples, latencyMs);
+        return;
+    }
+
+    // Whatever the round trip doesn't explain went to moving the body. A noisy round trip
+    // estimate must not turn a slow request into an instant one.
+    double transferMs = std::max(latencyMs - m_roundTripMs, latencyMs * 0.1);
+    if (transferMs <= 0) {
+        return;
+    }
+    addSample(m_bytesPerSecond, m_bandwidthSamples, static_cast<double>(bytes) / (transferMs / 1000.0));
+}
+
+size_t ChunkSizer::chooseChunkSize(size_t encodedSize) const {
+    double size = static_cast<double>(DEFAULT_CHUNK_SIZE);
+    if (m_bandwidthSamples > 0) {
+        double seconds = std::max(std::chrono::duration<double>(m_config.targetTransferTime).count(),
+                                  m_config.minRoundTrips * m_roundTripMs / 1000.0);
+        size = m_bytesPerSecond * seconds;
+    }
+    size *= std::clamp(1.0 - m_config.resendPenalty * m_resendRate, m_config.minResendScale, 1.0);
+
+    size_t chunkSize = static_cast<size_t>(std::clamp(size, static_cast<double>(m_config.minChunkSize),
+                                                      static_cast<double>(m_config.maxChunkSize)));
+    chunkSize = std::max(chunkSize / CHUNK_SIZE_STEP * CHUNK_SIZE_STEP, CHUNK_SIZE_STEP);
+
+    // Big files need big chunks to fit in maxChunks, past maxChunkSize the rules reject them either way
+    size_t needed = (encodedSize + m_config.maxChunks - 1) / m_config.maxChunks;
+    needed += needed % 2;
+    size_t limit = m_config.maxChunkSize - m_config.maxChunkSize % 2;
+    return std::min(std::max(chunkSize, needed), limit);
+}
+
+}
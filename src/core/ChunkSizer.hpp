@@ -0,0 +1,65 @@
+/**
+ * BetterSave - Chunk Sizer
+ * Picks the chunk size for each upload from measured round trip time, bandwidth and resends,
+ * within what the database rules accept
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace bettersave::core {
+
+struct ChunkSizingConfig {
+    // firebase-rules.json: a chunk's "d" is at most 500000 characters, a file at most 1000 index
+    // pages of 1000 chunks
+    size_t maxChunkSize = 500000;
+    size_t maxChunks = 1000000;
+    // Below this, request overhead dominates on any link
+    size_t minChunkSize = 20000;
+    // A chunk should spend about this long on the wire, so a resend never costs much...
+    std::chrono::milliseconds targetTransferTime{1500};
+    // ...but at least this many round trips, so most of a request's time goes to moving data
+    double minRoundTrips = 4;
+    // Responses to bodies this small measure the round trip rather than bandwidth
+    size_t smallRequestBytes = 4096;
+    // Every resend costs a whole chunk: at this resend rate chunks shrink to minResendScale of their size
+    double resendPenalty = 2.0;
+    double minResendScale = 0.25;
+};
+
+// Not thread-safe, the mod feeds it from request callbacks on the main thread
+class ChunkSizer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    ChunkSizingConfig m_config;
+    double m_roundTripMs = 0;
+    int m_roundTripSamples = 0;
+    // What a single request gets, with everything else in flight sharing the link
+    double m_bytesPerSecond = 0;
+    int m_bandwidthSamples = 0;
+    // Share of attempts that were dropped or throttled and had to be sent again
+    double m_resendRate = 0;
+    int m_attemptSamples = 0;
+
+public:
+    explicit ChunkSizer(ChunkSizingConfig config = {});
+
+    // A request moved bytes (body sent or received) in latency, the time of its last attempt,
+    // after resends earlier attempts that didn't get through
+    void onTransfer(size_t bytes, Clock::duration latency, int resends = 0);
+
+    // Chunk size in hex characters for a file that encodes to encodedSize characters. Always even,
+    // so chunks end on a byte. DEFAULT_CHUNK_SIZE until a chunk-sized request was measured.
+    size_t chooseChunkSize(size_t encodedSize) const;
+
+    double roundTripMs() const { return m_roundTripMs; }
+    double bytesPerSecond() const { return m_bytesPerSecond; }
+    double resendRate() const { return m_resendRate; }
+    const ChunkSizingConfig& config() const { return m_config; }
+};
+
+}
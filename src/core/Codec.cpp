@@ -0,0 +1,80 @@
+/**
+ * BetterSave - Codec
+ * Created by: sidastuff
+ */
+
+#include "Codec.hpp"
+#include <algorithm>
+
+namespace bettersave::core {
+
+// Hex encoding - simpler and more reliable than base64
+std::string hexEncode(const std::string& data) {
+    static const char hex[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(data.size() * 2);
+    for (unsigned char c : data) {
+        result += hex[c >> 4];
+        result += hex[c & 0x0F];
+    }
+    return result;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::optional<std::string> hexDecode(const std::string& hex) {
+    if (hex.size() % 2 != 0) {
+        return std::nullopt;
+    }
+
+    std::string result(hex.size() / 2, '\0');
+    if (!hexDecodeInto(hex, result.data())) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+bool hexDecodeInto(const std::string& hex, char* out) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = hexValue(hex[i]);
+        int low = hexValue(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        *out++ = static_cast<char>((high << 4) | low);
+    }
+    return true;
+}
+
+// Split into chunks - larger chunks = fewer requests = faster upload
+std::vector<std::string> splitChunks(const std::string& data, size_t chunkSize) {
+    std::vector<std::string> chunks;
+    for (size_t i = 0; i < data.size(); i += chunkSize) {
+        chunks.push_back(data.substr(i, std::min(chunkSize, data.size() - i)));
+    }
+    return chunks;
+}
+
+std::string joinChunks(const std::vector<std::string>& chunks) {
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        total += chunk.size();
+    }
+
+    std::string result;
+    result.reserve(total);
+    for (const auto& chunk : chunks) {
+        result += chunk;
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,27 @@
+/**
+ * BetterSave - Codec
+ * Hex encoding and chunking used for the cloud save format
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+// Chunk size used for cloud uploads (in hex characters)
+constexpr size_t DEFAULT_CHUNK_SIZE = 200000;
+
+std::string hexEncode(const std::string& data);
+
+// nullopt if the input has an odd length or a non-hex character
+std::optional<std::string> hexDecode(const std::string& hex);
+// Decodes into out, which must have room for hex.size() / 2 bytes. False like hexDecode's nullopt.
+bool hexDecodeInto(const std::string& hex, char* out);
+
+std::vector<std::string> splitChunks(const std::string& data, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+std::string joinChunks(const std::vector<std::string>& chunks);
+
+}
@@ -0,0 +1,345 @@
+/**
+ * BetterSave - Delta
+ * Created by: sidastuff
+ */
+
+#include "Delta.hpp"
+#include "Json.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace bettersave::core {
+
+static constexpr size_t MIN_BLOCK_SIZE = 1024;
+static constexpr size_t MAX_BLOCK_SIZE = 65536;
+
+// Patch layout: magic, varint block size, varint output size, then operations until the end
+static const std::string PATCH_MAGIC = "BSP1";
+static constexpr char OP_COPY = 'C';     // varint first block, varint block count
+static constexpr char OP_LITERAL = 'L';  // varint length, that many bytes
+
+static void checkCancelled(const CancellationToken* cancel) {
+    if (cancel) cancel->throwIfCancelled();
+}
+
+size_t deltaBlockSize(size_t fileSize) {
+    auto root = static_cast<size_t>(std::sqrt(static_cast<double>(fileSize)));
+    return std::clamp(root / MIN_BLOCK_SIZE * MIN_BLOCK_SIZE, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+}
+
+// rsync's rolling checksum: a is the byte sum, b the sum of the running a's, both mod 2^16.
+// Kept unmasked while rolling, 2^32 wraparound doesn't change the low 16 bits.
+struct RollingChecksum {
+    uint32_t a = 0;
+    uint32_t b = 0;
+
+    void reset(const uint8_t* data, size_t size) {
+        a = 0;
+        b = 0;
+        for (size_t i = 0; i < size; i++) {
+            a += data[i];
+            b += static_cast<uint32_t>(size - i) * data[i];
+        }
+    }
+
+    void roll(uint8_t out, uint8_t in, size_t size) {
+        a += static_cast<uint32_t>(in) - out;
+        b += a - static_cast<uint32_t>(size) * out;
+    }
+
+    uint32_t value() const { return (a & 0xFFFF) | (b << 16); }
+};
+
+// FNV-1a, only consulted when the rolling checksum already matched
+static uint64_t strongHash(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+BlockSignature computeSignature(const std::string& data, const std::string& checksum, const CancellationToken* cancel) {
+    TraceSpan span("compute_signature", "encode");
+    span.arg("bytes", static_cast<int64_t>(data.size()));
+
+    BlockSignature signature;
+    signature.checksum = checksum;
+    signature.blockSize = deltaBlockSize(data.size());
+    signature.fileSize = data.size();
+
+    size_t blocks = data.size() / signature.blockSize;
+    signature.weak.resize(blocks);
+    signature.strong.resize(blocks);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    ThreadPool::get()->parallelFor(blocks, [&](size_t i) {
+        checkCancelled(cancel);
+        const auto* block = bytes + i * signature.blockSize;
+        RollingChecksum rolling;
+        rolling.reset(block, signature.blockSize);
+        signature.weak[i] = rolling.value();
+        signature.strong[i] = strongHash(block, signature.blockSize);
+    });
+    return signature;
+}
+
+static void appendHex(std::string& out, uint64_t value, int digits) {
+    static const char hexDigits[] = "0123456789abcdef";
+    for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+        out += hexDigits[(value >> shift) & 0xF];
+    }
+}
+
+static std::optional<uint64_t> parseHex(const std::string& text, size_t offset, int digits) {
+    uint64_t value = 0;
+    for (int i = 0; i < digits; i++) {
+        char c = text[offset + i];
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else return std::nullopt;
+        value = (value << 4) | static_cast<uint64_t>(digit);
+    }
+    return value;
+}
+
+// Hex characters per block in the serialized signature
+static constexpr size_t WEAK_DIGITS = 8;
+static constexpr size_t STRONG_DIGITS = 16;
+
+std::string serializeSignature(const BlockSignature& signature) {
+    std::string blocks;
+    blocks.reserve(signature.weak.size() * (WEAK_DIGITS + STRONG_DIGITS));
+    for (size_t i = 0; i < signature.weak.size(); i++) {
+        appendHex(blocks, signature.weak[i], WEAK_DIGITS);
+        appendHex(blocks, signature.strong[i], STRONG_DIGITS);
+    }
+
+    std::string out = "{\"checksum\":";
+    appendJsonString(out, signature.checksum);
+    out += ",\"blockSize\":" + std::to_string(signature.blockSize);
+    out += ",\"fileSize\":" + std::to_string(signature.fileSize);
+    out += ",\"blocks\":";
+    appendJsonString(out, blocks);
+    out += '}';
+    return out;
+}
+
+std::optional<BlockSignature> parseSignature(const std::string& text) {
+    auto object = parseFlatJsonObject(text);
+    if (!object) return std::nullopt;
+
+    auto checksum = getString(*object, "checksum");
+    auto blockSize = getInt(*object, "blockSize");
+    auto fileSize = getInt(*object, "fileSize");
+    auto blocks = getString(*object, "blocks");
+    if (!checksum || checksum->empty() || !blockSize || *blockSize <= 0 || !fileSize || *fileSize < 0 || !blocks) {
+        return std::nullopt;
+    }
+
+    BlockSignature signature;
+    signature.checksum = *checksum;
+    signature.blockSize = static_cast<size_t>(*blockSize);
+    signature.fileSize = static_cast<size_t>(*fileSize);
+    constexpr size_t stride = WEAK_DIGITS + STRONG_DIGITS;
+    if (blocks->size() % stride != 0 || blocks->size() / stride != signature.fileSize / signature.blockSize) {
+        return std::nullopt;
+    }
+    for (size_t offset = 0; offset < blocks->size(); offset += stride) {
+        auto weak = parseHex(*blocks, offset, WEAK_DIGITS);
+        auto strong = parseHex(*blocks, offset + WEAK_DIGITS, STRONG_DIGITS);
+        if (!weak || !strong) return std::nullopt;
+        signature.weak.push_back(static_cast<uint32_t>(*weak));
+        signature.strong.push_back(*strong);
+    }
+    return signature;
+}
+
+static void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static std::optional<uint64_t> readVarint(const std::string& in, size_t& pos) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        auto byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    return std::nullopt;
+}
+
+namespace {
+
+// Merges consecutive block copies into one run
+class PatchWriter {
+private:
+    std::string& m_out;
+    size_t m_runFirst = 0;
+    size_t m_runLength = 0;
+
+    void flushRun() {
+        if (m_runLength == 0) return;
+        m_out += OP_COPY;
+        appendVarint(m_out, m_runFirst);
+        appendVarint(m_out, m_runLength);
+        m_runLength = 0;
+    }
+
+public:
+    explicit PatchWriter(std::string& out) : m_out(out) {}
+
+    void copy(size_t block) {
+        if (m_runLength > 0 && m_runFirst + m_runLength == block) {
+            m_runLength++;
+            return;
+        }
+        flushRun();
+        m_runFirst = block;
+        m_runLength = 1;
+    }
+
+    void literal(const std::string& data, size_t begin, size_t end) {
+        if (begin >= end) return;
+        flushRun();
+        m_out += OP_LITERAL;
+        appendVarint(m_out, end - begin);
+        m_out.append(data, begin, end - begin);
+    }
+
+    void finish() { flushRun(); }
+};
+
+}
+
+// Folds a rolling checksum into the 16-bit tag table index
+static uint32_t checksumTag(uint32_t weak) {
+    return (weak ^ (weak >> 16)) & 0xFFFF;
+}
+
+std::string computePatch(const BlockSignature& base, const std::string& data, const CancellationToken* cancel) {
+    TraceSpan span("compute_patch", "encode");
+    span.arg("bytes", static_cast<int64_t>(data.size()));
+
+    std::string patch = PATCH_MAGIC;
+    appendVarint(patch, base.blockSize);
+    appendVarint(patch, data.size());
+    PatchWriter writer(patch);
+
+    size_t blockSize = base.blockSize;
+    if (blockSize == 0 || base.weak.empty() || data.size() < blockSize) {
+        writer.literal(data, 0, data.size());
+        writer.finish();
+        return patch;
+    }
+
+    // Base blocks by rolling checksum. Most positions match nothing, the tag table turns those
+    // away without a hash lookup.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> blocksByWeak;
+    blocksByWeak.reserve(base.weak.size());
+    std::vector<uint8_t> tags(1 << 16, 0);
+    for (size_t i = 0; i < base.weak.size(); i++) {
+        blocksByWeak[base.weak[i]].push_back(static_cast<uint32_t>(i));
+        tags[checksumTag(base.weak[i])] = 1;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t pos = 0;
+    size_t literalStart = 0;
+    // The block after the last copied one, edits usually leave long runs of base blocks in order
+    size_t expectedBlock = base.weak.size();
+    RollingChecksum rolling;
+    rolling.reset(bytes, blockSize);
+    size_t sinceCancelCheck = 0;
+
+    while (true) {
+        if (++sinceCancelCheck == (1 << 20)) {
+            checkCancelled(cancel);
+            sinceCancelCheck = 0;
+        }
+
+        uint32_t weak = rolling.value();
+        std::optional<size_t> match;
+        if (tags[checksumTag(weak)]) {
+            auto found = blocksByWeak.find(weak);
+            if (found != blocksByWeak.end()) {
+                uint64_t strong = strongHash(bytes + pos, blockSize);
+                if (expectedBlock < base.weak.size() && base.weak[expectedBlock] == weak && base.strong[expectedBlock] == strong) {
+                    match = expectedBlock;
+                } else {
+                    for (uint32_t block : found->second) {
+                        if (base.strong[block] == strong) {
+                            match = block;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (match) {
+            writer.literal(data, literalStart, pos);
+            writer.copy(*match);
+            expectedBlock = *match + 1;
+            pos += blockSize;
+            literalStart = pos;
+            if (pos + blockSize > data.size()) break;
+            rolling.reset(bytes + pos, blockSize);
+            continue;
+        }
+
+        if (pos + blockSize >= data.size()) break;
+        rolling.roll(bytes[pos], bytes[pos + blockSize], blockSize);
+        pos++;
+    }
+
+    writer.literal(data, literalStart, data.size());
+    writer.finish();
+    span.arg("patch_bytes", static_cast<int64_t>(patch.size()));
+    return patch;
+}
+
+std::optional<std::string> applyPatch(const std::string& base, const std::string& patch) {
+    TraceSpan span("apply_patch", "decode");
+
+    if (patch.compare(0, PATCH_MAGIC.size(), PATCH_MAGIC) != 0) return std::nullopt;
+    size_t pos = PATCH_MAGIC.size();
+    auto blockSize = readVarint(patch, pos);
+    auto outputSize = readVarint(patch, pos);
+    if (!blockSize || *blockSize == 0 || !outputSize) return std::nullopt;
+
+    std::string out;
+    // Copies can repeat base blocks, but never reserve more than the inputs could plausibly make
+    out.reserve(std::min<uint64_t>(*outputSize, base.size() + patch.size()));
+    size_t baseBlocks = base.size() / *blockSize;
+    while (pos < patch.size()) {
+        char op = patch[pos++];
+        if (op == OP_COPY) {
+            auto first = readVarint(patch, pos);
+            auto count = readVarint(patch, pos);
+            if (!first || !count || *first > baseBlocks || *count > baseBlocks - *first) return std::nullopt;
+            if (*count * *blockSize > *outputSize - out.size()) return std::nullopt;
+            out.append(base, *first * *blockSize, *count * *blockSize);
+        } else if (op == OP_LITERAL) {
+            auto length = readVarint(patch, pos);
+            if (!length || *length > patch.size() - pos || *length > *outputSize - out.size()) return std::nullopt;
+            out.append(patch, pos, *length);
+            pos += *length;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (out.size() != *outputSize) return std::nullopt;
+    return out;
+}
+
+}
@@ -0,0 +1,50 @@
+/**
+ * BetterSave - Delta
+ * rsync-style block signatures and patches: a backup of a changed file can upload only what
+ * differs from the file's last full upload (its base), plus the recipe for rebuilding it
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "Cancellation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+// Describes a base file without its contents, so it's all the uploader has to keep locally
+struct BlockSignature {
+    // checksumHex of the base
+    std::string checksum;
+    size_t blockSize = 0;
+    size_t fileSize = 0;
+    // Rolling and strong hash of each whole block, a shorter last block isn't listed
+    std::vector<uint32_t> weak;
+    std::vector<uint64_t> strong;
+};
+
+// A patch is only worth uploading while it's at most this share of the file. Past that, the
+// file is uploaded whole and becomes the new base, which also caps what a restore downloads.
+constexpr double MAX_PATCH_RATIO = 0.5;
+
+// About the square root of the file size (like rsync), between 1 KB and 64 KB
+size_t deltaBlockSize(size_t fileSize);
+
+// checksum is checksumHex(data), which callers already have
+BlockSignature computeSignature(const std::string& data, const std::string& checksum, const CancellationToken* cancel = nullptr);
+
+// {"checksum", "blockSize", "fileSize", "blocks": "<8 + 16 hex characters per block>"}
+std::string serializeSignature(const BlockSignature& signature);
+std::optional<BlockSignature> parseSignature(const std::string& text);
+
+// Instructions that rebuild data from the base: runs of base blocks and literal bytes.
+// Throws OperationCancelled if the token is cancelled part way.
+std::string computePatch(const BlockSignature& base, const std::string& data, const CancellationToken* cancel = nullptr);
+
+// nullopt if the patch is malformed or doesn't fit base
+std::optional<std::string> applyPatch(const std::string& base, const std::string& patch);
+
+}
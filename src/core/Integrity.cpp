@@ -0,0 +1,154 @@
+/**
+ * BetterSave - Integrity
+ * Created by: sidastuff
+ */
+
+#include "Integrity.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace bettersave::core {
+
+// Bigger inputs are checksummed in blocks of this size on the thread pool
+static constexpr size_t CRC_BLOCK_SIZE = 1 << 20;
+
+static uint32_t crc32Serial(const uint8_t* data, size_t size) {
+    uint32_t checksum = 0xFFFFFFFF;
+
+    for (size_t b = 0; b < size; b++) {
+        checksum ^= data[b];
+        for (int i = 0; i < 8; i++) {
+            if (checksum & 1) {
+                checksum = (checksum >> 1) ^ 0xEDB88320;
+            } else {
+                checksum >>= 1;
+            }
+        }
+    }
+
+    return checksum ^ 0xFFFFFFFF;
+}
+
+// crc32 is linear over GF(2): appending len zero bytes is a 32x32 bit-matrix multiply, done by
+// repeated squaring (the zlib crc32_combine method)
+static uint32_t gf2MatrixTimes(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    while (vector) {
+        if (vector & 1) sum ^= *matrix;
+        vector >>= 1;
+        matrix++;
+    }
+    return sum;
+}
+
+static void gf2MatrixSquare(uint32_t* square, const uint32_t* matrix) {
+    for (int n = 0; n < 32; n++) {
+        square[n] = gf2MatrixTimes(matrix, matrix[n]);
+    }
+}
+
+// crc32 of A followed by B, from crc32(A), crc32(B) and B's length
+static uint32_t crc32Combine(uint32_t crcA, uint32_t crcB, size_t lengthB) {
+    if (lengthB == 0) {
+        return crcA;
+    }
+
+    uint32_t even[32];
+    uint32_t odd[32];
+    // Operator for one zero bit
+    odd[0] = 0xEDB88320;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    gf2MatrixSquare(even, odd); // two zero bits
+    gf2MatrixSquare(odd, even); // four zero bits
+
+    // Each pass squares again (one byte, two bytes, four...) and applies it for each set bit of lengthB
+    do {
+        gf2MatrixSquare(even, odd);
+        if (lengthB & 1) crcA = gf2MatrixTimes(even, crcA);
+        lengthB >>= 1;
+        if (lengthB == 0) break;
+
+        gf2MatrixSquare(odd, even);
+        if (lengthB & 1) crcA = gf2MatrixTimes(odd, crcA);
+        lengthB >>= 1;
+    } while (lengthB != 0);
+
+    return crcA ^ crcB;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    if (size < 2 * CRC_BLOCK_SIZE) {
+        return crc32Serial(data, size);
+    }
+
+    size_t blocks = (size + CRC_BLOCK_SIZE - 1) / CRC_BLOCK_SIZE;
+    std::vector<uint32_t> checksums(blocks);
+    ThreadPool::get()->parallelFor(blocks, [&](size_t i) {
+        size_t offset = i * CRC_BLOCK_SIZE;
+        checksums[i] = crc32Serial(data + offset, std::min(CRC_BLOCK_SIZE, size - offset));
+    });
+
+    uint32_t checksum = checksums[0];
+    for (size_t i = 1; i < blocks; i++) {
+        size_t offset = i * CRC_BLOCK_SIZE;
+        checksum = crc32Combine(checksum, checksums[i], std::min(CRC_BLOCK_SIZE, size - offset));
+    }
+    return checksum;
+}
+
+std::string checksumHex(const uint8_t* data, size_t size) {
+    char buffer[9];
+    std::snprintf(buffer, sizeof(buffer), "%08x", crc32(data, size));
+    return buffer;
+}
+
+std::string checksumHex(const std::string& data) {
+    return checksumHex(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+ValidationResult validateSaveBytes(const uint8_t* data, size_t size) {
+    TraceSpan span("validate_save", "integrity");
+    span.arg("bytes", static_cast<int64_t>(size));
+
+    ValidationResult result;
+    result.size = size;
+
+    if (size == 0) {
+        result.message = "File is empty";
+        return result;
+    }
+
+    result.checksum = checksumHex(data, size);
+
+    // Basic integrity checks
+    if (size < 100) {
+        result.message = "File size too small, likely corrupted";
+        return result;
+    }
+
+    // Check for null bytes ratio (corrupted files often have excessive null bytes)
+    size_t nullCount = std::count(data, data + size, 0);
+    double nullRatio = static_cast<double>(nullCount) / size;
+
+    if (nullRatio > 0.9) {
+        result.message = "File contains too many null bytes, likely corrupted";
+        return result;
+    }
+
+    result.isValid = true;
+    result.message = "File integrity check passed";
+    return result;
+}
+
+ValidationResult validateSaveBytes(const std::string& data) {
+    return validateSaveBytes(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+}
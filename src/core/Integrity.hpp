@@ -0,0 +1,30 @@
+/**
+ * BetterSave - Integrity
+ * Checksums and sanity checks for raw save bytes
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bettersave::core {
+
+struct ValidationResult {
+    bool isValid = false;
+    std::string message;
+    size_t size = 0;
+    std::string checksum;
+};
+
+uint32_t crc32(const uint8_t* data, size_t size);
+
+// CRC32 as 8 lowercase hex digits, the format stored in the cloud metadata
+std::string checksumHex(const uint8_t* data, size_t size);
+std::string checksumHex(const std::string& data);
+
+ValidationResult validateSaveBytes(const uint8_t* data, size_t size);
+ValidationResult validateSaveBytes(const std::string& data);
+
+}
@@ -0,0 +1,223 @@
+/**
+ * BetterSave - Json
+ * Created by: sidastuff
+ */
+
+#include "Json.hpp"
+#include <cmath>
+#include <cstdlib>
+
+namespace bettersave::core {
+
+void appendJsonString(std::string& out, const std::string& value) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0x0F];
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+namespace {
+
+class Parser {
+private:
+    const std::string& m_text;
+    size_t m_pos = 0;
+
+    void skipWhitespace() {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' ||
+                                         m_text[m_pos] == '\r' || m_text[m_pos] == '\t')) {
+            m_pos++;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeLiteral(const char* literal) {
+        size_t length = std::char_traits<char>::length(literal);
+        if (m_text.compare(m_pos, length, literal) != 0) return false;
+        m_pos += length;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    std::optional<uint32_t> parseHex4() {
+        if (m_pos + 4 > m_text.size()) return std::nullopt;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = m_text[m_pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return std::nullopt;
+        }
+        return value;
+    }
+
+public:
+    explicit Parser(const std::string& text) : m_text(text) {}
+
+    std::optional<std::string> parseString() {
+        if (!consume('"')) return std::nullopt;
+
+        std::string result;
+        while (m_pos < m_text.size()) {
+            // Copy plain runs in one go, chunk payloads are long runs without escapes
+            size_t runEnd = m_text.find_first_of("\"\\", m_pos);
+            if (runEnd == std::string::npos) return std::nullopt;
+            result.append(m_text, m_pos, runEnd - m_pos);
+            m_pos = runEnd;
+
+            char c = m_text[m_pos++];
+            if (c == '"') return result;
+
+            if (m_pos >= m_text.size()) return std::nullopt;
+            char escape = m_text[m_pos++];
+            switch (escape) {
+                case '"': result += '"'; break;
+                case '\\': result += '\\'; break;
+                case '/': result += '/'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': {
+                    auto codepoint = parseHex4();
+                    if (!codepoint) return std::nullopt;
+                    // Surrogate pair
+                    if (*codepoint >= 0xD800 && *codepoint <= 0xDBFF) {
+                        if (!consumeLiteral("\\u")) return std::nullopt;
+                        auto low = parseHex4();
+                        if (!low || *low < 0xDC00 || *low > 0xDFFF) return std::nullopt;
+                        *codepoint = 0x10000 + ((*codepoint - 0xD800) << 10) + (*low - 0xDC00);
+                    }
+                    appendUtf8(result, *codepoint);
+                    break;
+                }
+                default:
+                    return std::nullopt;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<JsonScalar> parseScalar() {
+        skipWhitespace();
+        if (m_pos >= m_text.size()) return std::nullopt;
+
+        JsonScalar value;
+        char c = m_text[m_pos];
+        if (c == '"') {
+            auto string = parseString();
+            if (!string) return std::nullopt;
+            value.type = JsonScalar::Type::String;
+            value.string = std::move(*string);
+        } else if (consumeLiteral("true")) {
+            value.type = JsonScalar::Type::Bool;
+            value.boolean = true;
+        } else if (consumeLiteral("false")) {
+            value.type = JsonScalar::Type::Bool;
+        } else if (consumeLiteral("null")) {
+            value.type = JsonScalar::Type::Null;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            const char* start = m_text.c_str() + m_pos;
+            char* end = nullptr;
+            value.type = JsonScalar::Type::Number;
+            value.number = std::strtod(start, &end);
+            if (end == start) return std::nullopt;
+            m_pos += end - start;
+        } else {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::optional<FlatJsonObject> parseObject() {
+        if (!consume('{')) return std::nullopt;
+
+        FlatJsonObject object;
+        if (consume('}')) return finish(std::move(object));
+
+        while (true) {
+            skipWhitespace();
+            auto key = parseString();
+            if (!key || !consume(':')) return std::nullopt;
+
+            auto value = parseScalar();
+            if (!value) return std::nullopt;
+            object[std::move(*key)] = std::move(*value);
+
+            if (consume(',')) continue;
+            if (consume('}')) return finish(std::move(object));
+            return std::nullopt;
+        }
+    }
+
+    std::optional<FlatJsonObject> finish(FlatJsonObject object) {
+        skipWhitespace();
+        if (m_pos != m_text.size()) return std::nullopt;
+        return object;
+    }
+};
+
+}
+
+std::optional<FlatJsonObject> parseFlatJsonObject(const std::string& text) {
+    Parser parser(text);
+    return parser.parseObject();
+}
+
+std::optional<std::string> getString(const FlatJsonObject& object, const std::string& key) {
+    auto it = object.find(key);
+    if (it == object.end() || it->second.type != JsonScalar::Type::String) return std::nullopt;
+    return it->second.string;
+}
+
+std::optional<int64_t> getInt(const FlatJsonObject& object, const std::string& key) {
+    auto it = object.find(key);
+    if (it == object.end() || it->second.type != JsonScalar::Type::Number) return std::nullopt;
+    return static_cast<int64_t>(std::llround(it->second.number));
+}
+
+}
@@ -0,0 +1,36 @@
+/**
+ * BetterSave - Json
+ * Just enough JSON for the cloud save format: flat objects of scalars
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace bettersave::core {
+
+struct JsonScalar {
+    enum class Type { Null, Bool, Number, String };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+};
+
+using FlatJsonObject = std::map<std::string, JsonScalar>;
+
+// Appends a quoted, escaped JSON string to out
+void appendJsonString(std::string& out, const std::string& value);
+
+// Parses a JSON object whose values are all scalars. Nested values and malformed input give nullopt.
+std::optional<FlatJsonObject> parseFlatJsonObject(const std::string& text);
+
+// Typed accessors, nullopt if the key is missing or has another type
+std::optional<std::string> getString(const FlatJsonObject& object, const std::string& key);
+std::optional<int64_t> getInt(const FlatJsonObject& object, const std::string& key);
+
+}
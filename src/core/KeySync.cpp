@@ -0,0 +1,143 @@
+/**
+ * BetterSave - Key Sync
+ * Created by: sidastuff
+ */
+
+#include "KeySync.hpp"
+#include "Integrity.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+
+namespace bettersave::core {
+
+static void checkCancelled(const CancellationToken* cancel) {
+    if (cancel) cancel->throwIfCancelled();
+}
+
+std::string nodeId(const PlistNode& node) {
+    return checksumHex(node.path) + checksumHex(node.text);
+}
+
+// Pages listing ids. The new generation starts empty, so every page goes up even where the stored
+// index lists the same ids.
+static std::vector<ChunkTransfer> planKeyPages(const std::string& userId, const std::string& generation,
+                                               const std::vector<std::string>& ids) {
+    std::vector<ChunkTransfer> pages;
+    for (size_t first = 0; first < ids.size(); first += CHUNKS_PER_PAGE) {
+        size_t end = std::min(first + CHUNKS_PER_PAGE, ids.size());
+        IndexPage page;
+        page.first = static_cast<int>(first);
+        page.checksums.assign(ids.begin() + first, ids.begin() + end);
+        pages.push_back({pageKey(userId, generation, KEY_PAGE_PREFIX, first / CHUNKS_PER_PAGE), serializePage(page)});
+    }
+    return pages;
+}
+
+std::optional<KeySyncChanges> prepareKeySync(SavePayload& payload, const std::string& userId, const std::string& generation,
+                                             const SaveFileCodec& codec, const std::vector<std::string>& storedIds,
+                                             const CancellationToken* cancel) {
+    TraceSpan span("prepare_key_sync", "encode");
+    if (payload.unchanged || !codec.decode || !codec.encode) {
+        return std::nullopt;
+    }
+
+    auto plist = codec.decode(payload.data);
+    checkCancelled(cancel);
+    auto nodes = plist ? splitPlist(*plist) : std::nullopt;
+    if (!nodes) {
+        return std::nullopt;
+    }
+
+    auto* pool = ThreadPool::get();
+    std::vector<std::string> ids(nodes->size());
+    pool->parallelFor(nodes->size(), [&](size_t i) {
+        checkCancelled(cancel);
+        ids[i] = nodeId((*nodes)[i]);
+    });
+
+    // Each missing node once, GD never repeats a key but two nodes could still match
+    std::unordered_set<std::string> stored(storedIds.begin(), storedIds.end());
+    std::unordered_set<std::string> queued;
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (!stored.count(ids[i]) && queued.insert(ids[i]).second) {
+            missing.push_back(i);
+        }
+    }
+
+    // Nodes are encoded the way GD encodes the whole file, which also compresses them
+    std::vector<ChunkTransfer> transfers(missing.size());
+    std::atomic<bool> tooLarge{false};
+    pool->parallelFor(missing.size(), [&](size_t j) {
+        checkCancelled(cancel);
+        size_t i = missing[j];
+        auto body = frameChunk(codec.encode((*nodes)[i].text));
+        if (body.size() > MAX_NODE_SIZE) {
+            tooLarge.store(true);
+            return;
+        }
+        transfers[j] = {nodeKey(userId, ids[i]), std::move(body)};
+    });
+    if (tooLarge.load()) {
+        return std::nullopt;
+    }
+
+    KeySyncChanges changes;
+    for (size_t i : missing) {
+        changes.sentPaths.push_back((*nodes)[i].path);
+        changes.sentIds.push_back(ids[i]);
+    }
+    std::unordered_set<std::string> current(ids.begin(), ids.end());
+    std::unordered_set<std::string> stale;
+    for (const auto& id : storedIds) {
+        if (!current.count(id) && stale.insert(id).second) {
+            changes.staleIds.push_back(id);
+        }
+    }
+
+    payload.plistChecksum = checksumHex(*plist);
+    payload.keyNodes = static_cast<int>(ids.size());
+    payload.keyPages = pageCount(ids.size());
+    payload.nodeTransfers = std::move(transfers);
+    payload.keyPageTransfers = planKeyPages(userId, generation, ids);
+    span.arg("nodes", static_cast<int64_t>(ids.size())).arg("sent", static_cast<int64_t>(missing.size()));
+    return changes;
+}
+
+std::optional<std::string> joinNodes(const std::vector<std::string>& bodies, const std::vector<std::string>& ids,
+                                     const std::string& plistChecksum, const SaveFileCodec& codec,
+                                     const CancellationToken* cancel) {
+    TraceSpan span("join_nodes", "decode");
+    span.arg("nodes", static_cast<int64_t>(bodies.size()));
+    if (bodies.size() != ids.size() || !codec.decode) {
+        return std::nullopt;
+    }
+
+    // Only the text half of an id can be checked here, the path is inside the text
+    std::vector<PlistNode> nodes(bodies.size());
+    std::atomic<bool> malformed{false};
+    ThreadPool::get()->parallelFor(bodies.size(), [&](size_t i) {
+        checkCancelled(cancel);
+        auto encoded = unframeChunk(bodies[i]);
+        auto text = encoded ? codec.decode(*encoded) : std::nullopt;
+        if (!text || ids[i].size() != NODE_ID_LENGTH || checksumHex(*text) != ids[i].substr(CHECKSUM_LENGTH)) {
+            malformed.store(true);
+            return;
+        }
+        nodes[i].text = std::move(*text);
+    });
+    if (malformed.load()) {
+        return std::nullopt;
+    }
+
+    auto plist = joinPlist(nodes);
+    if (checksumHex(plist) != plistChecksum) {
+        return std::nullopt;
+    }
+    return plist;
+}
+
+}
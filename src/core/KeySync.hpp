@@ -0,0 +1,56 @@
+/**
+ * BetterSave - Key Sync
+ * CCGameManager.dat stored key by key: every node of its plist (see Plist.hpp) is a cloud entry of
+ * its own (users/<id>/keys/<node id>), listed in order by index pages stored with the upload's
+ * generation (users/<id>/generations/<g>/pages/gmk<n>). A backup only sends the nodes the cloud
+ * doesn't have, after a session that's a handful of keys.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "Cancellation.hpp"
+#include "Plist.hpp"
+#include "Transfer.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+// Index pages of the nodes, stored and paged like chunk index pages
+constexpr const char* KEY_PAGE_PREFIX = "gmk";
+
+// checksumHex of the node's path followed by checksumHex of its text. An id only depends on the
+// node's contents, so a node the cloud already lists is never sent again and an interrupted
+// upload never overwrites a node of the committed save.
+constexpr size_t NODE_ID_LENGTH = 16;
+
+// Largest node body, the same limit as a chunk. A save with a bigger single key goes up in chunks.
+constexpr size_t MAX_NODE_SIZE = 500000;
+
+std::string nodeId(const PlistNode& node);
+
+struct KeySyncChanges {
+    // Paths of the nodes being sent, and their ids in the same order
+    std::vector<std::string> sentPaths;
+    std::vector<std::string> sentIds;
+    // Nodes the stored index lists and the new one doesn't, to remove once the manifest is committed
+    std::vector<std::string> staleIds;
+};
+
+// Makes a changed CCGameManager.dat go up key by key. storedIds are the node ids the cloud's index
+// pages list (empty if it has none): only nodes missing from them are sent. The index pages are all
+// written under generation, the one the upload is planned with, so the committed ones stay as they
+// are until the manifest moves. nullopt if the file can't be stored by key (the codec can't decode
+// it, it isn't a plist, or one key alone is too large), the payload is then left as it was.
+std::optional<KeySyncChanges> prepareKeySync(SavePayload& payload, const std::string& userId, const std::string& generation,
+                                             const SaveFileCodec& codec, const std::vector<std::string>& storedIds,
+                                             const CancellationToken* cancel = nullptr);
+
+// The plist from its node bodies (in index order), each checked against its id and the result
+// against plistChecksum. nullopt if any of them doesn't match.
+std::optional<std::string> joinNodes(const std::vector<std::string>& bodies, const std::vector<std::string>& ids,
+                                     const std::string& plistChecksum, const SaveFileCodec& codec,
+                                     const CancellationToken* cancel = nullptr);
+
+}
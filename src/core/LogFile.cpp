@@ -0,0 +1,136 @@
+/**
+ * BetterSave - Log File
+ * Created by: sidastuff
+ */
+
+#include "LogFile.hpp"
+#include <algorithm>
+#include <fstream>
+
+namespace bettersave::core {
+
+namespace {
+
+constexpr size_t TAIL_BLOCK_SIZE = 64 * 1024;
+
+}
+
+SegmentedLog::SegmentedLog(std::filesystem::path path, uint64_t maxSegmentBytes, int maxSegments)
+    : m_path(std::move(path)), m_maxSegmentBytes(maxSegmentBytes), m_maxSegments(std::max(1, maxSegments)) {}
+
+std::filesystem::path SegmentedLog::segmentPath(int index) const {
+    if (index == 0) {
+        return m_path;
+    }
+    auto path = m_path;
+    path.replace_filename(m_path.stem().string() + "." + std::to_string(index) + m_path.extension().string());
+    return path;
+}
+
+void SegmentedLog::rotate() {
+    std::error_code error;
+    std::filesystem::remove(segmentPath(m_maxSegments - 1), error);
+    for (int i = m_maxSegments - 2; i >= 0; i--) {
+        if (std::filesystem::exists(segmentPath(i), error)) {
+            std::filesystem::rename(segmentPath(i), segmentPath(i + 1), error);
+        }
+    }
+    m_activeSize = 0;
+}
+
+bool SegmentedLog::append(const std::vector<std::string>& lines) {
+    if (lines.empty()) {
+        return true;
+    }
+
+    std::string batch;
+    // A crash mid-write can leave the last line without its newline; don't glue onto it
+    bool needsNewline = false;
+    if (m_activeSize < 0) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(m_path, error);
+        m_activeSize = error ? 0 : static_cast<int64_t>(size);
+        if (m_activeSize > 0) {
+            std::ifstream existing(m_path, std::ios::binary);
+            existing.seekg(-1, std::ios::end);
+            needsNewline = existing.get() != '\n';
+        }
+    }
+    if (needsNewline) {
+        batch += '\n';
+    }
+    for (const auto& line : lines) {
+        batch += line;
+        batch += '\n';
+    }
+
+    if (m_activeSize > 0 && static_cast<uint64_t>(m_activeSize) + batch.size() > m_maxSegmentBytes) {
+        rotate();
+    }
+
+    std::ofstream file(m_path, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    file.flush();
+    if (!file) {
+        m_activeSize = -1;
+        return false;
+    }
+    m_activeSize += static_cast<int64_t>(batch.size());
+    return true;
+}
+
+std::vector<std::string> SegmentedLog::readTail(size_t count) const {
+    std::vector<std::string> newestFirst;
+
+    for (int segment = 0; segment < m_maxSegments && newestFirst.size() < count; segment++) {
+        std::ifstream file(segmentPath(segment), std::ios::binary);
+        if (!file.is_open()) {
+            continue;
+        }
+        file.seekg(0, std::ios::end);
+        auto position = static_cast<uint64_t>(file.tellg());
+
+        // Text before the first newline seen so far; only complete once we reach its start
+        std::string pending;
+        while (position > 0 && newestFirst.size() < count) {
+            size_t length = static_cast<size_t>(std::min<uint64_t>(TAIL_BLOCK_SIZE, position));
+            position -= length;
+
+            std::string block(length, '\0');
+            file.seekg(static_cast<std::streamoff>(position));
+            file.read(block.data(), static_cast<std::streamsize>(length));
+            pending.insert(0, block);
+
+            size_t end = pending.size();
+            while (end > 0 && newestFirst.size() < count) {
+                size_t newline = pending.rfind('\n', end - 1);
+                if (newline == std::string::npos) break;
+                if (end - newline > 1) {
+                    newestFirst.push_back(pending.substr(newline + 1, end - newline - 1));
+                }
+                end = newline;
+            }
+            pending.resize(end);
+        }
+
+        if (position == 0 && !pending.empty() && newestFirst.size() < count) {
+            newestFirst.push_back(pending);
+        }
+    }
+
+    std::reverse(newestFirst.begin(), newestFirst.end());
+    return newestFirst;
+}
+
+void SegmentedLog::clear() {
+    std::error_code error;
+    for (int i = 0; i < m_maxSegments; i++) {
+        std::filesystem::remove(segmentPath(i), error);
+    }
+    m_activeSize = 0;
+}
+
+}
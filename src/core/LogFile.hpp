@@ -0,0 +1,46 @@
+/**
+ * BetterSave - Log File
+ * Append-only line log split into size-capped segments: <name>.jsonl, <name>.1.jsonl, ...
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+class SegmentedLog {
+private:
+    std::filesystem::path m_path;
+    uint64_t m_maxSegmentBytes;
+    int m_maxSegments;
+    // Size of the active segment, learned on the first append
+    int64_t m_activeSize = -1;
+
+    void rotate();
+
+public:
+    static constexpr uint64_t DEFAULT_SEGMENT_BYTES = 1024 * 1024;
+    static constexpr int DEFAULT_SEGMENTS = 4;
+
+    explicit SegmentedLog(std::filesystem::path path, uint64_t maxSegmentBytes = DEFAULT_SEGMENT_BYTES,
+                          int maxSegments = DEFAULT_SEGMENTS);
+
+    // Segment 0 is the one being appended to, higher numbers are older
+    std::filesystem::path segmentPath(int index) const;
+
+    // Writes each line plus '\n', rotating first if the active segment would pass the cap.
+    // Cost depends only on the batch, not on how much is already logged.
+    bool append(const std::vector<std::string>& lines);
+
+    // Last count lines across the segments, oldest first. Reads backwards from the end of the
+    // newest segment, so only the tail is touched. A torn last line is returned as-is.
+    std::vector<std::string> readTail(size_t count) const;
+
+    void clear();
+};
+
+}
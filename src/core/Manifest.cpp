@@ -0,0 +1,240 @@
+/**
+ * BetterSave - Manifest
+ * Created by: sidastuff
+ */
+
+#include "Manifest.hpp"
+#include "Json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace bettersave::core {
+
+std::string serializeManifest(const SaveManifest& manifest) {
+    std::string out = "{\"gmChunks\":" + std::to_string(manifest.gmChunks);
+    out += ",\"llChunks\":" + std::to_string(manifest.llChunks);
+    out += ",\"timestamp\":" + std::to_string(manifest.timestamp);
+    out += ",\"gmChecksum\":";
+    appendJsonString(out, manifest.gmChecksum);
+    out += ",\"llChecksum\":";
+    appendJsonString(out, manifest.llChecksum);
+    if (manifest.gmChunkSize > 0) out += ",\"gmChunkSize\":" + std::to_string(manifest.gmChunkSize);
+    if (manifest.llChunkSize > 0) out += ",\"llChunkSize\":" + std::to_string(manifest.llChunkSize);
+    if (manifest.gmPages > 0) out += ",\"gmPages\":" + std::to_string(manifest.gmPages);
+    if (manifest.llPages > 0) out += ",\"llPages\":" + std::to_string(manifest.llPages);
+    if (manifest.gmPatchChunks > 0) {
+        out += ",\"gmBaseChecksum\":";
+        appendJsonString(out, manifest.gmBaseChecksum);
+        out += ",\"gmPatchChunks\":" + std::to_string(manifest.gmPatchChunks);
+        out += ",\"gmPatchPages\":" + std::to_string(manifest.gmPatchPages);
+    }
+    if (manifest.llPatchChunks > 0) {
+        out += ",\"llBaseChecksum\":";
+        appendJsonString(out, manifest.llBaseChecksum);
+        out += ",\"llPatchChunks\":" + std::to_string(manifest.llPatchChunks);
+        out += ",\"llPatchPages\":" + std::to_string(manifest.llPatchPages);
+    }
+    if (manifest.gmKeyNodes > 0) {
+        out += ",\"gmKeyNodes\":" + std::to_string(manifest.gmKeyNodes);
+        out += ",\"gmKeyPages\":" + std::to_string(manifest.gmKeyPages);
+        out += ",\"gmPlistChecksum\":";
+        appendJsonString(out, manifest.gmPlistChecksum);
+    }
+    if (!manifest.gmGeneration.empty()) {
+        out += ",\"gmGeneration\":";
+        appendJsonString(out, manifest.gmGeneration);
+    }
+    if (!manifest.llGeneration.empty()) {
+        out += ",\"llGeneration\":";
+        appendJsonString(out, manifest.llGeneration);
+    }
+    if (!manifest.gmPatchGeneration.empty()) {
+        out += ",\"gmPatchGeneration\":";
+        appendJsonString(out, manifest.gmPatchGeneration);
+    }
+    if (!manifest.llPatchGeneration.empty()) {
+        out += ",\"llPatchGeneration\":";
+        appendJsonString(out, manifest.llPatchGeneration);
+    }
+    out += '}';
+    return out;
+}
+
+static bool isHex(const std::string& text) {
+    return std::all_of(text.begin(), text.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+// Generations end up in storage keys, anything but 8 hex characters could point elsewhere
+static bool isGeneration(const std::string& generation) {
+    return generation.size() == 8 && isHex(generation);
+}
+
+std::optional<SaveManifest> parseManifest(const std::string& body) {
+    auto object = parseFlatJsonObject(body);
+    if (!object) return std::nullopt;
+
+    auto gmChunks = getInt(*object, "gmChunks");
+    auto llChunks = getInt(*object, "llChunks");
+    if (!gmChunks || !llChunks || *gmChunks < 0 || *llChunks < 0) return std::nullopt;
+
+    SaveManifest manifest;
+    manifest.gmChunks = static_cast<int>(*gmChunks);
+    manifest.llChunks = static_cast<int>(*llChunks);
+    manifest.timestamp = getInt(*object, "timestamp").value_or(0);
+    // Saves uploaded before checksums were added don't have them
+    manifest.gmChecksum = getString(*object, "gmChecksum").value_or("");
+    manifest.llChecksum = getString(*object, "llChecksum").value_or("");
+    manifest.gmChunkSize = static_cast<int>(std::max<int64_t>(getInt(*object, "gmChunkSize").value_or(0), 0));
+    manifest.llChunkSize = static_cast<int>(std::max<int64_t>(getInt(*object, "llChunkSize").value_or(0), 0));
+    manifest.gmPages = static_cast<int>(getInt(*object, "gmPages").value_or(0));
+    manifest.llPages = static_cast<int>(getInt(*object, "llPages").value_or(0));
+    // A paged file needs exactly the pages its chunks fill
+    if (manifest.gmPages != 0 && manifest.gmPages != pageCount(manifest.gmChunks)) return std::nullopt;
+    if (manifest.llPages != 0 && manifest.llPages != pageCount(manifest.llChunks)) return std::nullopt;
+    manifest.gmBaseChecksum = getString(*object, "gmBaseChecksum").value_or("");
+    manifest.llBaseChecksum = getString(*object, "llBaseChecksum").value_or("");
+    manifest.gmPatchChunks = static_cast<int>(std::max<int64_t>(getInt(*object, "gmPatchChunks").value_or(0), 0));
+    manifest.llPatchChunks = static_cast<int>(std::max<int64_t>(getInt(*object, "llPatchChunks").value_or(0), 0));
+    manifest.gmPatchPages = static_cast<int>(getInt(*object, "gmPatchPages").value_or(0));
+    manifest.llPatchPages = static_cast<int>(getInt(*object, "llPatchPages").value_or(0));
+    // Patches are always paged and always say which base they apply to
+    if (manifest.gmPatchPages != pageCount(manifest.gmPatchChunks)) return std::nullopt;
+    if (manifest.llPatchPages != pageCount(manifest.llPatchChunks)) return std::nullopt;
+    if (manifest.gmPatchChunks > 0 && manifest.gmBaseChecksum.empty()) return std::nullopt;
+    if (manifest.llPatchChunks > 0 && manifest.llBaseChecksum.empty()) return std::nullopt;
+    manifest.gmKeyNodes = static_cast<int>(std::max<int64_t>(getInt(*object, "gmKeyNodes").value_or(0), 0));
+    manifest.gmKeyPages = static_cast<int>(getInt(*object, "gmKeyPages").value_or(0));
+    manifest.gmPlistChecksum = getString(*object, "gmPlistChecksum").value_or("");
+    // A file stored by key has its nodes instead of chunks, and a checksum to join them against
+    if (manifest.gmKeyPages != pageCount(manifest.gmKeyNodes)) return std::nullopt;
+    if (manifest.gmKeyNodes > 0 && (manifest.gmPlistChecksum.empty() || manifest.gmChunks > 0 || manifest.gmPatchChunks > 0)) {
+        return std::nullopt;
+    }
+    manifest.gmGeneration = getString(*object, "gmGeneration").value_or("");
+    manifest.llGeneration = getString(*object, "llGeneration").value_or("");
+    manifest.gmPatchGeneration = getString(*object, "gmPatchGeneration").value_or("");
+    manifest.llPatchGeneration = getString(*object, "llPatchGeneration").value_or("");
+    for (const auto* generation : {&manifest.gmGeneration, &manifest.llGeneration, &manifest.gmPatchGeneration, &manifest.llPatchGeneration}) {
+        if (!generation->empty() && !isGeneration(*generation)) return std::nullopt;
+    }
+    return manifest;
+}
+
+int pageCount(size_t chunks) {
+    return static_cast<int>((chunks + CHUNKS_PER_PAGE - 1) / CHUNKS_PER_PAGE);
+}
+
+std::string serializePage(const IndexPage& page) {
+    std::string checksums;
+    checksums.reserve(page.checksums.size() * CHECKSUM_LENGTH);
+    for (const auto& checksum : page.checksums) {
+        checksums += checksum;
+    }
+
+    std::string out = "{\"s\":" + std::to_string(page.first);
+    out += ",\"c\":";
+    appendJsonString(out, checksums);
+    out += '}';
+    return out;
+}
+
+std::optional<IndexPage> parsePage(const std::string& body, size_t entryLength) {
+    auto object = parseFlatJsonObject(body);
+    if (!object) return std::nullopt;
+
+    auto first = getInt(*object, "s");
+    auto checksums = getString(*object, "c");
+    if (!first || *first < 0 || !checksums || checksums->empty() || entryLength == 0 || checksums->size() % entryLength != 0) {
+        return std::nullopt;
+    }
+    // Node ids end up in storage keys the same way
+    if (!isHex(*checksums)) return std::nullopt;
+
+    IndexPage page;
+    page.first = static_cast<int>(*first);
+    for (size_t i = 0; i < checksums->size(); i += entryLength) {
+        page.checksums.push_back(checksums->substr(i, entryLength));
+    }
+    return page;
+}
+
+std::optional<std::vector<std::string>> joinPages(const std::vector<IndexPage>& pages, int chunkCount) {
+    std::vector<std::string> checksums;
+    checksums.reserve(chunkCount);
+    for (const auto& page : pages) {
+        if (page.first != static_cast<int>(checksums.size())) return std::nullopt;
+        checksums.insert(checksums.end(), page.checksums.begin(), page.checksums.end());
+    }
+    if (static_cast<int>(checksums.size()) != chunkCount) return std::nullopt;
+    return checksums;
+}
+
+std::string frameChunk(const std::string& chunk) {
+    // Hex payloads never need escaping, but other callers may frame arbitrary text
+    std::string out;
+    out.reserve(chunk.size() + 8);
+    out += "{\"d\":";
+    appendJsonString(out, chunk);
+    out += '}';
+    return out;
+}
+
+std::optional<std::string> unframeChunk(const std::string& body) {
+    auto object = parseFlatJsonObject(body);
+    if (!object) return std::nullopt;
+    return getString(*object, "d");
+}
+
+std::string manifestKey(const std::string& userId) {
+    return "users/" + userId + "/saveData";
+}
+
+bool usesGeneration(const SaveManifest& manifest, const std::string& generation) {
+    return !generation.empty() && (manifest.gmGeneration == generation || manifest.llGeneration == generation ||
+                                   manifest.gmPatchGeneration == generation || manifest.llPatchGeneration == generation);
+}
+
+std::string newGeneration(const SaveManifest* stored) {
+    // Only has to differ from the generations in use, the clock covers a weak random_device
+    std::random_device device;
+    static const char digits[] = "0123456789abcdef";
+    std::string generation(8, '0');
+    do {
+        auto value = static_cast<uint32_t>(device()) ^
+            static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        for (size_t i = 0; i < generation.size(); i++) {
+            generation[i] = digits[(value >> (28 - 4 * i)) & 0xf];
+        }
+    } while (stored && usesGeneration(*stored, generation));
+    return generation;
+}
+
+// users/<id>/ for saves from before generations, users/<id>/generations/<g>/ otherwise
+static std::string generationRoot(const std::string& userId, const std::string& generation) {
+    return generation.empty() ? "users/" + userId + "/" : generationKey(userId, generation) + "/";
+}
+
+std::string chunkKey(const std::string& userId, const std::string& generation, const std::string& prefix, size_t index) {
+    return generationRoot(userId, generation) + "chunks/" + prefix + std::to_string(index);
+}
+
+std::string pageKey(const std::string& userId, const std::string& generation, const std::string& prefix, size_t index) {
+    return generationRoot(userId, generation) + "pages/" + prefix + std::to_string(index);
+}
+
+std::string generationKey(const std::string& userId, const std::string& generation) {
+    return "users/" + userId + "/generations/" + generation;
+}
+
+std::string patchPrefix(const std::string& prefix) {
+    return prefix + "p";
+}
+
+std::string nodeKey(const std::string& userId, const std::string& nodeId) {
+    return "users/" + userId + "/keys/" + nodeId;
+}
+
+}
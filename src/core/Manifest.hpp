@@ -0,0 +1,104 @@
+/**
+ * BetterSave - Manifest
+ * Cloud save metadata (users/<id>/saveData), index pages (users/<id>/generations/<g>/pages/<prefix><n>)
+ * and chunk framing (users/<id>/generations/<g>/chunks/<prefix><n>). Prefixes are "gm" and "ll", "gmp"
+ * and "llp" for patches, "gmk" for the index of a CCGameManager.dat stored key by key
+ * (users/<id>/keys/<node id>). Saves from before generations keep theirs in users/<id>/chunks and pages.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+struct SaveManifest {
+    int gmChunks = 0;
+    int llChunks = 0;
+    int64_t timestamp = 0;
+    std::string gmChecksum;
+    std::string llChecksum;
+    // Hex characters per chunk (the last one may be shorter), 0 for saves uploaded before it was
+    // recorded, which all used DEFAULT_CHUNK_SIZE
+    int gmChunkSize = 0;
+    int llChunkSize = 0;
+    // Index pages per file, 0 for saves uploaded before chunks were paged: those list no
+    // per-chunk checksums and have at most 1000 chunks
+    int gmPages = 0;
+    int llPages = 0;
+    // Set for a file uploaded as a patch (see Delta.hpp) over the chunks above, which then hold
+    // the base with checksum *BaseChecksum. The patch is stored and paged like a file of its own.
+    std::string gmBaseChecksum;
+    std::string llBaseChecksum;
+    int gmPatchChunks = 0;
+    int llPatchChunks = 0;
+    int gmPatchPages = 0;
+    int llPatchPages = 0;
+    // Set for a CCGameManager.dat stored key by key (see KeySync.hpp) instead of in chunks: the
+    // nodes its index pages list and the checksum of the plist they join into. gmChecksum is still
+    // the file that was uploaded, a restore encodes the plist again so its bytes may differ.
+    int gmKeyNodes = 0;
+    int gmKeyPages = 0;
+    std::string gmPlistChecksum;
+    // Generation each file's chunks and index pages were written under. Every upload writes the
+    // files it changes under a new generation, so until the manifest points at it nothing the
+    // committed save needs is touched. Empty for files uploaded before generations.
+    std::string gmGeneration;
+    std::string llGeneration;
+    // Same for a patch, which is written under a newer generation than the base it applies to
+    std::string gmPatchGeneration;
+    std::string llPatchGeneration;
+};
+
+// Chunks listed per index page. Paging keeps the manifest and every page small however many
+// chunks a file has, and pages download in parallel.
+constexpr int CHUNKS_PER_PAGE = 1000;
+// Checksums are always 8 characters, so pages store them back to back without separators
+constexpr size_t CHECKSUM_LENGTH = 8;
+
+struct IndexPage {
+    // Index of the page's first chunk
+    int first = 0;
+    // checksumHex of each chunk's hex text, in order (node ids in a key index page)
+    std::vector<std::string> checksums;
+};
+
+int pageCount(size_t chunks);
+
+// {"s": first, "c": "<8 hex characters per chunk>"}
+std::string serializePage(const IndexPage& page);
+// entryLength is the characters per entry, NODE_ID_LENGTH for key index pages
+std::optional<IndexPage> parsePage(const std::string& body, size_t entryLength = CHECKSUM_LENGTH);
+// Checksums of chunks [0, chunkCount) from a file's pages in order. nullopt if the pages don't
+// cover exactly those chunks.
+std::optional<std::vector<std::string>> joinPages(const std::vector<IndexPage>& pages, int chunkCount);
+
+std::string serializeManifest(const SaveManifest& manifest);
+// nullopt if the body isn't a manifest (e.g. "null" when no cloud save exists)
+std::optional<SaveManifest> parseManifest(const std::string& body);
+
+// A chunk is stored as {"d": "<hex>"}
+std::string frameChunk(const std::string& chunk);
+std::optional<std::string> unframeChunk(const std::string& body);
+
+// True if any of manifest's files is stored under generation
+bool usesGeneration(const SaveManifest& manifest, const std::string& generation);
+// 8 random hex characters, a generation stored (if any) doesn't use
+std::string newGeneration(const SaveManifest* stored = nullptr);
+
+// Storage keys, shared by the Firebase and local directory backends. An empty generation is the
+// layout from before generations.
+std::string manifestKey(const std::string& userId);
+std::string chunkKey(const std::string& userId, const std::string& generation, const std::string& prefix, size_t index);
+std::string pageKey(const std::string& userId, const std::string& generation, const std::string& prefix, size_t index);
+// Everything written under a generation, removed as a whole once no manifest points at it
+std::string generationKey(const std::string& userId, const std::string& generation);
+// Where a file's patch is stored, "gm" -> "gmp"
+std::string patchPrefix(const std::string& prefix);
+// One node of a CCGameManager.dat stored key by key
+std::string nodeKey(const std::string& userId, const std::string& nodeId);
+
+}
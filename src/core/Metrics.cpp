@@ -0,0 +1,223 @@
+/**
+ * BetterSave - Metrics
+ * Created by: sidastuff
+ */
+
+#include "Metrics.hpp"
+#include "Json.hpp"
+#include "SaveFiles.hpp"
+#include <bit>
+#include <cmath>
+#include <cstdio>
+
+namespace bettersave::core {
+
+MetricsRegistry* MetricsRegistry::s_instance = nullptr;
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    // Keep the top SUB_BUCKET_BITS + 1 bits, the highest one picks the power of two
+    int shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+    uint64_t top = value >> shift;
+    return static_cast<size_t>((shift + 1) * SUB_BUCKETS + (top - SUB_BUCKETS));
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t top = SUB_BUCKETS + index % SUB_BUCKETS;
+    // The very last bucket ends at UINT64_MAX, shifting past it would overflow
+    if (top + 1 == 2 * SUB_BUCKETS && shift + SUB_BUCKET_BITS + 1 == 64) {
+        return UINT64_MAX;
+    }
+    return ((top + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = m_min.load(std::memory_order_relaxed);
+    while (value < current && !m_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    current = m_max.load(std::memory_order_relaxed);
+    while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+uint64_t Histogram::percentile(double percentile) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    // Rank of the value we want, 1-based: p50 of 10 values is the 5th
+    auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total)));
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    uint64_t result = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            result = bucketUpperBound(i);
+            break;
+        }
+    }
+
+    // The bucket bound can overshoot what was actually recorded
+    uint64_t min = m_min.load(std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    if (seen < rank || result > max) result = max;
+    if (result < min) result = min;
+    return result;
+}
+
+HistogramSummary Histogram::summary() const {
+    HistogramSummary summary;
+    summary.count = count();
+    if (summary.count == 0) {
+        return summary;
+    }
+    summary.min = m_min.load(std::memory_order_relaxed);
+    summary.max = m_max.load(std::memory_order_relaxed);
+    summary.mean = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(summary.count);
+    summary.p50 = percentile(50);
+    summary.p95 = percentile(95);
+    summary.p99 = percentile(99);
+    return summary;
+}
+
+void Histogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+template <class T>
+static T& findOrCreate(std::map<std::string, std::unique_ptr<T>>& metrics, const std::string& name) {
+    auto& metric = metrics[name];
+    if (!metric) {
+        metric = std::make_unique<T>();
+    }
+    return *metric;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name) {
+    std::lock_guard lock(m_mutex);
+    return findOrCreate(m_counters, name);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name) {
+    std::lock_guard lock(m_mutex);
+    return findOrCreate(m_gauges, name);
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name) {
+    std::lock_guard lock(m_mutex);
+    return findOrCreate(m_histograms, name);
+}
+
+void MetricsRegistry::setLabel(const std::string& key, const std::string& value) {
+    std::lock_guard lock(m_mutex);
+    m_labels[key] = value;
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    std::lock_guard lock(m_mutex);
+    MetricsSnapshot snapshot;
+    snapshot.labels = m_labels;
+    for (const auto& [name, counter] : m_counters) {
+        snapshot.counters.emplace_back(name, counter->value());
+    }
+    for (const auto& [name, gauge] : m_gauges) {
+        snapshot.gauges.emplace_back(name, gauge->value());
+    }
+    for (const auto& [name, histogram] : m_histograms) {
+        snapshot.histograms.emplace_back(name, histogram->summary());
+    }
+    return snapshot;
+}
+
+static std::string formatNumber(double value) {
+    if (!std::isfinite(value)) {
+        return "0";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+    return buffer;
+}
+
+std::string MetricsRegistry::toJson() const {
+    auto data = snapshot();
+
+    std::string out = "{\n  \"labels\": {";
+    bool first = true;
+    for (const auto& [key, value] : data.labels) {
+        out += first ? "\n    " : ",\n    ";
+        first = false;
+        appendJsonString(out, key);
+        out += ": ";
+        appendJsonString(out, value);
+    }
+    out += first ? "},\n" : "\n  },\n";
+
+    out += "  \"counters\": {";
+    first = true;
+    for (const auto& [name, value] : data.counters) {
+        out += first ? "\n    " : ",\n    ";
+        first = false;
+        appendJsonString(out, name);
+        out += ": " + std::to_string(value);
+    }
+    out += first ? "},\n" : "\n  },\n";
+
+    out += "  \"gauges\": {";
+    first = true;
+    for (const auto& [name, value] : data.gauges) {
+        out += first ? "\n    " : ",\n    ";
+        first = false;
+        appendJsonString(out, name);
+        out += ": " + formatNumber(value);
+    }
+    out += first ? "},\n" : "\n  },\n";
+
+    out += "  \"histograms\": {";
+    first = true;
+    for (const auto& [name, summary] : data.histograms) {
+        out += first ? "\n    " : ",\n    ";
+        first = false;
+        appendJsonString(out, name);
+        out += ": {\"count\": " + std::to_string(summary.count) +
+               ", \"min\": " + std::to_string(summary.min) +
+               ", \"max\": " + std::to_string(summary.max) +
+               ", \"mean\": " + formatNumber(summary.mean) +
+               ", \"p50\": " + std::to_string(summary.p50) +
+               ", \"p95\": " + std::to_string(summary.p95) +
+               ", \"p99\": " + std::to_string(summary.p99) + "}";
+    }
+    out += first ? "}\n" : "\n  }\n";
+
+    out += "}\n";
+    return out;
+}
+
+bool MetricsRegistry::exportJson(const std::filesystem::path& path) const {
+    return replaceFile(path, toJson());
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard lock(m_mutex);
+    for (auto& [name, counter] : m_counters) counter->reset();
+    for (auto& [name, gauge] : m_gauges) gauge->reset();
+    for (auto& [name, histogram] : m_histograms) histogram->reset();
+}
+
+}
@@ -0,0 +1,119 @@
+/**
+ * BetterSave - Metrics
+ * Counters, gauges and latency histograms for transfers, exported as JSON
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+class Counter {
+private:
+    std::atomic<int64_t> m_value{0};
+
+public:
+    void add(int64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+};
+
+class Gauge {
+private:
+    std::atomic<double> m_value{0};
+
+public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+};
+
+struct HistogramSummary {
+    uint64_t count = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    double mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+};
+
+// HDR-style log-linear buckets: exact below 32, then 16 buckets per power of two (within ~6%).
+// Recording is lock-free, so request callbacks on any thread can record directly.
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (65 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    static size_t bucketIndex(uint64_t value);
+    // Largest value that lands in the bucket
+    static uint64_t bucketUpperBound(size_t index);
+
+    void record(uint64_t value);
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    // percentile in [0, 100], 0 if nothing was recorded
+    uint64_t percentile(double percentile) const;
+    HistogramSummary summary() const;
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_min{UINT64_MAX};
+    std::atomic<uint64_t> m_max{0};
+};
+
+struct MetricsSnapshot {
+    std::map<std::string, std::string> labels;
+    std::vector<std::pair<std::string, int64_t>> counters;
+    std::vector<std::pair<std::string, double>> gauges;
+    std::vector<std::pair<std::string, HistogramSummary>> histograms;
+};
+
+class MetricsRegistry {
+private:
+    static MetricsRegistry* s_instance;
+    mutable std::mutex m_mutex;
+    // Metrics are never removed, so references handed out stay valid for the whole session
+    std::map<std::string, std::unique_ptr<Counter>> m_counters;
+    std::map<std::string, std::unique_ptr<Gauge>> m_gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> m_histograms;
+    std::map<std::string, std::string> m_labels;
+
+public:
+    // Recorded from pool workers and network callbacks alike, any of them may be the first caller
+    static MetricsRegistry* get() {
+        static std::once_flag s_created;
+        std::call_once(s_created, []() { s_instance = new MetricsRegistry(); });
+        return s_instance;
+    }
+
+    // Created on first use. Hot paths should keep the reference instead of looking it up each time.
+    Counter& counter(const std::string& name);
+    Gauge& gauge(const std::string& name);
+    // Durations are recorded in microseconds, the name should end in _us
+    Histogram& histogram(const std::string& name);
+
+    // Exported with the values so reports can be compared across releases and devices
+    void setLabel(const std::string& key, const std::string& value);
+
+    MetricsSnapshot snapshot() const;
+    std::string toJson() const;
+    bool exportJson(const std::filesystem::path& path) const;
+
+    // Zeroes every metric, labels are kept
+    void reset();
+};
+
+}
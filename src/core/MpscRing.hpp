@@ -0,0 +1,81 @@
+/**
+ * BetterSave - MPSC Ring
+ * Bounded lock-free queue: any thread may push, one thread pops.
+ * Pushing never blocks or allocates; a full ring rejects the value.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace bettersave::core {
+
+template <class T>
+class MpscRing {
+private:
+    // Each slot's sequence says whose turn it is: == position means free for that push,
+    // == position + 1 means filled and ready to pop
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) size_t m_tail = 0;
+
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_slots = std::make_unique<Slot[]>(size);
+        m_mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    bool tryPush(T&& value) {
+        size_t position = m_head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[position & m_mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T& out) {
+        Slot* slot = &m_slots[m_tail & m_mask];
+        if (slot->sequence.load(std::memory_order_acquire) != m_tail + 1) return false;
+
+        out = std::move(slot->value);
+        slot->sequence.store(m_tail + m_mask + 1, std::memory_order_release);
+        m_tail++;
+        return true;
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+};
+
+}
@@ -0,0 +1,199 @@
+/**
+ * BetterSave - Plist
+ * Created by: sidastuff
+ */
+
+#include "Plist.hpp"
+#include "Integrity.hpp"
+#include "Trace.hpp"
+#include <string_view>
+
+namespace bettersave::core {
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static size_t skipSpace(const std::string& text, size_t pos, size_t end) {
+    while (pos < end && isSpace(text[pos])) pos++;
+    return pos;
+}
+
+static bool isKeyTag(std::string_view name) {
+    return name == "k" || name == "key";
+}
+
+static bool isDictTag(std::string_view name) {
+    return name == "d" || name == "dict";
+}
+
+struct Tag {
+    std::string_view name;
+    // Just past the '>'
+    size_t end = 0;
+    bool closing = false;
+    bool selfClosing = false;
+};
+
+// The tag starting at pos, nullopt if there is none
+static std::optional<Tag> readTag(const std::string& text, size_t pos, size_t end) {
+    if (pos >= end || text[pos] != '<') return std::nullopt;
+    size_t close = text.find('>', pos);
+    if (close == std::string::npos || close >= end) return std::nullopt;
+
+    Tag tag;
+    size_t nameStart = pos + 1;
+    if (nameStart < close && text[nameStart] == '/') {
+        tag.closing = true;
+        nameStart++;
+    }
+    size_t nameEnd = nameStart;
+    while (nameEnd < close && !isSpace(text[nameEnd]) && text[nameEnd] != '/') nameEnd++;
+    if (nameEnd == nameStart) return std::nullopt;
+
+    tag.name = std::string_view(text).substr(nameStart, nameEnd - nameStart);
+    tag.selfClosing = !tag.closing && text[close - 1] == '/';
+    tag.end = close + 1;
+    return tag;
+}
+
+// End of the element starting at pos, nullopt if it doesn't close before end. Text between tags
+// never holds a '<' (it's escaped), so counting open and close tags is enough.
+static std::optional<size_t> elementEnd(const std::string& text, size_t pos, size_t end) {
+    auto tag = readTag(text, pos, end);
+    if (!tag || tag->closing) return std::nullopt;
+    if (tag->selfClosing) return tag->end;
+
+    int depth = 1;
+    size_t cursor = tag->end;
+    while (depth > 0) {
+        size_t next = text.find('<', cursor);
+        if (next == std::string::npos || next >= end) return std::nullopt;
+        auto inner = readTag(text, next, end);
+        if (!inner) return std::nullopt;
+        if (inner->closing) {
+            depth--;
+        } else if (!inner->selfClosing) {
+            depth++;
+        }
+        cursor = inner->end;
+    }
+    return cursor;
+}
+
+struct Entry {
+    std::string key;
+    // Where its key tag starts and its value ends
+    size_t start = 0;
+    size_t end = 0;
+    size_t valueStart = 0;
+};
+
+// Entries of a dict whose contents are [begin, end), nullopt if it holds anything else
+static std::optional<std::vector<Entry>> readEntries(const std::string& text, size_t begin, size_t end) {
+    std::vector<Entry> entries;
+    size_t pos = skipSpace(text, begin, end);
+    while (pos < end) {
+        auto keyOpen = readTag(text, pos, end);
+        if (!keyOpen || keyOpen->closing || keyOpen->selfClosing || !isKeyTag(keyOpen->name)) return std::nullopt;
+        size_t keyCloseAt = text.find('<', keyOpen->end);
+        auto keyClose = keyCloseAt == std::string::npos ? std::nullopt : readTag(text, keyCloseAt, end);
+        if (!keyClose || !keyClose->closing || keyClose->name != keyOpen->name) return std::nullopt;
+
+        Entry entry;
+        entry.key = text.substr(keyOpen->end, keyCloseAt - keyOpen->end);
+        entry.start = pos;
+        entry.valueStart = skipSpace(text, keyClose->end, end);
+        auto valueEnd = elementEnd(text, entry.valueStart, end);
+        if (!valueEnd) return std::nullopt;
+        entry.end = *valueEnd;
+        pos = skipSpace(text, entry.end, end);
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+// Where each node starts and what it's called, in order
+struct Cut {
+    size_t start = 0;
+    std::string path;
+};
+
+// A node runs from its cut to the next one. The first entry of a split dict starts where the
+// dict's own entry did, so it carries the dict's key and opening tag, and the last one runs up to
+// the next entry, so it carries the closing tag.
+static void cutEntries(const std::string& text, const std::vector<Entry>& entries, const std::string& parent,
+                       size_t firstStart, size_t splitSize, std::vector<Cut>& cuts) {
+    bool newNode = true;
+    size_t nodeStart = firstStart;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& entry = entries[i];
+        auto path = parent.empty() ? entry.key : parent + "/" + entry.key;
+        size_t start = i == 0 ? firstStart : entry.start;
+        size_t size = entry.end - entry.start;
+
+        if (size > splitSize) {
+            auto open = readTag(text, entry.valueStart, entry.end);
+            if (open && isDictTag(open->name) && !open->selfClosing) {
+                size_t closeStart = text.rfind('<', entry.end - 1);
+                auto children = readEntries(text, open->end, closeStart);
+                if (children && !children->empty()) {
+                    cutEntries(text, *children, path, start, splitSize, cuts);
+                    newNode = true;
+                    continue;
+                }
+            }
+        }
+
+        bool alone = size >= splitSize / 4;
+        if (newNode || alone) {
+            cuts.push_back({start, std::move(path)});
+            nodeStart = start;
+        }
+        auto keyChecksum = crc32(reinterpret_cast<const uint8_t*>(entry.key.data()), entry.key.size());
+        newNode = alone || keyChecksum % PLIST_RUN_KEYS == 0 || entry.end - nodeStart >= splitSize;
+    }
+}
+
+std::optional<std::vector<PlistNode>> splitPlist(const std::string& plist, size_t splitSize) {
+    TraceSpan span("split_plist", "encode");
+    span.arg("bytes", static_cast<int64_t>(plist.size()));
+
+    size_t plistAt = plist.find("<plist");
+    auto plistTag = plistAt == std::string::npos ? std::nullopt : readTag(plist, plistAt, plist.size());
+    if (!plistTag || plistTag->closing || plistTag->selfClosing) return std::nullopt;
+
+    size_t rootAt = skipSpace(plist, plistTag->end, plist.size());
+    auto root = readTag(plist, rootAt, plist.size());
+    if (!root || root->closing || root->selfClosing || !isDictTag(root->name)) return std::nullopt;
+    auto rootEnd = elementEnd(plist, rootAt, plist.size());
+    if (!rootEnd) return std::nullopt;
+
+    auto entries = readEntries(plist, root->end, plist.rfind('<', *rootEnd - 1));
+    if (!entries || entries->empty()) return std::nullopt;
+
+    // The first node also carries everything before the first key, the last everything after it
+    std::vector<Cut> cuts;
+    cutEntries(plist, *entries, "", 0, splitSize, cuts);
+
+    std::vector<PlistNode> nodes;
+    nodes.reserve(cuts.size());
+    for (size_t i = 0; i < cuts.size(); i++) {
+        size_t end = i + 1 < cuts.size() ? cuts[i + 1].start : plist.size();
+        nodes.push_back({std::move(cuts[i].path), plist.substr(cuts[i].start, end - cuts[i].start)});
+    }
+    span.arg("nodes", static_cast<int64_t>(nodes.size()));
+    return nodes;
+}
+
+std::string joinPlist(const std::vector<PlistNode>& nodes) {
+    size_t size = 0;
+    for (const auto& node : nodes) size += node.text.size();
+
+    std::string plist;
+    plist.reserve(size);
+    for (const auto& node : nodes) plist += node.text;
+    return plist;
+}
+
+}
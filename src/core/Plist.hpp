@@ -0,0 +1,53 @@
+/**
+ * BetterSave - Plist
+ * Splits the plist Geometry Dash keeps inside a save file into nodes of a key or a few, so two
+ * versions of a save can be compared and stored key by key
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+// Turns a save file into its plist and back. GD wraps the plist in gzip, base64 and XOR (see
+// src/synth/GdFormat.hpp) and core doesn't link zlib, so the caller brings the codec: the mod uses
+// the game's own, the command line tool zlib. Both are called from worker threads.
+struct SaveFileCodec {
+    // nullopt if the file isn't in a format the codec knows
+    std::function<std::optional<std::string>(const std::string& file)> decode;
+    std::function<std::string(const std::string& plist)> encode;
+};
+
+// One dict entry, or a run of small neighbouring ones
+struct PlistNode {
+    // Keys from the root dict down to the (first) entry, joined with '/'
+    std::string path;
+    // The entries' XML exactly as it is in the plist, plus the markup around them that belongs to
+    // no entry: the header before the first key, and the tags opening and closing a split dict
+    std::string text;
+};
+
+// Entries whose XML is larger than this are split into their own entries when they hold a dict,
+// recursively. Keeps nodes small where GD keeps thousands of keys in one dict (GLM_03, GS_value).
+// It's also the most a run of small entries grows to, and entries of a quarter of it stand alone.
+constexpr size_t PLIST_SPLIT_SIZE = 16 * 1024;
+
+// Small entries go in runs of about this many, a single one would barely compress. A run ends
+// after a key picked by its checksum rather than by position, so adding or removing a key only
+// changes the run it's in.
+constexpr uint32_t PLIST_RUN_KEYS = 16;
+
+// Reads GD's compact tags (<k>, <d>, <s>, <t />) as well as standard plist ones (<key>, <dict>).
+// nullopt if plist isn't a plist whose root dict has at least one key.
+std::optional<std::vector<PlistNode>> splitPlist(const std::string& plist, size_t splitSize = PLIST_SPLIT_SIZE);
+
+// The plist back, byte for byte
+std::string joinPlist(const std::vector<PlistNode>& nodes);
+
+}
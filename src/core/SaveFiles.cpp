@@ -0,0 +1,126 @@
+/**
+ * BetterSave - Save Files
+ * Created by: sidastuff
+ */
+
+#include "SaveFiles.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace bettersave::core {
+
+std::vector<std::string> managedSaveFiles() {
+    return {"CCGameManager.dat", "CCGameManager2.dat", "CCLocalLevels.dat", "CCLocalLevels2.dat"};
+}
+
+std::optional<std::string> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void writeFileSynced(const std::filesystem::path& path, const std::string& data) {
+    TraceSpan span("write_file", "disk");
+    span.arg("file", path.filename().string()).arg("bytes", static_cast<int64_t>(data.size()));
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open " + path.filename().string() + " for writing");
+        }
+        file.write(data.data(), data.size());
+
+        // Force flush to OS
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("Could not write " + path.filename().string());
+        }
+    }
+
+    // Sync to disk (platform specific)
+    #ifdef _WIN32
+        FILE* f = fopen(path.string().c_str(), "rb+");
+        if (f) {
+            fflush(f);
+            _commit(_fileno(f));
+            fclose(f);
+        }
+    #else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    #endif
+}
+
+bool replaceFile(const std::filesystem::path& path, const std::string& data) {
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(data.data(), data.size());
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    return !error;
+}
+
+std::filesystem::path snapshotSaveFiles(const std::filesystem::path& saveDir,
+                                        const std::filesystem::path& snapshotsRoot, size_t keepCount) {
+    TraceSpan span("snapshot", "disk");
+
+    auto now = std::chrono::system_clock::now();
+    auto time = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time), "%Y%m%d-%H%M%S");
+
+    auto snapshotDir = snapshotsRoot / ss.str();
+    std::filesystem::create_directories(snapshotDir);
+
+    for (const auto& fileName : managedSaveFiles()) {
+        auto source = saveDir / fileName;
+        if (std::filesystem::exists(source)) {
+            std::filesystem::copy_file(source, snapshotDir / fileName, std::filesystem::copy_options::overwrite_existing);
+        }
+    }
+
+    // Timestamped names sort chronologically, drop the oldest beyond the limit
+    std::vector<std::filesystem::path> snapshots;
+    for (const auto& entry : std::filesystem::directory_iterator(snapshotsRoot)) {
+        if (entry.is_directory()) snapshots.push_back(entry.path());
+    }
+    std::sort(snapshots.begin(), snapshots.end());
+    while (snapshots.size() > keepCount) {
+        std::filesystem::remove_all(snapshots.front());
+        snapshots.erase(snapshots.begin());
+    }
+
+    return snapshotDir;
+}
+
+}
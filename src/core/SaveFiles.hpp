@@ -0,0 +1,35 @@
+/**
+ * BetterSave - Save Files
+ * Reading, writing and snapshotting the save files in a save directory
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+constexpr const char* GAME_MANAGER_FILE = "CCGameManager.dat";
+constexpr const char* LOCAL_LEVELS_FILE = "CCLocalLevels.dat";
+
+// Every save file BetterSave manages, primary copy first (GD keeps *2.dat backups)
+std::vector<std::string> managedSaveFiles();
+
+std::optional<std::string> readFile(const std::filesystem::path& path);
+
+// Write and force the data to disk. Throws std::runtime_error on failure.
+void writeFileSynced(const std::filesystem::path& path, const std::string& data);
+
+// Write to <path>.tmp and rename it over path, so readers never see a half-written file.
+// For reports that can be regenerated, nothing is fsynced.
+bool replaceFile(const std::filesystem::path& path, const std::string& data);
+
+// Copy the managed files in saveDir to snapshotsRoot/<YYYYmmdd-HHMMSS>, keeping the newest keepCount.
+// Returns the snapshot directory, throws on filesystem errors.
+std::filesystem::path snapshotSaveFiles(const std::filesystem::path& saveDir,
+                                        const std::filesystem::path& snapshotsRoot, size_t keepCount);
+
+}
@@ -0,0 +1,50 @@
+/**
+ * BetterSave - Storage
+ * Created by: sidastuff
+ */
+
+#include "Storage.hpp"
+#include "SaveFiles.hpp"
+#include <fstream>
+#include <iterator>
+
+namespace bettersave::core {
+
+DirectoryStorage::DirectoryStorage(std::filesystem::path root) : m_root(std::move(root)) {}
+
+std::filesystem::path DirectoryStorage::pathFor(const std::string& key) const {
+    return m_root / (key + ".json");
+}
+
+bool DirectoryStorage::put(const std::string& key, const std::string& body) {
+    try {
+        auto path = pathFor(key);
+        std::filesystem::create_directories(path.parent_path());
+
+        // Write next to the target and rename, readers never see a half-written document
+        auto tempPath = path;
+        tempPath += ".tmp";
+        writeFileSynced(tempPath, body);
+        std::filesystem::rename(tempPath, path);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::optional<std::string> DirectoryStorage::get(const std::string& key) {
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+bool DirectoryStorage::remove(const std::string& key) {
+    std::error_code error;
+    bool removed = std::filesystem::remove(pathFor(key), error);
+    auto children = std::filesystem::remove_all(m_root / key, error);
+    return removed || (!error && children > 0);
+}
+
+}
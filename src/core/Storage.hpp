@@ -0,0 +1,40 @@
+/**
+ * BetterSave - Storage
+ * Synchronous key/value backend for the cloud save layout
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace bettersave::core {
+
+class Storage {
+public:
+    virtual ~Storage() = default;
+
+    // Keys look like "users/<id>/chunks/gm0", bodies are JSON documents
+    virtual bool put(const std::string& key, const std::string& body) = 0;
+    virtual std::optional<std::string> get(const std::string& key) = 0;
+    // Removes everything under the key too, like deleting a Realtime Database path
+    virtual bool remove(const std::string& key) = 0;
+};
+
+// Mirrors the Realtime Database layout on disk: <root>/<key>.json, keys under it in <root>/<key>/
+class DirectoryStorage : public Storage {
+private:
+    std::filesystem::path m_root;
+
+    std::filesystem::path pathFor(const std::string& key) const;
+
+public:
+    explicit DirectoryStorage(std::filesystem::path root);
+
+    bool put(const std::string& key, const std::string& body) override;
+    std::optional<std::string> get(const std::string& key) override;
+    bool remove(const std::string& key) override;
+};
+
+}
@@ -0,0 +1,86 @@
+/**
+ * BetterSave - Task
+ * Created by: sidastuff
+ */
+
+#include "Task.hpp"
+#include <memory>
+
+namespace bettersave::core {
+
+void spawn(Task<void> task, std::function<void(std::exception_ptr)> onDone) {
+    [](Task<void> task, std::function<void(std::exception_ptr)> onDone) -> detail::Detached {
+        std::exception_ptr error;
+        try {
+            co_await std::move(task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        if (onDone) onDone(error);
+    }(std::move(task), std::move(onDone));
+}
+
+namespace detail {
+
+struct RunAllState {
+    size_t count = 0;
+    size_t maxConcurrent = 0;
+    const CancellationToken* cancel = nullptr;
+    std::function<Task<void>(size_t)> run;
+
+    size_t next = 0;
+    size_t running = 0;
+    std::exception_ptr error;
+    bool pumping = false;
+    std::function<void()> onFinished;
+
+    bool stopped() const { return error || (cancel && cancel->isCancelled()); }
+
+    // Starts what the limit allows. Tasks that finish right away are picked up by the same loop
+    // instead of recursing, so thousands of instant tasks don't grow the stack.
+    void pump(const std::shared_ptr<RunAllState>& self) {
+        if (pumping) return;
+        pumping = true;
+        while (!stopped() && next < count && (maxConcurrent == 0 || running < maxConcurrent)) {
+            size_t index = next++;
+            running++;
+            spawn(run(index), [self](std::exception_ptr taskError) {
+                self->running--;
+                if (taskError && !self->error) self->error = taskError;
+                self->pump(self);
+            });
+        }
+        pumping = false;
+
+        if (running == 0 && (next == count || stopped()) && onFinished) {
+            auto finished = std::move(onFinished);
+            onFinished = nullptr;
+            finished();
+        }
+    }
+};
+
+Task<void> runAll(size_t count, size_t maxConcurrent, const CancellationToken* cancel, std::function<Task<void>(size_t)> run) {
+    auto state = std::make_shared<RunAllState>();
+    state->count = count;
+    state->maxConcurrent = maxConcurrent;
+    state->cancel = cancel;
+    state->run = std::move(run);
+
+    CallbackAwaiter<void> finished([state](std::function<void()> resume) {
+        state->onFinished = std::move(resume);
+        state->pump(state);
+    });
+    co_await finished;
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+    if (state->next < count) {
+        throw OperationCancelled();
+    }
+}
+
+}
+
+}
@@ -0,0 +1,217 @@
+/**
+ * BetterSave - Task
+ * Lazy C++20 coroutine tasks, so multi-request operations read top to bottom instead of
+ * nesting a callback per request. A task starts when awaited (or spawned) and resumes its
+ * awaiter on whichever thread it finishes on.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "Cancellation.hpp"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace bettersave::core {
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+// Hands control back to whoever awaited the task once it returns
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        auto continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <class U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    T takeResult() {
+        if (exception) std::rethrow_exception(exception);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void takeResult() {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+// Fire-and-forget frame that frees itself, used by spawn()
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+}
+
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    // Starts the task and suspends the caller until it returns (or rethrows what it threw)
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().takeResult(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail {
+
+template <class T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+}
+
+// Awaits a callback-style API. start gets a resume function that must be called exactly once,
+// on any thread (the coroutine continues on that thread), possibly before start returns.
+// Keep it in a named local: GCC 12 destroys capturing lambdas built inside a co_await twice.
+template <class T>
+class CallbackAwaiter {
+private:
+    std::function<void(std::function<void(T)>)> m_start;
+    std::optional<T> m_value;
+    std::coroutine_handle<> m_handle;
+    // Set by whichever of await_suspend and the callback gets there first
+    std::atomic<bool> m_raced{false};
+
+public:
+    explicit CallbackAwaiter(std::function<void(std::function<void(T)>)> start) : m_start(std::move(start)) {}
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+        m_handle = handle;
+        m_start([this](T value) {
+            m_value.emplace(std::move(value));
+            if (m_raced.exchange(true, std::memory_order_acq_rel)) m_handle.resume();
+        });
+        // Already called back: don't suspend, nobody else will resume us
+        return !m_raced.exchange(true, std::memory_order_acq_rel);
+    }
+    T await_resume() { return std::move(*m_value); }
+};
+
+template <>
+class CallbackAwaiter<void> {
+private:
+    std::function<void(std::function<void()>)> m_start;
+    std::coroutine_handle<> m_handle;
+    std::atomic<bool> m_raced{false};
+
+public:
+    explicit CallbackAwaiter(std::function<void(std::function<void()>)> start) : m_start(std::move(start)) {}
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+        m_handle = handle;
+        m_start([this]() {
+            if (m_raced.exchange(true, std::memory_order_acq_rel)) m_handle.resume();
+        });
+        return !m_raced.exchange(true, std::memory_order_acq_rel);
+    }
+    void await_resume() const noexcept {}
+};
+
+// Starts a task nobody awaits. onDone gets what it threw, or nullptr once it returned.
+void spawn(Task<void> task, std::function<void(std::exception_ptr)> onDone);
+
+namespace detail {
+Task<void> runAll(size_t count, size_t maxConcurrent, const CancellationToken* cancel, std::function<Task<void>(size_t)> run);
+}
+
+// Runs the tasks with at most maxConcurrent started at a time (0 = all at once) and returns their
+// results in order. After the first failure, or once cancel is cancelled, nothing new is started;
+// the running ones are still awaited, then the first exception (or OperationCancelled) is rethrown.
+// Not thread-safe: the tasks must all finish on the same thread, like request callbacks do.
+template <class T>
+Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks, size_t maxConcurrent = 0, const CancellationToken* cancel = nullptr) {
+    std::vector<std::optional<T>> slots(tasks.size());
+    auto all = detail::runAll(tasks.size(), maxConcurrent, cancel, [&tasks, &slots](size_t index) -> Task<void> {
+        slots[index].emplace(co_await std::move(tasks[index]));
+    });
+    co_await std::move(all);
+
+    std::vector<T> results;
+    results.reserve(slots.size());
+    for (auto& slot : slots) {
+        results.push_back(std::move(*slot));
+    }
+    co_return results;
+}
+
+inline Task<void> whenAll(std::vector<Task<void>> tasks, size_t maxConcurrent = 0, const CancellationToken* cancel = nullptr) {
+    auto all = detail::runAll(tasks.size(), maxConcurrent, cancel, [&tasks](size_t index) -> Task<void> {
+        co_await std::move(tasks[index]);
+    });
+    co_await std::move(all);
+}
+
+}
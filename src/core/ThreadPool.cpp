@@ -0,0 +1,240 @@
+/**
+ * BetterSave - Thread Pool
+ * Created by: sidastuff
+ */
+
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <exception>
+#include <string>
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+    #include <sys/qos.h>
+#elif defined(__linux__)
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace bettersave::core {
+
+ThreadPool* ThreadPool::s_instance = nullptr;
+
+// Which pool (if any) the current thread works for, so submit() can use its own queue
+static thread_local ThreadPool* t_pool = nullptr;
+static thread_local size_t t_workerIndex = 0;
+
+static void lowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+    // Linux applies nice values per thread id
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    // hardware_concurrency() may be 0 when unknown
+    size_t cores = std::max(std::thread::hardware_concurrency(), 2u);
+    return cores - 1;
+}
+
+ThreadPool::ThreadPool(size_t threadCount, bool lowPriority)
+    : m_lowPriority(lowPriority),
+      m_tasks(MetricsRegistry::get()->counter("pool.tasks")),
+      m_steals(MetricsRegistry::get()->counter("pool.steals")),
+      m_queueDepth(MetricsRegistry::get()->gauge("pool.queue_depth")),
+      m_utilization(MetricsRegistry::get()->gauge("pool.utilization")),
+      m_queueWait(MetricsRegistry::get()->histogram("pool.queue_wait_us")) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    MetricsRegistry::get()->gauge("pool.threads").set(static_cast<double>(threadCount));
+
+    // Singletons the workers use are created here, not raced for by the workers
+    Tracer::get();
+
+    // Every worker exists before any starts, they steal from each other's queues
+    for (size_t i = 0; i < threadCount; i++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        m_workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    m_stopping.store(true);
+    {
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    Job entry{std::move(job), std::chrono::steady_clock::now()};
+    if (t_pool == this) {
+        auto& worker = *m_workers[t_workerIndex];
+        std::lock_guard lock(worker.mutex);
+        worker.jobs.push_back(std::move(entry));
+    } else {
+        std::lock_guard lock(m_injectedMutex);
+        m_injected.push_back(std::move(entry));
+    }
+    m_queued.fetch_add(1);
+    m_tasks.add();
+    updateGauges();
+
+    {
+        // Orders the push before a worker that found nothing goes to sleep, so the wake isn't lost
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool ThreadPool::takeJob(size_t index, Job& job) {
+    {
+        // Newest first from our own queue, its data is most likely still in cache
+        auto& own = *m_workers[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    {
+        std::lock_guard lock(m_injectedMutex);
+        if (!m_injected.empty()) {
+            job = std::move(m_injected.front());
+            m_injected.pop_front();
+            return true;
+        }
+    }
+    // Oldest first from the others, those are the ones their owner would get to last
+    for (size_t offset = 1; offset < m_workers.size(); offset++) {
+        auto& victim = *m_workers[(index + offset) % m_workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            m_steals.add();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    t_pool = this;
+    t_workerIndex = index;
+    if (m_lowPriority) {
+        lowerThreadPriority();
+    }
+    Tracer::get()->setThreadName("pool-" + std::to_string(index));
+
+    while (true) {
+        Job job;
+        if (takeJob(index, job)) {
+            m_queued.fetch_sub(1);
+            m_busy.fetch_add(1);
+            updateGauges();
+            auto waited = std::chrono::steady_clock::now() - job.queuedAt;
+            m_queueWait.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(waited).count()));
+
+            // Jobs report their own errors, one that throws anyway must not take the worker down
+            try {
+                job.run();
+            } catch (...) {}
+
+            m_busy.fetch_sub(1);
+            updateGauges();
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_queued.load() > 0 || m_stopping.load(); });
+        if (m_stopping.load() && m_queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1) {
+        body(0);
+        return;
+    }
+
+    struct State {
+        size_t count = 0;
+        const std::function<void(size_t)>* body = nullptr;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->body = &body;
+
+    // Claims indices until none are left. A helper that starts after the caller returned finds
+    // nothing to claim and never touches body.
+    auto work = [](State& shared) {
+        while (true) {
+            size_t index = shared.next.fetch_add(1);
+            if (index >= shared.count) {
+                return;
+            }
+            if (!shared.failed.load()) {
+                try {
+                    (*shared.body)(index);
+                } catch (...) {
+                    std::lock_guard lock(shared.mutex);
+                    if (!shared.error) shared.error = std::current_exception();
+                    shared.failed.store(true);
+                }
+            }
+            if (shared.finished.fetch_add(1) + 1 == shared.count) {
+                std::lock_guard lock(shared.mutex);
+                shared.done.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(count - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        submit([state, work]() { work(*state); });
+    }
+    work(*state);
+
+    std::unique_lock lock(state->mutex);
+    state->done.wait(lock, [&state, count]() { return state->finished.load() == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+double ThreadPool::utilization() const {
+    return static_cast<double>(m_busy.load(std::memory_order_relaxed)) / static_cast<double>(m_workers.size());
+}
+
+void ThreadPool::updateGauges() {
+    m_queueDepth.set(static_cast<double>(m_queued.load(std::memory_order_relaxed)));
+    m_utilization.set(utilization());
+}
+
+}
@@ -0,0 +1,90 @@
+/**
+ * BetterSave - Thread Pool
+ * Shared workers for CPU-heavy work (encoding, hashing, validation, snapshots).
+ * Each worker runs its own queue newest first and steals the oldest task of another when idle.
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "Metrics.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bettersave::core {
+
+class ThreadPool {
+private:
+    static ThreadPool* s_instance;
+
+    struct Job {
+        std::function<void()> run;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    // Jobs submitted from outside the pool, taken by whichever worker is free first
+    std::mutex m_injectedMutex;
+    std::deque<Job> m_injected;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_queued{0};
+    std::atomic<size_t> m_busy{0};
+    std::atomic<bool> m_stopping{false};
+    bool m_lowPriority;
+
+    Counter& m_tasks;
+    Counter& m_steals;
+    Gauge& m_queueDepth;
+    Gauge& m_utilization;
+    Histogram& m_queueWait;
+
+    void workerLoop(size_t index);
+    bool takeJob(size_t index, Job& job);
+    void updateGauges();
+
+public:
+    // Sized to the cores left over by the main thread, at low priority so the game keeps its frames
+    // Pool tasks and background work reach it from any thread, any of them may be the first caller
+    static ThreadPool* get() {
+        static std::once_flag s_created;
+        std::call_once(s_created, []() { s_instance = new ThreadPool(defaultThreadCount(), true); });
+        return s_instance;
+    }
+    static size_t defaultThreadCount();
+
+    ThreadPool(size_t threadCount, bool lowPriority);
+    // Runs what is still queued, then joins the workers
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // From a worker the job goes on that worker's own queue, otherwise on the shared one
+    void submit(std::function<void()> job);
+
+    // Runs body(i) for every i in [0, count) on the workers and the calling thread and returns once
+    // all have run. After an exception the remaining indices are skipped and it's rethrown.
+    // Callable from a worker too: the caller works through indices instead of just waiting.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t threadCount() const { return m_workers.size(); }
+    size_t queueDepth() const { return m_queued.load(std::memory_order_relaxed); }
+    // Share of workers running a job right now, 0 to 1
+    double utilization() const;
+};
+
+}
@@ -0,0 +1,43 @@
+/**
+ * BetterSave - Token Bucket
+ * Created by: sidastuff
+ */
+
+#include "TokenBucket.hpp"
+#include <algorithm>
+
+namespace bettersave::core {
+
+static std::chrono::nanoseconds intervalFor(const RatePolicy& policy) {
+    double rate = std::max(policy.ratePerSecond, 1e-6);
+    return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate));
+}
+
+TokenBucket::TokenBucket(RatePolicy policy)
+    : m_policy(policy), m_interval(intervalFor(policy)), m_theoreticalArrival(Clock::time_point::min()) {}
+
+void TokenBucket::setPolicy(RatePolicy policy) {
+    m_policy = policy;
+    m_interval = intervalFor(policy);
+}
+
+TokenBucket::Clock::duration TokenBucket::timeUntilAllowed(Clock::time_point now, int cost) const {
+    // A request fits if, after adding its cost, the schedule runs at most `burst` intervals ahead of now
+    auto arrival = std::max(m_theoreticalArrival, now) + m_interval * cost;
+    auto allowedAt = arrival - m_interval * std::max(m_policy.burst, 1);
+    return allowedAt > now ? allowedAt - now : Clock::duration::zero();
+}
+
+bool TokenBucket::tryAcquire(Clock::time_point now, int cost) {
+    if (timeUntilAllowed(now, cost) > Clock::duration::zero()) {
+        return false;
+    }
+    m_theoreticalArrival = std::max(m_theoreticalArrival, now) + m_interval * cost;
+    return true;
+}
+
+void TokenBucket::reset() {
+    m_theoreticalArrival = Clock::time_point::min();
+}
+
+}
@@ -0,0 +1,46 @@
+/**
+ * BetterSave - Token Bucket
+ * GCRA rate limiting on the monotonic clock: a sustained rate plus a burst allowance
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace bettersave::core {
+
+struct RatePolicy {
+    double ratePerSecond = 1;
+    // How many requests may go out back to back after a quiet period
+    int burst = 1;
+};
+
+// Stores a single "theoretical arrival time", so a check is O(1) with no window to reset.
+// Not thread-safe, callers lock around it.
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    RatePolicy m_policy;
+    std::chrono::nanoseconds m_interval;
+    Clock::time_point m_theoreticalArrival;
+
+public:
+    explicit TokenBucket(RatePolicy policy = {});
+
+    const RatePolicy& policy() const { return m_policy; }
+    // Takes effect for the next request, requests already admitted are not re-judged
+    void setPolicy(RatePolicy policy);
+
+    // Admits the request and uses up its cost if it fits now
+    bool tryAcquire(Clock::time_point now = Clock::now(), int cost = 1);
+    // Zero if tryAcquire would succeed now, otherwise how long to wait
+    Clock::duration timeUntilAllowed(Clock::time_point now = Clock::now(), int cost = 1) const;
+
+    // Forget past requests, the full burst is available again
+    void reset();
+};
+
+}
@@ -0,0 +1,212 @@
+/**
+ * BetterSave - Trace
+ * Created by: sidastuff
+ */
+
+#include "Trace.hpp"
+#include "Json.hpp"
+#include "Metrics.hpp"
+#include "SaveFiles.hpp"
+#include <utility>
+#include <vector>
+
+namespace bettersave::core {
+
+Tracer* Tracer::s_instance = nullptr;
+
+Tracer::Tracer() : m_origin(std::chrono::steady_clock::now()) {}
+
+int64_t Tracer::nowMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+uint32_t Tracer::currentThreadId() {
+    static std::atomic<uint32_t> nextId{1};
+    thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    std::lock_guard lock(m_mutex);
+    m_threadNames[currentThreadId()] = name;
+}
+
+void Tracer::record(TraceEvent event) {
+    std::lock_guard lock(m_mutex);
+    m_events.push_back(std::move(event));
+    while (m_events.size() > MAX_EVENTS) {
+        m_events.pop_front();
+        m_droppedEvents++;
+    }
+}
+
+size_t Tracer::eventCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_events.size();
+}
+
+void Tracer::clear() {
+    std::lock_guard lock(m_mutex);
+    m_events.clear();
+    m_droppedEvents = 0;
+}
+
+static void appendEvent(std::string& out, const TraceEvent& event) {
+    out += "{\"name\":";
+    appendJsonString(out, event.name);
+    out += ",\"cat\":";
+    appendJsonString(out, event.category);
+    out += ",\"ph\":\"";
+    out += event.phase;
+    out += "\",\"ts\":" + std::to_string(event.timestampMicros);
+    if (event.phase == 'X') {
+        out += ",\"dur\":" + std::to_string(event.durationMicros);
+    } else {
+        out += ",\"id\":" + std::to_string(event.asyncId);
+    }
+    out += ",\"pid\":1,\"tid\":" + std::to_string(event.threadId);
+    if (!event.args.empty()) {
+        out += ",\"args\":{" + event.args + "}";
+    }
+    out += "}";
+}
+
+std::string Tracer::toChromeJson() const {
+    // Copy under the lock, serializing 64k events shouldn't block the threads recording them
+    std::vector<TraceEvent> events;
+    std::map<uint32_t, std::string> threadNames;
+    uint64_t dropped;
+    {
+        std::lock_guard lock(m_mutex);
+        events.assign(m_events.begin(), m_events.end());
+        threadNames = m_threadNames;
+        dropped = m_droppedEvents;
+    }
+
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& [threadId, name] : threadNames) {
+        if (!first) out += ",";
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(threadId) + ",\"args\":{\"name\":";
+        appendJsonString(out, name);
+        out += "}}";
+    }
+    for (const auto& event : events) {
+        if (!first) out += ",";
+        first = false;
+        appendEvent(out, event);
+    }
+    out += "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" + std::to_string(dropped) + "}}";
+    return out;
+}
+
+bool Tracer::exportChromeTrace(const std::filesystem::path& path) {
+    std::lock_guard lock(m_exportMutex);
+    return replaceFile(path, toChromeJson());
+}
+
+TraceSpan::TraceSpan(std::string name, const char* category, Kind kind)
+    : m_name(std::move(name)), m_category(category), m_kind(kind) {
+    auto* tracer = Tracer::get();
+    m_active = true;
+    m_traced = tracer->isEnabled();
+    m_start = tracer->nowMicros();
+    m_threadId = Tracer::currentThreadId();
+}
+
+TraceSpan::~TraceSpan() {
+    end();
+}
+
+TraceSpan::TraceSpan(TraceSpan&& other) noexcept
+    : m_name(std::move(other.m_name)), m_category(other.m_category), m_kind(other.m_kind),
+      m_active(std::exchange(other.m_active, false)), m_traced(other.m_traced), m_start(other.m_start),
+      m_threadId(other.m_threadId),
+      m_args(std::move(other.m_args)) {}
+
+TraceSpan& TraceSpan::operator=(TraceSpan&& other) noexcept {
+    if (this != &other) {
+        end();
+        m_name = std::move(other.m_name);
+        m_category = other.m_category;
+        m_kind = other.m_kind;
+        m_active = std::exchange(other.m_active, false);
+        m_traced = other.m_traced;
+        m_start = other.m_start;
+        m_threadId = other.m_threadId;
+        m_args = std::move(other.m_args);
+    }
+    return *this;
+}
+
+void TraceSpan::appendKey(const char* key) {
+    if (!m_args.empty()) m_args += ",";
+    appendJsonString(m_args, key);
+    m_args += ":";
+}
+
+TraceSpan& TraceSpan::arg(const char* key, int64_t value) {
+    if (m_active && m_traced) {
+        appendKey(key);
+        m_args += std::to_string(value);
+    }
+    return *this;
+}
+
+TraceSpan& TraceSpan::arg(const char* key, const std::string& value) {
+    if (m_active && m_traced) {
+        appendKey(key);
+        appendJsonString(m_args, value);
+    }
+    return *this;
+}
+
+void TraceSpan::end() {
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+
+    auto* tracer = Tracer::get();
+    int64_t now = tracer->nowMicros();
+    MetricsRegistry::get()->histogram(m_name + "_us").record(static_cast<uint64_t>(now - m_start));
+    if (!m_traced) {
+        return;
+    }
+
+    if (m_kind == Kind::Scoped) {
+        TraceEvent event;
+        event.name = std::move(m_name);
+        event.category = m_category;
+        event.timestampMicros = m_start;
+        event.durationMicros = now - m_start;
+        event.threadId = m_threadId;
+        event.args = std::move(m_args);
+        tracer->record(std::move(event));
+        return;
+    }
+
+    // Async: a begin/end pair matched by id, each on the thread it happened on
+    uint64_t id = tracer->nextAsyncId();
+    TraceEvent begin;
+    begin.name = m_name;
+    begin.category = m_category;
+    begin.phase = 'b';
+    begin.timestampMicros = m_start;
+    begin.threadId = m_threadId;
+    begin.asyncId = id;
+    begin.args = std::move(m_args);
+    tracer->record(std::move(begin));
+
+    TraceEvent finish;
+    finish.name = std::move(m_name);
+    finish.category = m_category;
+    finish.phase = 'e';
+    finish.timestampMicros = now;
+    finish.threadId = Tracer::currentThreadId();
+    finish.asyncId = id;
+    tracer->record(std::move(finish));
+}
+
+}
@@ -0,0 +1,114 @@
+/**
+ * BetterSave - Trace
+ * Timed spans for every save operation, exported as Chrome trace_event JSON (open in Perfetto)
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace bettersave::core {
+
+struct TraceEvent {
+    std::string name;
+    const char* category = "";
+    // 'X' = complete span on one thread, 'b'/'e' = async span that may end on another thread
+    char phase = 'X';
+    int64_t timestampMicros = 0;
+    int64_t durationMicros = 0;
+    uint32_t threadId = 0;
+    uint64_t asyncId = 0;
+    // Pre-serialized members of the "args" object, without the braces
+    std::string args;
+};
+
+class Tracer {
+private:
+    static Tracer* s_instance;
+    mutable std::mutex m_mutex;
+    std::deque<TraceEvent> m_events;
+    std::map<uint32_t, std::string> m_threadNames;
+    uint64_t m_droppedEvents = 0;
+    std::atomic<bool> m_enabled{true};
+    std::atomic<uint64_t> m_nextAsyncId{1};
+    std::chrono::steady_clock::time_point m_origin;
+    // Exports can be requested from several threads, only one writes the file at a time
+    std::mutex m_exportMutex;
+
+    Tracer();
+
+public:
+    // Oldest events are dropped past this, a long session keeps only its recent history
+    static constexpr size_t MAX_EVENTS = 65536;
+
+    // New pool workers and the logger thread all name themselves here as they start
+    static Tracer* get() {
+        static std::once_flag s_created;
+        std::call_once(s_created, []() { s_instance = new Tracer(); });
+        return s_instance;
+    }
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    // Microseconds since the tracer was created
+    int64_t nowMicros() const;
+    uint64_t nextAsyncId() { return m_nextAsyncId.fetch_add(1, std::memory_order_relaxed); }
+
+    // Small stable number for the calling thread, used as the trace "tid"
+    static uint32_t currentThreadId();
+    void setThreadName(const std::string& name);
+
+    void record(TraceEvent event);
+    size_t eventCount() const;
+    void clear();
+
+    std::string toChromeJson() const;
+    bool exportChromeTrace(const std::filesystem::path& path);
+};
+
+// Records one span from construction until end() or destruction.
+// Async spans may be ended on another thread (web callbacks), hold them in a shared_ptr.
+// The duration also goes to the <name>_us histogram of the metrics registry, even with tracing off.
+class TraceSpan {
+public:
+    enum class Kind { Scoped, Async };
+
+private:
+    std::string m_name;
+    const char* m_category = "";
+    Kind m_kind = Kind::Scoped;
+    bool m_active = false;
+    // Whether the trace buffer gets this span, args are only built if so
+    bool m_traced = false;
+    int64_t m_start = 0;
+    uint32_t m_threadId = 0;
+    std::string m_args;
+
+    void appendKey(const char* key);
+
+public:
+    TraceSpan() = default;
+    TraceSpan(std::string name, const char* category, Kind kind = Kind::Scoped);
+    ~TraceSpan();
+
+    TraceSpan(TraceSpan&& other) noexcept;
+    TraceSpan& operator=(TraceSpan&& other) noexcept;
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    TraceSpan& arg(const char* key, int64_t value);
+    TraceSpan& arg(const char* key, const std::string& value);
+
+    bool isActive() const { return m_active; }
+    void end();
+};
+
+}
@@ -0,0 +1,640 @@
+/**
+ * BetterSave - Transfer
+ * Created by: sidastuff
+ */
+
+#include "Transfer.hpp"
+#include "Integrity.hpp"
+#include "KeySync.hpp"
+#include "Metrics.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+
+namespace bettersave::core {
+
+static void checkCancelled(const CancellationToken* cancel) {
+    if (cancel) cancel->throwIfCancelled();
+}
+
+// False once cancelled; blocks while paused
+static bool shouldContinue(CancellationToken* cancel) {
+    return !cancel || cancel->waitWhilePaused();
+}
+
+// Fills checksums with each chunk's checksum for the index pages
+static std::vector<ChunkTransfer> planChunks(const std::string& userId, const std::string& generation, const std::string& prefix,
+                                             const std::string& data, size_t chunkSize, const CancellationToken* cancel,
+                                             std::vector<std::string>& checksums) {
+    std::vector<ChunkTransfer> transfers;
+    if (chunkSize % 2 != 0) {
+        // A byte's two hex digits could land in different chunks, encode the file as a whole
+        auto chunks = splitChunks(hexEncode(data), chunkSize);
+        checkCancelled(cancel);
+        transfers.resize(chunks.size());
+        checksums.resize(chunks.size());
+        ThreadPool::get()->parallelFor(chunks.size(), [&](size_t i) {
+            checkCancelled(cancel);
+            checksums[i] = checksumHex(chunks[i]);
+            transfers[i] = {chunkKey(userId, generation, prefix, i), frameChunk(chunks[i])};
+        });
+        return transfers;
+    }
+
+    // Each chunk is exactly chunkSize / 2 bytes of the file, so chunks encode and frame independently
+    size_t bytesPerChunk = chunkSize / 2;
+    transfers.resize((data.size() + bytesPerChunk - 1) / bytesPerChunk);
+    checksums.resize(transfers.size());
+    ThreadPool::get()->parallelFor(transfers.size(), [&](size_t i) {
+        checkCancelled(cancel);
+        auto encoded = hexEncode(data.substr(i * bytesPerChunk, bytesPerChunk));
+        checksums[i] = checksumHex(encoded);
+        transfers[i] = {chunkKey(userId, generation, prefix, i), frameChunk(encoded)};
+    });
+    return transfers;
+}
+
+static std::vector<ChunkTransfer> planPages(const std::string& userId, const std::string& generation, const std::string& prefix,
+                                            const std::vector<std::string>& checksums) {
+    std::vector<ChunkTransfer> pages;
+    for (size_t first = 0; first < checksums.size(); first += CHUNKS_PER_PAGE) {
+        IndexPage page;
+        page.first = static_cast<int>(first);
+        auto end = checksums.begin() + std::min(first + CHUNKS_PER_PAGE, checksums.size());
+        page.checksums.assign(checksums.begin() + first, end);
+        pages.push_back({pageKey(userId, generation, prefix, pages.size()), serializePage(page)});
+    }
+    return pages;
+}
+
+bool preparePatch(SavePayload& payload, const BlockSignature& base, const SaveManifest& stored, const std::string& prefix,
+                  const CancellationToken* cancel) {
+    bool isGameManager = prefix == "gm";
+    // Nodes have no chunks a patch could apply to
+    if (isGameManager && stored.gmKeyNodes > 0) {
+        return false;
+    }
+    int patchChunks = isGameManager ? stored.gmPatchChunks : stored.llPatchChunks;
+    // The stored chunks hold the file itself, or the base under its patch
+    const auto& storedBase = patchChunks > 0 ? (isGameManager ? stored.gmBaseChecksum : stored.llBaseChecksum)
+                                             : (isGameManager ? stored.gmChecksum : stored.llChecksum);
+    if (payload.unchanged || storedBase.empty() || storedBase != base.checksum) {
+        return false;
+    }
+
+    auto patch = computePatch(base, payload.data, cancel);
+    if (static_cast<double>(patch.size()) > static_cast<double>(payload.data.size()) * MAX_PATCH_RATIO) {
+        return false;
+    }
+    payload.data = std::move(patch);
+    payload.baseChecksum = base.checksum;
+    payload.committedChunks = isGameManager ? stored.gmChunks : stored.llChunks;
+    payload.committedChunkSize = isGameManager ? stored.gmChunkSize : stored.llChunkSize;
+    payload.committedPages = isGameManager ? stored.gmPages : stored.llPages;
+    payload.committedGeneration = isGameManager ? stored.gmGeneration : stored.llGeneration;
+    return true;
+}
+
+std::optional<std::string> rebuildFromPatch(const std::string& base, const std::string& baseChecksum, const std::string& patch) {
+    if (checksumHex(base) != baseChecksum) return std::nullopt;
+    return applyPatch(base, patch);
+}
+
+// Manifest fields of one file: chunks and pages are the base, which a patch or an unchanged file
+// keeps as committed
+struct PlannedFile {
+    std::string generation;
+    int chunks = 0;
+    int chunkSize = 0;
+    int pages = 0;
+    std::string baseChecksum;
+    std::string patchGeneration;
+    int patchChunks = 0;
+    int patchPages = 0;
+};
+
+static PlannedFile describeFile(const SavePayload& payload, const std::string& generation, const std::vector<ChunkTransfer>& chunks,
+                                const std::vector<ChunkTransfer>& pages, size_t chunkSize) {
+    PlannedFile file;
+    if (!payload.plistChecksum.empty()) {
+        // Stored key by key, it has no chunks at all, only the index pages of its nodes
+        file.generation = payload.unchanged ? payload.committedGeneration : generation;
+        return file;
+    }
+    if (payload.unchanged || !payload.baseChecksum.empty()) {
+        file.generation = payload.committedGeneration;
+        file.chunks = payload.committedChunks;
+        file.chunkSize = payload.committedChunkSize;
+        file.pages = payload.committedPages;
+        file.baseChecksum = payload.baseChecksum;
+    } else {
+        file.generation = generation;
+        file.chunks = static_cast<int>(chunks.size());
+        file.chunkSize = static_cast<int>(chunkSize);
+        file.pages = static_cast<int>(pages.size());
+    }
+    if (payload.unchanged) {
+        file.patchGeneration = payload.committedPatchGeneration;
+        file.patchChunks = payload.committedPatchChunks;
+        file.patchPages = payload.committedPatchPages;
+    } else if (!payload.baseChecksum.empty()) {
+        file.patchGeneration = generation;
+        file.patchChunks = static_cast<int>(chunks.size());
+        file.patchPages = static_cast<int>(pages.size());
+    }
+    return file;
+}
+
+UploadPlan planUpload(const std::string& userId, const std::string& generation, const SavePayload& gameManager,
+                      const SavePayload& localLevels, int64_t timestamp, size_t chunkSize, const CancellationToken* cancel) {
+    TraceSpan span("plan_upload", "encode");
+    span.arg("gm_bytes", static_cast<int64_t>(gameManager.data.size()))
+        .arg("ll_bytes", static_cast<int64_t>(localLevels.data.size()));
+
+    // A patch goes up under its own prefix in the new generation, its base's chunks stay where they are
+    UploadPlan plan;
+    plan.generation = generation;
+    std::vector<std::string> checksums;
+    if (!gameManager.unchanged && !gameManager.plistChecksum.empty()) {
+        // Stored key by key, prepareKeySync already planned the nodes and their index
+        plan.gmChunks = gameManager.nodeTransfers;
+        plan.gmPages = gameManager.keyPageTransfers;
+    } else if (!gameManager.unchanged) {
+        auto prefix = gameManager.baseChecksum.empty() ? "gm" : patchPrefix("gm");
+        plan.gmChunks = planChunks(userId, generation, prefix, gameManager.data, chunkSize, cancel, checksums);
+        plan.gmPages = planPages(userId, generation, prefix, checksums);
+    }
+    if (!localLevels.unchanged) {
+        auto prefix = localLevels.baseChecksum.empty() ? "ll" : patchPrefix("ll");
+        plan.llChunks = planChunks(userId, generation, prefix, localLevels.data, chunkSize, cancel, checksums);
+        plan.llPages = planPages(userId, generation, prefix, checksums);
+    }
+
+    auto gm = describeFile(gameManager, generation, plan.gmChunks, plan.gmPages, chunkSize);
+    auto ll = describeFile(localLevels, generation, plan.llChunks, plan.llPages, chunkSize);
+    plan.manifest.gmChunks = gm.chunks;
+    plan.manifest.llChunks = ll.chunks;
+    plan.manifest.timestamp = timestamp;
+    plan.manifest.gmChecksum = gameManager.checksum;
+    plan.manifest.llChecksum = localLevels.checksum;
+    plan.manifest.gmChunkSize = gm.chunkSize;
+    plan.manifest.llChunkSize = ll.chunkSize;
+    plan.manifest.gmPages = gm.pages;
+    plan.manifest.llPages = ll.pages;
+    plan.manifest.gmBaseChecksum = gm.baseChecksum;
+    plan.manifest.llBaseChecksum = ll.baseChecksum;
+    plan.manifest.gmPatchChunks = gm.patchChunks;
+    plan.manifest.llPatchChunks = ll.patchChunks;
+    plan.manifest.gmPatchPages = gm.patchPages;
+    plan.manifest.llPatchPages = ll.patchPages;
+    plan.manifest.gmGeneration = gm.generation;
+    plan.manifest.llGeneration = ll.generation;
+    plan.manifest.gmPatchGeneration = gm.patchGeneration;
+    plan.manifest.llPatchGeneration = ll.patchGeneration;
+    if (!gameManager.plistChecksum.empty()) {
+        plan.manifest.gmKeyNodes = gameManager.keyNodes;
+        plan.manifest.gmKeyPages = gameManager.keyPages;
+        plan.manifest.gmPlistChecksum = gameManager.plistChecksum;
+    }
+    plan.chunkSize = chunkSize;
+    return plan;
+}
+
+std::vector<StoredPart> storedParts(const SaveManifest& manifest) {
+    return {
+        {manifest.gmGeneration, "gm", manifest.gmChunks, manifest.gmPages},
+        {manifest.llGeneration, "ll", manifest.llChunks, manifest.llPages},
+        {manifest.gmPatchGeneration, patchPrefix("gm"), manifest.gmPatchChunks, manifest.gmPatchPages},
+        {manifest.llPatchGeneration, patchPrefix("ll"), manifest.llPatchChunks, manifest.llPatchPages},
+        {manifest.gmGeneration, KEY_PAGE_PREFIX, 0, manifest.gmKeyPages},
+    };
+}
+
+std::vector<std::string> replacedKeys(const std::string& userId, const SaveManifest& previous, const SaveManifest& current) {
+    auto currentParts = storedParts(current);
+    std::vector<std::string> keys;
+    for (const auto& part : storedParts(previous)) {
+        if (!part.generation.empty()) {
+            // A generation goes as a whole once nothing points at it
+            auto key = generationKey(userId, part.generation);
+            if (!usesGeneration(current, part.generation) && std::find(keys.begin(), keys.end(), key) == keys.end()) {
+                keys.push_back(std::move(key));
+            }
+            continue;
+        }
+        // The old layout is rewritten in place, only what current no longer covers goes
+        int keptChunks = 0;
+        int keptPages = 0;
+        for (const auto& kept : currentParts) {
+            if (kept.generation.empty() && kept.prefix == part.prefix) {
+                keptChunks = kept.chunks;
+                keptPages = kept.pages;
+            }
+        }
+        for (int i = keptChunks; i < part.chunks; i++) keys.push_back(chunkKey(userId, "", part.prefix, i));
+        for (int i = keptPages; i < part.pages; i++) keys.push_back(pageKey(userId, "", part.prefix, i));
+    }
+    return keys;
+}
+
+std::optional<std::string> decodeChunks(const std::vector<std::string>& bodies, const CancellationToken* cancel,
+                                        const std::vector<std::string>* checksums) {
+    TraceSpan span("decode_chunks", "decode");
+    span.arg("chunks", static_cast<int64_t>(bodies.size()));
+
+    if (checksums && checksums->size() != bodies.size()) return std::nullopt;
+
+    auto* pool = ThreadPool::get();
+    std::vector<std::string> chunks(bodies.size());
+    std::atomic<bool> malformed{false};
+    pool->parallelFor(bodies.size(), [&](size_t i) {
+        checkCancelled(cancel);
+        auto chunk = unframeChunk(bodies[i]);
+        if (!chunk || (checksums && checksumHex(*chunk) != (*checksums)[i])) {
+            malformed.store(true);
+            return;
+        }
+        chunks[i] = std::move(*chunk);
+    });
+    if (malformed.load()) return std::nullopt;
+    checkCancelled(cancel);
+
+    // Every chunk we upload ends on a byte boundary, so each one decodes straight into its
+    // place in the file. Anything else is decoded as a whole.
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i].size() % 2 != 0) {
+            return hexDecode(joinChunks(chunks));
+        }
+        offsets[i + 1] = offsets[i] + chunks[i].size() / 2;
+    }
+
+    std::string data(offsets.back(), '\0');
+    pool->parallelFor(chunks.size(), [&](size_t i) {
+        checkCancelled(cancel);
+        if (!hexDecodeInto(chunks[i], data.data() + offsets[i])) {
+            malformed.store(true);
+        }
+    });
+    if (malformed.load()) return std::nullopt;
+    return data;
+}
+
+// Entries of a file's index pages (chunk checksums, or node ids), nullopt with error set if a page
+// is missing or they don't list exactly count entries
+static std::optional<std::vector<std::string>> loadIndex(Storage& storage, const std::string& userId, const std::string& generation,
+                                                         const std::string& prefix, int pageCount, int count, size_t entryLength,
+                                                         std::string& error) {
+    std::vector<IndexPage> pages;
+    for (int i = 0; i < pageCount; i++) {
+        TraceSpan get("page_get", "network");
+        auto body = storage.get(pageKey(userId, generation, prefix, i));
+        auto page = body ? parsePage(*body, entryLength) : std::nullopt;
+        if (!page) {
+            error = "Missing or corrupted index page " + prefix + std::to_string(i);
+            return std::nullopt;
+        }
+        pages.push_back(std::move(*page));
+    }
+    auto entries = joinPages(pages, count);
+    if (!entries) {
+        error = "Index pages of " + prefix + " don't match the manifest";
+    }
+    return entries;
+}
+
+// Removes the nodes among ids that the stored index doesn't list. Nodes are shared by every
+// generation, so the manifest is read again first: another backup may have committed since, and
+// its index may list them. Nothing is removed if that index can't be read.
+static void removeUnlistedNodes(Storage& storage, const std::string& userId, const std::vector<std::string>& ids) {
+    if (ids.empty()) return;
+    std::unordered_set<std::string> listed;
+    auto body = storage.get(manifestKey(userId));
+    auto current = body ? parseManifest(*body) : std::nullopt;
+    if (body && !current) return;
+    if (current && current->gmKeyNodes > 0) {
+        std::string error;
+        auto stored = loadIndex(storage, userId, current->gmGeneration, KEY_PAGE_PREFIX, current->gmKeyPages, current->gmKeyNodes,
+                                NODE_ID_LENGTH, error);
+        if (!stored) return;
+        listed.insert(stored->begin(), stored->end());
+    }
+    for (const auto& id : ids) {
+        if (!listed.count(id)) storage.remove(nodeKey(userId, id));
+    }
+}
+
+BackupResult backupSave(Storage& storage, const std::string& userId, const std::string& gameManagerData,
+                        const std::string& localLevelsData, int64_t timestamp, bool onlyChanged,
+                        CancellationToken* cancel, DeltaBases* bases, const SaveFileCodec* codec) {
+    TraceSpan span("backup", "sync");
+    BackupResult result;
+
+    std::optional<SaveManifest> previous;
+    if (auto body = storage.get(manifestKey(userId))) {
+        previous = parseManifest(*body);
+    }
+
+    SavePayload gameManager;
+    gameManager.data = gameManagerData;
+    gameManager.checksum = checksumHex(gameManagerData);
+    SavePayload localLevels;
+    localLevels.data = localLevelsData;
+    localLevels.checksum = checksumHex(localLevelsData);
+    if (onlyChanged && previous) {
+        if (!previous->gmChecksum.empty() && previous->gmChecksum == gameManager.checksum) {
+            gameManager.unchanged = true;
+            gameManager.committedChunks = previous->gmChunks;
+            gameManager.committedChunkSize = previous->gmChunkSize;
+            gameManager.committedPages = previous->gmPages;
+            gameManager.committedGeneration = previous->gmGeneration;
+            gameManager.baseChecksum = previous->gmBaseChecksum;
+            gameManager.committedPatchChunks = previous->gmPatchChunks;
+            gameManager.committedPatchPages = previous->gmPatchPages;
+            gameManager.committedPatchGeneration = previous->gmPatchGeneration;
+            gameManager.plistChecksum = previous->gmPlistChecksum;
+            gameManager.keyNodes = previous->gmKeyNodes;
+            gameManager.keyPages = previous->gmKeyPages;
+        }
+        if (!previous->llChecksum.empty() && previous->llChecksum == localLevels.checksum) {
+            localLevels.unchanged = true;
+            localLevels.committedChunks = previous->llChunks;
+            localLevels.committedChunkSize = previous->llChunkSize;
+            localLevels.committedPages = previous->llPages;
+            localLevels.committedGeneration = previous->llGeneration;
+            localLevels.baseChecksum = previous->llBaseChecksum;
+            localLevels.committedPatchChunks = previous->llPatchChunks;
+            localLevels.committedPatchPages = previous->llPatchPages;
+            localLevels.committedPatchGeneration = previous->llPatchGeneration;
+        }
+    }
+    result.gameManagerUnchanged = gameManager.unchanged;
+    result.localLevelsUnchanged = localLevels.unchanged;
+
+    // Nodes the stored save is made of. If its index can't be read every node is sent again.
+    std::vector<std::string> storedIds;
+    if (previous && previous->gmKeyNodes > 0) {
+        std::string indexError;
+        storedIds = loadIndex(storage, userId, previous->gmGeneration, KEY_PAGE_PREFIX, previous->gmKeyPages, previous->gmKeyNodes, NODE_ID_LENGTH,
+                              indexError).value_or(std::vector<std::string>());
+    }
+
+    UploadPlan plan;
+    plan.generation = newGeneration(previous ? &*previous : nullptr);
+    std::vector<std::string> sentIds;
+    std::vector<std::string> staleIds;
+    try {
+        if (codec && !gameManager.unchanged) {
+            if (auto changes = prepareKeySync(gameManager, userId, plan.generation, *codec, storedIds, cancel)) {
+                result.gameManagerByKey = true;
+                result.keyNodesSent = changes->sentPaths.size();
+                sentIds = std::move(changes->sentIds);
+                staleIds = std::move(changes->staleIds);
+            }
+        }
+        // Going back to chunks leaves every stored node behind
+        if (!gameManager.unchanged && !result.gameManagerByKey) {
+            staleIds = storedIds;
+        }
+        if (bases && previous) {
+            if (bases->gameManager && !result.gameManagerByKey) {
+                result.gameManagerPatched = preparePatch(gameManager, *bases->gameManager, *previous, "gm", cancel);
+            }
+            if (bases->localLevels) result.localLevelsPatched = preparePatch(localLevels, *bases->localLevels, *previous, "ll", cancel);
+        }
+        plan = planUpload(userId, plan.generation, gameManager, localLevels, timestamp, DEFAULT_CHUNK_SIZE, cancel);
+    } catch (const OperationCancelled&) {
+        result.cancelled = true;
+        result.error = "Cancelled";
+        return result;
+    }
+
+    // Until the manifest points at it the new generation is unreachable, a backup that stops short
+    // takes it back out, and the nodes it sent, and leaves the stored save as it was
+    auto abandon = [&](const std::string& error, bool cancelled) {
+        storage.remove(generationKey(userId, plan.generation));
+        removeUnlistedNodes(storage, userId, sentIds);
+        result.cancelled = cancelled;
+        result.error = error;
+        return result;
+    };
+
+    // Chunks first, the manifest is the commit point
+    for (const auto* transfers : {&plan.gmChunks, &plan.llChunks}) {
+        for (const auto& transfer : *transfers) {
+            if (!shouldContinue(cancel)) {
+                return abandon("Cancelled after " + std::to_string(result.chunksWritten) + " chunks, the previous save is still current", true);
+            }
+            TraceSpan put("chunk_put", "network");
+            put.arg("key", transfer.key).arg("bytes", static_cast<int64_t>(transfer.body.size()));
+            if (!storage.put(transfer.key, transfer.body)) {
+                return abandon("Failed to write " + transfer.key, false);
+            }
+            MetricsRegistry::get()->counter("upload.bytes").add(static_cast<int64_t>(transfer.body.size()));
+            result.chunksWritten++;
+        }
+    }
+
+    // Pages after the chunks they describe
+    for (const auto* pages : {&plan.gmPages, &plan.llPages}) {
+        for (const auto& page : *pages) {
+            if (!shouldContinue(cancel)) {
+                return abandon("Cancelled after " + std::to_string(result.chunksWritten) + " chunks, the previous save is still current", true);
+            }
+            TraceSpan put("page_put", "network");
+            put.arg("key", page.key);
+            if (!storage.put(page.key, page.body)) {
+                return abandon("Failed to write " + page.key, false);
+            }
+        }
+    }
+
+    TraceSpan manifestPut("metadata_put", "network");
+    if (!storage.put(manifestKey(userId), serializeManifest(plan.manifest))) {
+        // The put may have landed anyway, the new generation stays in case it's the committed one
+        result.error = "Failed to write the manifest";
+        return result;
+    }
+    manifestPut.end();
+
+    // Committed, drop what only the previous save pointed at
+    if (previous) {
+        for (const auto& key : replacedKeys(userId, *previous, plan.manifest)) storage.remove(key);
+    }
+    removeUnlistedNodes(storage, userId, staleIds);
+
+    // A file uploaded whole is the base the next patch is made against
+    if (bases) {
+        try {
+            if (!gameManager.unchanged && !result.gameManagerPatched && !result.gameManagerByKey) {
+                bases->gameManager = computeSignature(gameManagerData, gameManager.checksum, cancel);
+            }
+            if (!localLevels.unchanged && !result.localLevelsPatched) {
+                bases->localLevels = computeSignature(localLevelsData, localLevels.checksum, cancel);
+            }
+        } catch (const OperationCancelled&) {
+            // The backup is committed, the next one just can't be a patch
+        }
+    }
+
+    result.success = true;
+    result.manifest = plan.manifest;
+    return result;
+}
+
+static std::optional<std::string> downloadFile(Storage& storage, const std::string& userId, const std::string& generation,
+                                               const std::string& prefix, int chunkCount, int pageCount, std::string& error,
+                                               CancellationToken* cancel) {
+    // Saves from before paging have no pages and no per-chunk checksums
+    std::optional<std::vector<std::string>> checksums;
+    if (pageCount > 0) {
+        checksums = loadIndex(storage, userId, generation, prefix, pageCount, chunkCount, CHECKSUM_LENGTH, error);
+        if (!checksums) {
+            return std::nullopt;
+        }
+    }
+
+    std::vector<std::string> bodies;
+    bodies.reserve(chunkCount);
+    for (int i = 0; i < chunkCount; i++) {
+        if (!shouldContinue(cancel)) {
+            error = "Cancelled";
+            return std::nullopt;
+        }
+        TraceSpan get("chunk_get", "network");
+        auto key = chunkKey(userId, generation, prefix, i);
+        auto body = storage.get(key);
+        get.arg("key", key).arg("bytes", body ? static_cast<int64_t>(body->size()) : 0);
+        if (!body) {
+            error = "Missing chunk " + prefix + std::to_string(i);
+            return std::nullopt;
+        }
+        MetricsRegistry::get()->counter("download.bytes").add(static_cast<int64_t>(body->size()));
+        bodies.push_back(std::move(*body));
+    }
+
+    std::optional<std::string> data;
+    try {
+        data = decodeChunks(bodies, cancel, checksums ? &*checksums : nullptr);
+    } catch (const OperationCancelled&) {
+        error = "Cancelled";
+        return std::nullopt;
+    }
+    if (!data) {
+        error = "Corrupted " + prefix + " chunks";
+    }
+    return data;
+}
+
+// A file's base and, if it was uploaded as one, the patch over it
+static std::optional<std::string> downloadSaveFile(Storage& storage, const std::string& userId, const std::string& prefix,
+                                                   const std::string& generation, int chunkCount, int pageCount,
+                                                   const std::string& baseChecksum, const std::string& patchGeneration,
+                                                   int patchChunks, int patchPages, std::string& error, CancellationToken* cancel) {
+    auto data = downloadFile(storage, userId, generation, prefix, chunkCount, pageCount, error, cancel);
+    if (!data || patchChunks == 0) {
+        return data;
+    }
+    auto patch = downloadFile(storage, userId, patchGeneration, patchPrefix(prefix), patchChunks, patchPages, error, cancel);
+    if (!patch) {
+        return std::nullopt;
+    }
+    auto rebuilt = rebuildFromPatch(*data, baseChecksum, *patch);
+    if (!rebuilt) {
+        error = "The " + prefix + " patch doesn't apply to its base";
+    }
+    return rebuilt;
+}
+
+// CCGameManager.dat stored key by key: its nodes joined and encoded back into a save file
+static std::optional<std::string> downloadKeyedFile(Storage& storage, const std::string& userId, const SaveManifest& manifest,
+                                                    const SaveFileCodec* codec, std::string& error, CancellationToken* cancel) {
+    if (!codec) {
+        error = "CCGameManager.dat is stored key by key and this build can't encode it back into a save file";
+        return std::nullopt;
+    }
+    auto ids = loadIndex(storage, userId, manifest.gmGeneration, KEY_PAGE_PREFIX, manifest.gmKeyPages, manifest.gmKeyNodes, NODE_ID_LENGTH, error);
+    if (!ids) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> bodies;
+    bodies.reserve(ids->size());
+    for (const auto& id : *ids) {
+        if (!shouldContinue(cancel)) {
+            error = "Cancelled";
+            return std::nullopt;
+        }
+        TraceSpan get("node_get", "network");
+        auto body = storage.get(nodeKey(userId, id));
+        get.arg("key", nodeKey(userId, id)).arg("bytes", body ? static_cast<int64_t>(body->size()) : 0);
+        if (!body) {
+            error = "Missing node " + id;
+            return std::nullopt;
+        }
+        MetricsRegistry::get()->counter("download.bytes").add(static_cast<int64_t>(body->size()));
+        bodies.push_back(std::move(*body));
+    }
+
+    std::optional<std::string> plist;
+    try {
+        plist = joinNodes(bodies, *ids, manifest.gmPlistChecksum, *codec, cancel);
+    } catch (const OperationCancelled&) {
+        error = "Cancelled";
+        return std::nullopt;
+    }
+    if (!plist) {
+        error = "Corrupted CCGameManager.dat nodes";
+        return std::nullopt;
+    }
+    return codec->encode(*plist);
+}
+
+RestoreResult restoreSave(Storage& storage, const std::string& userId, CancellationToken* cancel, const SaveFileCodec* codec) {
+    TraceSpan span("restore", "sync");
+    RestoreResult result;
+
+    TraceSpan manifestGet("metadata_get", "network");
+    auto body = storage.get(manifestKey(userId));
+    manifestGet.end();
+    auto manifest = body ? parseManifest(*body) : std::nullopt;
+    if (!manifest) {
+        result.error = "No cloud save found";
+        return result;
+    }
+    result.manifest = *manifest;
+
+    bool gameManagerByKey = manifest->gmKeyNodes > 0;
+    auto gameManager = gameManagerByKey
+        ? downloadKeyedFile(storage, userId, *manifest, codec, result.error, cancel)
+        : downloadSaveFile(storage, userId, "gm", manifest->gmGeneration, manifest->gmChunks, manifest->gmPages,
+                           manifest->gmBaseChecksum, manifest->gmPatchGeneration, manifest->gmPatchChunks, manifest->gmPatchPages,
+                           result.error, cancel);
+    auto localLevels = gameManager ? downloadSaveFile(storage, userId, "ll", manifest->llGeneration, manifest->llChunks, manifest->llPages,
+                                                      manifest->llBaseChecksum, manifest->llPatchGeneration, manifest->llPatchChunks,
+                                                      manifest->llPatchPages, result.error, cancel)
+                                   : std::nullopt;
+    if (!localLevels) {
+        result.cancelled = cancel && cancel->isCancelled();
+        return result;
+    }
+
+    // A file rebuilt from its nodes was already checked against its plist checksum
+    if (!gameManagerByKey && !manifest->gmChecksum.empty() && checksumHex(*gameManager) != manifest->gmChecksum) {
+        result.error = "CCGameManager.dat checksum mismatch";
+        return result;
+    }
+    if (!manifest->llChecksum.empty() && checksumHex(*localLevels) != manifest->llChecksum) {
+        result.error = "CCLocalLevels.dat checksum mismatch";
+        return result;
+    }
+
+    result.gameManagerData = std::move(*gameManager);
+    result.localLevelsData = std::move(*localLevels);
+    result.success = true;
+    return result;
+}
+
+}
@@ -0,0 +1,154 @@
+/**
+ * BetterSave - Transfer
+ * Plans uploads and reassembles downloads of the two save files
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "Cancellation.hpp"
+#include "Codec.hpp"
+#include "Delta.hpp"
+#include "Manifest.hpp"
+#include "Plist.hpp"
+#include "Storage.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+struct ChunkTransfer {
+    std::string key;
+    std::string body;
+};
+
+struct SavePayload {
+    // Reuse the chunks already committed in the cloud instead of uploading data
+    bool unchanged = false;
+    std::string data;
+    std::string checksum;
+    int committedChunks = 0;
+    int committedChunkSize = 0;
+    int committedPages = 0;
+    // Generation the committed chunks are stored under, empty for the layout from before generations
+    std::string committedGeneration;
+    // Non-empty when data is a patch against the committed chunks (see preparePatch), which hold
+    // the file with this checksum. An unchanged file keeps its committed patch too.
+    std::string baseChecksum;
+    int committedPatchChunks = 0;
+    int committedPatchPages = 0;
+    std::string committedPatchGeneration;
+    // Non-empty when CCGameManager.dat is stored key by key (see prepareKeySync): the checksum of
+    // its plist and how many nodes and index pages list it. A changed file sends the nodes and
+    // pages below instead of chunks, an unchanged one keeps the committed nodes.
+    std::string plistChecksum;
+    int keyNodes = 0;
+    int keyPages = 0;
+    std::vector<ChunkTransfer> nodeTransfers;
+    std::vector<ChunkTransfer> keyPageTransfers;
+};
+
+struct UploadPlan {
+    SaveManifest manifest;
+    // Where the changed files' chunks and pages go, a generation the stored manifest doesn't use
+    std::string generation;
+    // What the changed files were split with
+    size_t chunkSize = DEFAULT_CHUNK_SIZE;
+    std::vector<ChunkTransfer> gmChunks;
+    std::vector<ChunkTransfer> llChunks;
+    // Index pages of the changed files, sent once their chunks are up
+    std::vector<ChunkTransfer> gmPages;
+    std::vector<ChunkTransfer> llPages;
+};
+
+// Turns a changed file's payload into a patch against base, if the chunks of stored (the manifest
+// in the cloud) still hold base and the patch is small enough (see MAX_PATCH_RATIO). prefix is
+// "gm" or "ll". False if the file should be uploaded whole, the payload is left as it was.
+// Never for a file stored by key.
+bool preparePatch(SavePayload& payload, const BlockSignature& base, const SaveManifest& stored, const std::string& prefix,
+                  const CancellationToken* cancel = nullptr);
+
+// A patched file rebuilt from its decoded base. nullopt if base isn't the file the patch was made
+// against or the patch doesn't apply.
+std::optional<std::string> rebuildFromPatch(const std::string& base, const std::string& baseChecksum, const std::string& patch);
+
+// All throw OperationCancelled if the token is cancelled part way. generation is where the changed
+// files and patches go (see newGeneration), unchanged files and the bases of patches keep pointing
+// at their committed chunks.
+UploadPlan planUpload(const std::string& userId, const std::string& generation, const SavePayload& gameManager,
+                      const SavePayload& localLevels, int64_t timestamp, size_t chunkSize = DEFAULT_CHUNK_SIZE,
+                      const CancellationToken* cancel = nullptr);
+
+// Chunks and index pages of one prefix that a manifest points at
+struct StoredPart {
+    std::string generation;
+    std::string prefix;
+    int chunks = 0;
+    int pages = 0;
+};
+
+// Every part a manifest's files are stored in. Nodes aren't parts, they're shared by content.
+std::vector<StoredPart> storedParts(const SaveManifest& manifest);
+
+// What previous points at and current doesn't: whole generations, and the chunks and pages of the
+// layout from before generations that current doesn't reuse. Only safe to remove once current is
+// the committed manifest.
+std::vector<std::string> replacedKeys(const std::string& userId, const SaveManifest& previous, const SaveManifest& current);
+
+// Reassemble a save file from its chunk bodies (in index order). nullopt if any chunk is malformed
+// or, given the checksums from the file's index pages, doesn't match its checksum.
+std::optional<std::string> decodeChunks(const std::vector<std::string>& bodies, const CancellationToken* cancel = nullptr,
+                                        const std::vector<std::string>* checksums = nullptr);
+
+// Synchronous backup/restore against a Storage backend (used by the CLI)
+struct BackupResult {
+    bool success = false;
+    bool cancelled = false;
+    std::string error;
+    SaveManifest manifest;
+    size_t chunksWritten = 0;
+    bool gameManagerUnchanged = false;
+    bool localLevelsUnchanged = false;
+    // Uploaded as a patch against the file's base
+    bool gameManagerPatched = false;
+    bool localLevelsPatched = false;
+    // Stored key by key, and how many of its nodes the store didn't have yet
+    bool gameManagerByKey = false;
+    size_t keyNodesSent = 0;
+};
+
+struct RestoreResult {
+    bool success = false;
+    bool cancelled = false;
+    std::string error;
+    SaveManifest manifest;
+    std::string gameManagerData;
+    std::string localLevelsData;
+};
+
+// Signatures of each file's last whole upload, kept by the caller between backups
+struct DeltaBases {
+    std::optional<BlockSignature> gameManager;
+    std::optional<BlockSignature> localLevels;
+};
+
+// With onlyChanged, a file whose checksum matches the stored manifest keeps its existing chunks.
+// With bases, a changed file whose base is still the stored one is uploaded as a patch, and a
+// file uploaded whole replaces its signature. With codec, a changed CCGameManager.dat is stored
+// key by key when it decodes, which takes precedence over a patch.
+// Changed files are written under a new generation and the manifest put is the commit point: until
+// it succeeds nothing the stored save needs is touched, after it the generations it replaced are
+// removed. A cancel or failure before it removes the new generation again; a pause blocks until
+// resumed.
+BackupResult backupSave(Storage& storage, const std::string& userId, const std::string& gameManagerData,
+                        const std::string& localLevelsData, int64_t timestamp, bool onlyChanged = false,
+                        CancellationToken* cancel = nullptr, DeltaBases* bases = nullptr, const SaveFileCodec* codec = nullptr);
+
+// Downloads both files (applying their patches) and verifies them against the manifest
+// checksums (when present). A CCGameManager.dat stored key by key needs codec to be encoded
+// again, and is verified against its plist checksum instead.
+RestoreResult restoreSave(Storage& storage, const std::string& userId, CancellationToken* cancel = nullptr,
+                          const SaveFileCodec* codec = nullptr);
+
+}
@@ -0,0 +1,143 @@
+/**
+ * BetterSave - Upload Journal
+ * Created by: sidastuff
+ */
+
+#include "UploadJournal.hpp"
+#include "Json.hpp"
+#include <algorithm>
+
+namespace bettersave::core {
+
+UploadJournal UploadJournal::begin(const std::string& userId, const UploadPlan& plan) {
+    UploadJournal journal;
+    journal.userId = userId;
+    journal.generation = plan.generation;
+    journal.gmChecksum = plan.manifest.gmChecksum;
+    journal.llChecksum = plan.manifest.llChecksum;
+    journal.chunkSize = plan.chunkSize;
+    journal.gmBaseChecksum = plan.manifest.gmBaseChecksum;
+    journal.llBaseChecksum = plan.manifest.llBaseChecksum;
+    journal.gmPlistChecksum = plan.manifest.gmPlistChecksum;
+    journal.gmDone.assign(plan.gmChunks.size(), false);
+    journal.llDone.assign(plan.llChunks.size(), false);
+    return journal;
+}
+
+bool UploadJournal::covers(const std::string& userId, const std::string& gmChecksum, const std::string& llChecksum) const {
+    return this->userId == userId && !this->gmChecksum.empty() && !this->llChecksum.empty() &&
+        this->gmChecksum == gmChecksum && this->llChecksum == llChecksum;
+}
+
+bool UploadJournal::matches(const std::string& userId, const UploadPlan& plan) const {
+    return covers(userId, plan.manifest.gmChecksum, plan.manifest.llChecksum) && !generation.empty() &&
+        generation == plan.generation && chunkSize == plan.chunkSize &&
+        gmBaseChecksum == plan.manifest.gmBaseChecksum && llBaseChecksum == plan.manifest.llBaseChecksum &&
+        gmPlistChecksum == plan.manifest.gmPlistChecksum &&
+        gmDone.size() == plan.gmChunks.size() && llDone.size() == plan.llChunks.size();
+}
+
+size_t UploadJournal::completedCount() const {
+    return static_cast<size_t>(std::count(gmDone.begin(), gmDone.end(), true) +
+                               std::count(llDone.begin(), llDone.end(), true));
+}
+
+// One character per chunk keeps the journal a flat object: "1" done, "0" not yet
+static std::string encodeDone(const std::vector<bool>& done) {
+    std::string out(done.size(), '0');
+    for (size_t i = 0; i < done.size(); i++) {
+        if (done[i]) out[i] = '1';
+    }
+    return out;
+}
+
+static std::optional<std::vector<bool>> decodeDone(const std::string& text) {
+    std::vector<bool> done(text.size(), false);
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] != '0' && text[i] != '1') return std::nullopt;
+        done[i] = text[i] == '1';
+    }
+    return done;
+}
+
+// Node ids are hex, a comma between them keeps the list a single string
+static std::string encodeNodes(const std::vector<std::string>& ids) {
+    std::string out;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (i > 0) out += ',';
+        out += ids[i];
+    }
+    return out;
+}
+
+static std::vector<std::string> decodeNodes(const std::string& text) {
+    std::vector<std::string> ids;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == std::string::npos) comma = text.size();
+        if (comma > start) ids.push_back(text.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return ids;
+}
+
+std::string serializeJournal(const UploadJournal& journal) {
+    std::string out = "{\"userId\":";
+    appendJsonString(out, journal.userId);
+    out += ",\"generation\":";
+    appendJsonString(out, journal.generation);
+    out += ",\"gmChecksum\":";
+    appendJsonString(out, journal.gmChecksum);
+    out += ",\"llChecksum\":";
+    appendJsonString(out, journal.llChecksum);
+    out += ",\"chunkSize\":" + std::to_string(journal.chunkSize);
+    out += ",\"gmBaseChecksum\":";
+    appendJsonString(out, journal.gmBaseChecksum);
+    out += ",\"llBaseChecksum\":";
+    appendJsonString(out, journal.llBaseChecksum);
+    out += ",\"gmPlistChecksum\":";
+    appendJsonString(out, journal.gmPlistChecksum);
+    out += ",\"gmDone\":";
+    appendJsonString(out, encodeDone(journal.gmDone));
+    out += ",\"llDone\":";
+    appendJsonString(out, encodeDone(journal.llDone));
+    out += ",\"gmNodes\":";
+    appendJsonString(out, encodeNodes(journal.gmNodes));
+    out += '}';
+    return out;
+}
+
+std::optional<UploadJournal> parseJournal(const std::string& text) {
+    auto object = parseFlatJsonObject(text);
+    if (!object) return std::nullopt;
+
+    auto userId = getString(*object, "userId");
+    auto gmChecksum = getString(*object, "gmChecksum");
+    auto llChecksum = getString(*object, "llChecksum");
+    auto gmDone = decodeDone(getString(*object, "gmDone").value_or("x"));
+    auto llDone = decodeDone(getString(*object, "llDone").value_or("x"));
+    if (!userId || !gmChecksum || !llChecksum || !gmDone || !llDone) return std::nullopt;
+
+    UploadJournal journal;
+    journal.userId = *userId;
+    // Chunks of journals from before generations were overwritten in place, none of them are reused
+    journal.generation = getString(*object, "generation").value_or("");
+    journal.gmChecksum = *gmChecksum;
+    journal.llChecksum = *llChecksum;
+    // Journals from before chunk sizing was adaptive were all planned with the default
+    auto chunkSize = getInt(*object, "chunkSize").value_or(static_cast<int64_t>(DEFAULT_CHUNK_SIZE));
+    if (chunkSize <= 0) return std::nullopt;
+    journal.chunkSize = static_cast<size_t>(chunkSize);
+    // Journals from before patches only ever uploaded whole files
+    journal.gmBaseChecksum = getString(*object, "gmBaseChecksum").value_or("");
+    journal.llBaseChecksum = getString(*object, "llBaseChecksum").value_or("");
+    // Nor key by key
+    journal.gmPlistChecksum = getString(*object, "gmPlistChecksum").value_or("");
+    journal.gmDone = std::move(*gmDone);
+    journal.llDone = std::move(*llDone);
+    journal.gmNodes = decodeNodes(getString(*object, "gmNodes").value_or(""));
+    return journal;
+}
+
+}
@@ -0,0 +1,51 @@
+/**
+ * BetterSave - Upload Journal
+ * Which chunks of a paused, cancelled or failed upload already reached the server
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include "Transfer.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::core {
+
+// Chunk bodies only depend on the file contents, so a later upload of the same files
+// can skip every chunk the journal marks as done, as long as it writes to the same generation.
+struct UploadJournal {
+    std::string userId;
+    // Generation the chunks were written under, empty in journals from before generations
+    std::string generation;
+    std::string gmChecksum;
+    std::string llChecksum;
+    size_t chunkSize = DEFAULT_CHUNK_SIZE;
+    // Base a file was patched against, empty if it was uploaded whole
+    std::string gmBaseChecksum;
+    std::string llBaseChecksum;
+    // Plist checksum of a CCGameManager.dat sent key by key, its "chunks" are then the missing nodes
+    std::string gmPlistChecksum;
+    std::vector<bool> gmDone;
+    std::vector<bool> llDone;
+    // Ids of the nodes sent key by key, by this upload and any stopped one before it. Nodes live
+    // outside the generation, the committing upload removes those its index doesn't list.
+    std::vector<std::string> gmNodes;
+
+    // Fresh journal for a plan, nothing done yet
+    static UploadJournal begin(const std::string& userId, const UploadPlan& plan);
+    // Same user and file contents. The next upload should be planned with this journal's chunkSize.
+    bool covers(const std::string& userId, const std::string& gmChecksum, const std::string& llChecksum) const;
+    // Same user, same file contents, same generation, same chunking, same bases, both or neither by key
+    bool matches(const std::string& userId, const UploadPlan& plan) const;
+
+    // prefix is "gm" or "ll"
+    std::vector<bool>& done(const std::string& prefix) { return prefix == "gm" ? gmDone : llDone; }
+    const std::vector<bool>& done(const std::string& prefix) const { return prefix == "gm" ? gmDone : llDone; }
+    size_t completedCount() const;
+};
+
+std::string serializeJournal(const UploadJournal& journal);
+std::optional<UploadJournal> parseJournal(const std::string& text);
+
+}
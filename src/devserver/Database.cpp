@@ -0,0 +1,302 @@
+/**
+ * BetterSave - Dev Server Database
+ * Created by: sidastuff
+ */
+
+#include "Database.hpp"
+#include "core/Json.hpp"
+#include <cstdio>
+
+namespace bettersave::devserver {
+
+namespace {
+
+class Parser {
+private:
+    const std::string& m_text;
+    const ParseLimits& m_limits;
+    size_t m_pos = 0;
+
+    void skipWhitespace() {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' ||
+                                         m_text[m_pos] == '\r' || m_text[m_pos] == '\t')) {
+            m_pos++;
+        }
+    }
+
+    bool fail(const std::string& message) {
+        error = message;
+        return false;
+    }
+
+    // Scans a string literal without decoding it, returns the raw literal including quotes
+    bool scanString(std::string& raw) {
+        size_t start = m_pos++;
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (c == '\\') {
+                m_pos += 2;
+                continue;
+            }
+            if (c == '"') {
+                m_pos++;
+                if (m_pos - start - 2 > m_limits.maxStringBytes) {
+                    return fail("String exceeds the maximum length");
+                }
+                raw.assign(m_text, start, m_pos - start);
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) return fail("Invalid character in string");
+            m_pos++;
+        }
+        return fail("Unterminated string");
+    }
+
+    // Keys are decoded so paths match, values are kept in their serialized form
+    bool parseKey(std::string& key) {
+        std::string raw;
+        if (!scanString(raw)) return false;
+        auto object = core::parseFlatJsonObject("{" + raw + ":null}");
+        if (!object || object->empty()) return fail("Invalid key");
+        key = object->begin()->first;
+        if (key.empty() || key.find_first_of(".$#[]") != std::string::npos) {
+            return fail("Invalid key: " + key);
+        }
+        return true;
+    }
+
+public:
+    std::string error;
+
+    Parser(const std::string& text, const ParseLimits& limits) : m_text(text), m_limits(limits) {}
+
+    bool parseValue(JsonNode& out, size_t depth) {
+        if (depth > m_limits.maxDepth) return fail("Data is nested too deeply");
+
+        skipWhitespace();
+        if (m_pos >= m_text.size()) return fail("Unexpected end of data");
+
+        char c = m_text[m_pos];
+        if (c == '{') {
+            m_pos++;
+            skipWhitespace();
+            if (m_pos < m_text.size() && m_text[m_pos] == '}') {
+                m_pos++;
+                return true;
+            }
+            while (true) {
+                skipWhitespace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != '"') return fail("Expected a key");
+                std::string key;
+                if (!parseKey(key)) return false;
+                skipWhitespace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != ':') return fail("Expected ':'");
+                m_pos++;
+
+                JsonNode child;
+                if (!parseValue(child, depth + 1)) return false;
+                if (!child.isNull() || (depth == 0 && m_limits.keepTopLevelNulls)) {
+                    out.children[key] = std::move(child);
+                }
+
+                skipWhitespace();
+                if (m_pos < m_text.size() && m_text[m_pos] == ',') {
+                    m_pos++;
+                    continue;
+                }
+                if (m_pos < m_text.size() && m_text[m_pos] == '}') {
+                    m_pos++;
+                    return true;
+                }
+                return fail("Expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            m_pos++;
+            size_t index = 0;
+            skipWhitespace();
+            if (m_pos < m_text.size() && m_text[m_pos] == ']') {
+                m_pos++;
+                return true;
+            }
+            while (true) {
+                JsonNode child;
+                if (!parseValue(child, depth + 1)) return false;
+                if (!child.isNull()) out.children[std::to_string(index)] = std::move(child);
+                index++;
+
+                skipWhitespace();
+                if (m_pos < m_text.size() && m_text[m_pos] == ',') {
+                    m_pos++;
+                    continue;
+                }
+                if (m_pos < m_text.size() && m_text[m_pos] == ']') {
+                    m_pos++;
+                    return true;
+                }
+                return fail("Expected ',' or ']'");
+            }
+        }
+        if (c == '"') {
+            return scanString(out.scalar);
+        }
+        for (const char* literal : {"true", "false"}) {
+            size_t length = std::char_traits<char>::length(literal);
+            if (m_text.compare(m_pos, length, literal) == 0) {
+                out.scalar = literal;
+                m_pos += length;
+                return true;
+            }
+        }
+        if (m_text.compare(m_pos, 4, "null") == 0) {
+            m_pos += 4;
+            return true;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            size_t start = m_pos;
+            while (m_pos < m_text.size() && std::string("+-.eE0123456789").find(m_text[m_pos]) != std::string::npos) {
+                m_pos++;
+            }
+            out.scalar.assign(m_text, start, m_pos - start);
+            return true;
+        }
+        return fail("Unexpected character");
+    }
+
+    bool finish() {
+        skipWhitespace();
+        return m_pos == m_text.size() || fail("Trailing data");
+    }
+};
+
+void serializeInto(std::string& out, const JsonNode& node) {
+    if (!node.scalar.empty()) {
+        out += node.scalar;
+        return;
+    }
+
+    out += '{';
+    bool first = true;
+    for (const auto& [key, child] : node.children) {
+        if (!first) out += ',';
+        first = false;
+        core::appendJsonString(out, key);
+        out += ':';
+        serializeInto(out, child);
+    }
+    out += '}';
+}
+
+size_t countNodes(const JsonNode& node) {
+    size_t count = 1;
+    for (const auto& [key, child] : node.children) {
+        count += countNodes(child);
+    }
+    return count;
+}
+
+}
+
+bool parseJson(const std::string& text, const ParseLimits& limits, JsonNode& out, std::string& error) {
+    Parser parser(text, limits);
+    out = JsonNode();
+    if (!parser.parseValue(out, 0) || !parser.finish()) {
+        error = parser.error;
+        return false;
+    }
+    return true;
+}
+
+std::string serializeJson(const JsonNode* node) {
+    if (!node || node->isNull()) return "null";
+    std::string out;
+    serializeInto(out, *node);
+    return out;
+}
+
+std::string serializeShallow(const JsonNode* node) {
+    if (!node || node->isNull()) return "null";
+    if (!node->scalar.empty()) return node->scalar;
+
+    std::string out = "{";
+    bool first = true;
+    for (const auto& [key, child] : node->children) {
+        if (!first) out += ',';
+        first = false;
+        core::appendJsonString(out, key);
+        out += ":true";
+    }
+    out += '}';
+    return out;
+}
+
+std::string etagFor(const JsonNode* node) {
+    if (!node || node->isNull()) return "null_etag";
+
+    // FNV-1a over the serialized value, stable for equal data
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : serializeJson(node)) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+std::vector<std::string> splitPath(const std::string& path) {
+    std::vector<std::string> segments;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (end > start) segments.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+    return segments;
+}
+
+const JsonNode* Database::get(const std::vector<std::string>& path) const {
+    const JsonNode* node = &m_root;
+    for (const auto& segment : path) {
+        auto it = node->children.find(segment);
+        if (it == node->children.end()) return nullptr;
+        node = &it->second;
+    }
+    return node->isNull() ? nullptr : node;
+}
+
+void Database::setAt(JsonNode& node, const std::vector<std::string>& path, size_t index, JsonNode value) {
+    if (index == path.size()) {
+        node = std::move(value);
+        return;
+    }
+
+    // Writing below a scalar turns it into an object
+    node.scalar.clear();
+    auto& child = node.children[path[index]];
+    setAt(child, path, index + 1, std::move(value));
+    if (child.isNull()) {
+        node.children.erase(path[index]);
+    }
+}
+
+void Database::set(const std::vector<std::string>& path, JsonNode value) {
+    setAt(m_root, path, 0, std::move(value));
+}
+
+void Database::update(const std::vector<std::string>& path, const JsonNode& update) {
+    for (const auto& [key, child] : update.children) {
+        auto childPath = path;
+        for (auto& segment : splitPath(key)) {
+            childPath.push_back(std::move(segment));
+        }
+        set(childPath, child);
+    }
+}
+
+size_t Database::nodeCount() const {
+    return countNodes(m_root) - 1;
+}
+
+}
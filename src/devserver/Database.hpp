@@ -0,0 +1,60 @@
+/**
+ * BetterSave - Dev Server Database
+ * In-memory JSON tree with Realtime Database write semantics
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bettersave::devserver {
+
+// Leaves hold one serialized JSON scalar, objects hold children. Like RTDB, empty objects are null.
+struct JsonNode {
+    std::string scalar;
+    std::map<std::string, JsonNode> children;
+
+    bool isNull() const { return scalar.empty() && children.empty(); }
+};
+
+struct ParseLimits {
+    size_t maxStringBytes = 10 * 1024 * 1024;
+    size_t maxDepth = 32;
+    // PATCH bodies use null children to delete paths
+    bool keepTopLevelNulls = false;
+};
+
+// Arrays become objects keyed by index and nulls are dropped, as RTDB stores them.
+// Returns false with error set on malformed input or a limit violation.
+bool parseJson(const std::string& text, const ParseLimits& limits, JsonNode& out, std::string& error);
+
+std::string serializeJson(const JsonNode* node);
+// Children replaced by true, scalars returned as-is (?shallow=true)
+std::string serializeShallow(const JsonNode* node);
+std::string etagFor(const JsonNode* node);
+
+std::vector<std::string> splitPath(const std::string& path);
+
+class Database {
+private:
+    JsonNode m_root;
+
+    static void setAt(JsonNode& node, const std::vector<std::string>& path, size_t index, JsonNode value);
+
+public:
+    // nullptr if nothing is stored at the path
+    const JsonNode* get(const std::vector<std::string>& path) const;
+
+    // A null value deletes the path, empty parents are pruned
+    void set(const std::vector<std::string>& path, JsonNode value);
+
+    // PATCH: every child of update is written, keys may be multi-segment ("a/b")
+    void update(const std::vector<std::string>& path, const JsonNode& update);
+
+    size_t nodeCount() const;
+};
+
+}
@@ -0,0 +1,433 @@
+/**
+ * BetterSave - Dev Server
+ * Local stand-in for the Firebase Realtime Database REST API, with fault injection.
+ * Point the databaseUrl setting (or bettersave-cli) at it to test transfers offline.
+ * Created by: sidastuff
+ */
+
+#include "Database.hpp"
+#include "core/Json.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace bettersave::devserver;
+
+namespace {
+
+struct ServerOptions {
+    std::string bindAddress = "127.0.0.1";
+    int port = 9000;
+    int latencyMs = 0;
+    int jitterMs = 0;
+    int64_t bandwidthKbps = 0;  // 0 = unlimited
+    double throttleRate = 0;    // Fraction of requests answered with 429
+    double dropRate = 0;        // Fraction of requests whose connection is dropped without a response
+    size_t maxBodyBytes = 256 * 1024 * 1024;
+    size_t maxStringBytes = 10 * 1024 * 1024;
+    uint64_t seed = 1;
+    bool quiet = false;
+};
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> query;
+    std::map<std::string, std::string> headers;
+    std::string body;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string body;
+    std::map<std::string, std::string> headers;
+};
+
+ServerOptions g_options;
+Database g_database;
+std::mutex g_databaseMutex;
+std::mt19937_64 g_random;
+std::mutex g_randomMutex;
+std::atomic<uint64_t> g_pushCounter{0};
+
+double randomUnit() {
+    std::lock_guard lock(g_randomMutex);
+    return std::uniform_real_distribution<double>(0, 1)(g_random);
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// A '%' not followed by two hex digits is kept as it is
+std::string urlDecode(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        int high = text[i] == '%' && i + 2 < text.size() ? hexDigit(text[i + 1]) : -1;
+        int low = high >= 0 ? hexDigit(text[i + 2]) : -1;
+        if (low >= 0) {
+            out += static_cast<char>(high * 16 + low);
+            i += 2;
+        } else if (text[i] == '+') {
+            out += ' ';
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 412: return "Precondition Failed";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        default: return "Error";
+    }
+}
+
+HttpResponse errorResponse(int status, const std::string& message) {
+    HttpResponse response;
+    response.status = status;
+    response.body = "{\"error\":";
+    bettersave::core::appendJsonString(response.body, message);
+    response.body += "}";
+    return response;
+}
+
+// Simulated link speed: sleep as long as the bytes would take at the configured rate
+void throttle(size_t bytes) {
+    if (g_options.bandwidthKbps <= 0) return;
+    auto micros = static_cast<int64_t>(bytes) * 8 * 1000 / g_options.bandwidthKbps;
+    std::this_thread::sleep_for(std::chrono::microseconds(micros));
+}
+
+bool readRequest(int fd, std::string& buffer, HttpRequest& request, HttpResponse& earlyError) {
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > 64 * 1024) {
+            earlyError = errorResponse(400, "Headers too large");
+            return true;
+        }
+        char chunk[16384];
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) return false;
+        buffer.append(chunk, received);
+    }
+
+    std::string head = buffer.substr(0, headerEnd);
+    buffer.erase(0, headerEnd + 4);
+
+    size_t lineEnd = head.find("\r\n");
+    std::string requestLine = head.substr(0, lineEnd);
+    size_t firstSpace = requestLine.find(' ');
+    size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == std::string::npos || secondSpace == std::string::npos) {
+        earlyError = errorResponse(400, "Malformed request line");
+        return true;
+    }
+    request.method = requestLine.substr(0, firstSpace);
+    std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+
+    size_t queryStart = target.find('?');
+    request.path = urlDecode(target.substr(0, queryStart));
+    if (queryStart != std::string::npos) {
+        std::string query = target.substr(queryStart + 1);
+        size_t start = 0;
+        while (start < query.size()) {
+            size_t end = query.find('&', start);
+            if (end == std::string::npos) end = query.size();
+            std::string pair = query.substr(start, end - start);
+            size_t equals = pair.find('=');
+            request.query[urlDecode(pair.substr(0, equals))] =
+                equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+            start = end + 1;
+        }
+    }
+
+    size_t position = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+    while (position < head.size()) {
+        size_t end = head.find("\r\n", position);
+        if (end == std::string::npos) end = head.size();
+        std::string line = head.substr(position, end - position);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            size_t valueStart = line.find_first_not_of(' ', colon + 1);
+            request.headers[name] = valueStart == std::string::npos ? "" : line.substr(valueStart);
+        }
+        position = end + 2;
+    }
+
+    if (request.headers.count("transfer-encoding")) {
+        earlyError = errorResponse(411, "Chunked bodies are not supported");
+        return true;
+    }
+
+    size_t contentLength = 0;
+    if (auto it = request.headers.find("content-length"); it != request.headers.end()) {
+        contentLength = std::strtoull(it->second.c_str(), nullptr, 10);
+    }
+    if (contentLength > g_options.maxBodyBytes) {
+        earlyError = errorResponse(413, "Request body exceeds the size limit");
+        return true;
+    }
+
+    while (buffer.size() < contentLength) {
+        char chunk[65536];
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) return false;
+        buffer.append(chunk, received);
+    }
+    request.body = buffer.substr(0, contentLength);
+    buffer.erase(0, contentLength);
+    throttle(head.size() + contentLength);
+    return true;
+}
+
+HttpResponse handleRequest(const HttpRequest& request) {
+    // Only *.json paths are part of the REST API
+    const std::string suffix = ".json";
+    if (request.path.size() < suffix.size() ||
+        request.path.compare(request.path.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return errorResponse(404, "Paths must end in .json");
+    }
+    auto path = splitPath(request.path.substr(0, request.path.size() - suffix.size()));
+
+    auto queryValue = [&](const std::string& key) {
+        auto it = request.query.find(key);
+        return it == request.query.end() ? std::string() : it->second;
+    };
+    bool wantsEtag = request.headers.count("x-firebase-etag") && request.headers.at("x-firebase-etag") == "true";
+    bool silent = queryValue("print") == "silent";
+
+    ParseLimits limits;
+    limits.maxStringBytes = g_options.maxStringBytes;
+    limits.keepTopLevelNulls = request.method == "PATCH";
+
+    JsonNode body;
+    if (request.method == "PUT" || request.method == "PATCH" || request.method == "POST") {
+        std::string error;
+        if (!parseJson(request.body, limits, body, error)) {
+            return errorResponse(400, "Invalid data; couldn't parse JSON object. " + error);
+        }
+    }
+
+    std::lock_guard lock(g_databaseMutex);
+    HttpResponse response;
+
+    if (auto ifMatch = request.headers.find("if-match"); ifMatch != request.headers.end()) {
+        auto current = etagFor(g_database.get(path));
+        if (ifMatch->second != current) {
+            response = errorResponse(412, "ETag mismatch");
+            response.headers["ETag"] = current;
+            response.body = serializeJson(g_database.get(path));
+            return response;
+        }
+    }
+
+    if (request.method == "GET") {
+        response.body = queryValue("shallow") == "true" ? serializeShallow(g_database.get(path))
+                                                        : serializeJson(g_database.get(path));
+    } else if (request.method == "PUT") {
+        g_database.set(path, body);
+        response.body = serializeJson(g_database.get(path));
+    } else if (request.method == "PATCH") {
+        if (!body.scalar.empty()) {
+            return errorResponse(400, "Invalid data; couldn't parse JSON object.");
+        }
+        g_database.update(path, body);
+        response.body = request.body;
+    } else if (request.method == "POST") {
+        // Push IDs only need to be unique and ordered here
+        char key[32];
+        std::snprintf(key, sizeof(key), "-BS%016llu", static_cast<unsigned long long>(++g_pushCounter));
+        auto childPath = path;
+        childPath.push_back(key);
+        g_database.set(childPath, body);
+        response.body = std::string("{\"name\":\"") + key + "\"}";
+    } else if (request.method == "DELETE") {
+        g_database.set(path, JsonNode());
+        response.body = "null";
+    } else {
+        return errorResponse(405, "Method not allowed");
+    }
+
+    if (wantsEtag) {
+        response.headers["ETag"] = etagFor(g_database.get(path));
+    }
+    if (silent) {
+        response.status = 204;
+        response.body.clear();
+    }
+    return response;
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) return false;
+        sent += written;
+    }
+    return true;
+}
+
+void serveConnection(int fd) {
+    std::string buffer;
+    while (true) {
+        HttpRequest request;
+        HttpResponse response;
+        response.status = 0;
+        if (!readRequest(fd, buffer, request, response)) break;
+
+        auto start = std::chrono::steady_clock::now();
+        bool keepAlive = response.status == 0;
+        if (auto it = request.headers.find("connection"); it != request.headers.end() && it->second == "close") {
+            keepAlive = false;
+        }
+
+        if (response.status == 0) {
+            if (randomUnit() < g_options.dropRate) {
+                if (!g_options.quiet) std::cout << request.method << " " << request.path << " dropped" << std::endl;
+                break;
+            }
+
+            int delay = g_options.latencyMs;
+            if (g_options.jitterMs > 0) delay += static_cast<int>(randomUnit() * g_options.jitterMs);
+            if (delay > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+            if (randomUnit() < g_options.throttleRate) {
+                response = errorResponse(429, "Too many requests");
+                response.headers["Retry-After"] = "1";
+            } else {
+                response = handleRequest(request);
+            }
+        }
+
+        std::string head = "HTTP/1.1 " + std::to_string(response.status) + " " + reasonPhrase(response.status) + "\r\n";
+        head += "Content-Type: application/json; charset=utf-8\r\n";
+        head += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+        head += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        for (const auto& [name, value] : response.headers) {
+            head += name + ": " + value + "\r\n";
+        }
+        head += "\r\n";
+
+        throttle(head.size() + response.body.size());
+        if (!writeAll(fd, head) || !writeAll(fd, response.body)) break;
+
+        if (!g_options.quiet) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            std::cout << request.method << " " << request.path << " " << response.status << " "
+                      << request.body.size() << "B in, " << response.body.size() << "B out, "
+                      << elapsed.count() << "ms" << std::endl;
+        }
+        if (!keepAlive) break;
+    }
+    ::close(fd);
+}
+
+void printUsage() {
+    std::cerr <<
+        "Usage: bettersave-devserver [options]\n"
+        "  --bind <address>          Address to listen on (default 127.0.0.1)\n"
+        "  --port <port>             Port to listen on (default 9000)\n"
+        "  --latency-ms <ms>         Delay before every response\n"
+        "  --jitter-ms <ms>          Random extra delay, up to this much\n"
+        "  --bandwidth-kbps <kbps>   Cap transfer speed in each direction\n"
+        "  --throttle-rate <0..1>    Fraction of requests answered with 429\n"
+        "  --drop-rate <0..1>        Fraction of connections dropped without a response\n"
+        "  --max-body-bytes <n>      Reject larger request bodies with 413 (default 256MB)\n"
+        "  --max-string-bytes <n>    Reject longer string values with 400 (default 10MB)\n"
+        "  --seed <n>                Seed for the fault injection\n"
+        "  --quiet                   Don't log requests\n";
+}
+
+bool parseOptions(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quiet") {
+            g_options.quiet = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--bind") g_options.bindAddress = value;
+        else if (arg == "--port") g_options.port = std::stoi(value);
+        else if (arg == "--latency-ms") g_options.latencyMs = std::stoi(value);
+        else if (arg == "--jitter-ms") g_options.jitterMs = std::stoi(value);
+        else if (arg == "--bandwidth-kbps") g_options.bandwidthKbps = std::stoll(value);
+        else if (arg == "--throttle-rate") g_options.throttleRate = std::stod(value);
+        else if (arg == "--drop-rate") g_options.dropRate = std::stod(value);
+        else if (arg == "--max-body-bytes") g_options.maxBodyBytes = std::stoull(value);
+        else if (arg == "--max-string-bytes") g_options.maxStringBytes = std::stoull(value);
+        else if (arg == "--seed") g_options.seed = std::stoull(value);
+        else return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        if (!parseOptions(argc, argv)) {
+            printUsage();
+            return 2;
+        }
+    } catch (const std::exception&) {
+        printUsage();
+        return 2;
+    }
+    g_random.seed(g_options.seed);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(g_options.port));
+    if (::inet_pton(AF_INET, g_options.bindAddress.c_str(), &address.sin_addr) != 1 ||
+        ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 128) != 0) {
+        std::cerr << "Could not listen on " << g_options.bindAddress << ":" << g_options.port
+                  << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    std::cout << "BetterSave dev server listening on http://" << g_options.bindAddress << ":" << g_options.port << std::endl;
+
+    while (true) {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        int noDelay = 1;
+        ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        std::thread(serveConnection, client).detach();
+    }
+}
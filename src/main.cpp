@@ -18,6 +18,9 @@
 #include "FirebaseAuth.hpp"
 #include "BetterSaveLogger.hpp"
 #include "AutoBackupScheduler.hpp"
+#include "GameplayGuard.hpp"
+#include "core/Metrics.hpp"
+#include "core/Trace.hpp"
 #include <chrono>
 
 /**
@@ -25,24 +28,47 @@
  */
 using namespace geode::prelude;
 
-// Global auto-backup scheduler hook
-#include <Geode/modify/CCScheduler.hpp>
-class $modify(BetterSaveScheduler, CCScheduler) {
-	void update(float dt) {
-		CCScheduler::update(dt);
-		
-		// Check auto-backup every frame (has internal timing logic)
-		static float checkInterval = 0.0f;
-		checkInterval += dt;
-		
-		// Check every 30 seconds
-		if (checkInterval >= 30.0f) {
-			checkInterval = 0.0f;
-			AutoBackupScheduler::get()->checkAndBackup();
-		}
+/**
+ * Auto-backups are driven by GD's own saves instead of polling every frame.
+ * trySaveGame writes both CCGameManager.dat and CCLocalLevels.dat.
+ */
+#include <Geode/modify/AppDelegate.hpp>
+class $modify(BetterSaveSaveHook, AppDelegate) {
+	void trySaveGame(bool p0) {
+		AppDelegate::trySaveGame(p0);
+		AutoBackupScheduler::get()->markDirty();
+		// Logs are written in the background; make sure they land before a possible exit
+		BetterSaveLogger::get()->flush();
 	}
 };
 
+/**
+ * Report how much main-thread time BetterSave used while the level was running.
+ * With the gameplay guard this should always be zero.
+ */
+#include <Geode/modify/PlayLayer.hpp>
+class $modify(BetterSavePlayLayer, PlayLayer) {
+	void onQuit() {
+		GameplayGuard::get()->logReport();
+		GameplayGuard::get()->resetStats();
+		PlayLayer::onQuit();
+	}
+};
+
+$on_mod(Loaded) {
+	bettersave::core::Tracer::get()->setThreadName("main");
+
+	// Exported metrics say where they came from, so reports can be compared across releases and devices
+	auto metrics = bettersave::core::MetricsRegistry::get();
+	metrics->setLabel("mod_version", Mod::get()->getVersion().toVString());
+	metrics->setLabel("platform", GEODE_PLATFORM_NAME);
+
+	// Wait for the first frame so the director's scheduler is ready
+	Loader::get()->queueInMainThread([]() {
+		AutoBackupScheduler::get()->start();
+	});
+}
+
 /**
  * `$modify` lets you extend and modify GD's classes.
  * To hook a function in Geode, simply $modify the class
@@ -188,9 +214,8 @@ class $modify(MyMenuLayer, MenuLayer) {
 		// Trigger the upload process
 		BetterSaveLogger::get()->info("Backup", "Manual backup triggered via keyboard shortcut");
 		
-		// Create a temporary SaveManagerPopup to use its upload function
-		auto popup = SaveManagerPopup::create();
-		popup->uploadSaveData();
+		// Upload with a progress popup, no Save Manager needed
+		SaveManagerPopup::startUpload();
 		
 		// Show notification
 		Notification::create("BetterSave: Backup Started", NotificationIcon::Info, 3.0f)->show();
@@ -0,0 +1,145 @@
+/**
+ * BetterSave - GD Save Format
+ * Created by: sidastuff
+ */
+
+#include "GdFormat.hpp"
+#include <zlib.h>
+
+namespace bettersave::synth {
+
+namespace {
+
+constexpr char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+int base64Value(unsigned char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '-' || c == '+') return 62;
+    if (c == '_' || c == '/') return 63;
+    return -1;
+}
+
+// windowBits 15 + 16 selects the gzip wrapper
+constexpr int GZIP_WINDOW_BITS = 15 + 16;
+
+}
+
+std::string base64Encode(const std::string& data) {
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t bits = (static_cast<unsigned char>(data[i]) << 16) |
+                        (static_cast<unsigned char>(data[i + 1]) << 8) |
+                        static_cast<unsigned char>(data[i + 2]);
+        out += BASE64_ALPHABET[(bits >> 18) & 63];
+        out += BASE64_ALPHABET[(bits >> 12) & 63];
+        out += BASE64_ALPHABET[(bits >> 6) & 63];
+        out += BASE64_ALPHABET[bits & 63];
+    }
+
+    size_t remaining = data.size() - i;
+    if (remaining > 0) {
+        uint32_t bits = static_cast<unsigned char>(data[i]) << 16;
+        if (remaining == 2) bits |= static_cast<unsigned char>(data[i + 1]) << 8;
+        out += BASE64_ALPHABET[(bits >> 18) & 63];
+        out += BASE64_ALPHABET[(bits >> 12) & 63];
+        out += remaining == 2 ? BASE64_ALPHABET[(bits >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+std::optional<std::string> base64Decode(const std::string& text) {
+    std::string out;
+    out.reserve(text.size() / 4 * 3);
+
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (unsigned char c : text) {
+        // GD tolerates trailing padding and whitespace/nulls left by older versions
+        if (c == '=' || c == '\0' || c == '\n' || c == '\r') continue;
+        int value = base64Value(c);
+        if (value < 0) return std::nullopt;
+
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            out += static_cast<char>((bits >> bitCount) & 0xFF);
+        }
+    }
+    return out;
+}
+
+std::string gzipCompress(const std::string& data, int level) {
+    z_stream stream{};
+    deflateInit2(&stream, level, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY);
+
+    std::string out(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+std::optional<std::string> gzipDecompress(const std::string& data) {
+    z_stream stream{};
+    if (inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK) return std::nullopt;
+
+    std::string out;
+    char buffer[1 << 16];
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    int status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END) return std::nullopt;
+    return out;
+}
+
+void xorInPlace(std::string& data, unsigned char key) {
+    for (auto& c : data) {
+        c = static_cast<char>(c ^ key);
+    }
+}
+
+std::string encodeSaveFile(const std::string& plist, int compressionLevel) {
+    std::string file = base64Encode(gzipCompress(plist, compressionLevel));
+    xorInPlace(file, SAVE_XOR_KEY);
+    return file;
+}
+
+std::optional<std::string> decodeSaveFile(std::string file) {
+    xorInPlace(file, SAVE_XOR_KEY);
+    auto compressed = base64Decode(file);
+    if (!compressed) return std::nullopt;
+    return gzipDecompress(*compressed);
+}
+
+std::string encodeLevelString(const std::string& objects, int compressionLevel) {
+    return base64Encode(gzipCompress(objects, compressionLevel));
+}
+
+std::optional<std::string> decodeLevelString(const std::string& encoded) {
+    auto compressed = base64Decode(encoded);
+    if (!compressed) return std::nullopt;
+    return gzipDecompress(*compressed);
+}
+
+}
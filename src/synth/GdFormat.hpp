@@ -0,0 +1,33 @@
+/**
+ * BetterSave - GD Save Format
+ * The layers Geometry Dash wraps its save files in: plist XML -> gzip -> URL-safe base64 -> XOR 11
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <optional>
+#include <string>
+
+namespace bettersave::synth {
+
+constexpr unsigned char SAVE_XOR_KEY = 11;
+
+// URL-safe alphabet (-_), padded, as GD writes it
+std::string base64Encode(const std::string& data);
+std::optional<std::string> base64Decode(const std::string& text);
+
+// gzip container (not raw zlib), level 0-9
+std::string gzipCompress(const std::string& data, int level = 6);
+std::optional<std::string> gzipDecompress(const std::string& data);
+
+void xorInPlace(std::string& data, unsigned char key);
+
+// Full save file round trip. Level strings (k4) inside the plist use the same
+// gzip + base64 pair without the XOR.
+std::string encodeSaveFile(const std::string& plist, int compressionLevel = 6);
+std::optional<std::string> decodeSaveFile(std::string file);
+
+std::string encodeLevelString(const std::string& objects, int compressionLevel = 6);
+std::optional<std::string> decodeLevelString(const std::string& encoded);
+
+}
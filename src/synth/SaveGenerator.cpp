@@ -0,0 +1,385 @@
+/**
+ * BetterSave - Synthetic Save Generator
+ * Created by: sidastuff
+ */
+
+#include "SaveGenerator.hpp"
+#include "GdFormat.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+namespace bettersave::synth {
+
+namespace {
+
+// std distributions differ between standard libraries, so ranges are derived from the raw
+// engine output to keep datasets identical across platforms
+class Random {
+private:
+    std::mt19937_64 m_engine;
+
+public:
+    explicit Random(uint64_t seed) : m_engine(seed) {}
+
+    int range(int min, int max) {
+        if (max <= min) return min;
+        return min + static_cast<int>(m_engine() % static_cast<uint64_t>(max - min + 1));
+    }
+
+    double unit() {
+        return static_cast<double>(m_engine() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    bool chance(double probability) {
+        return unit() < probability;
+    }
+
+    template <class T>
+    const T& pick(const std::vector<T>& values) {
+        return values[m_engine() % values.size()];
+    }
+};
+
+const std::vector<std::string> NAME_PARTS = {
+    "Sonic", "Wave", "Dash", "Nine", "Circles", "Blood", "Bath", "Fire", "Ice", "Cata",
+    "clysm", "Bloom", "Aftermath", "Zero", "Point", "Deadlocked", "Sky", "Castle", "Night",
+    "Core", "Neon", "Void", "Retro", "Jump", "Theory", "Clutter", "Funk", "Pulse"
+};
+
+const std::vector<std::string> DESCRIPTIONS = {
+    "My first level, please rate!", "Collab with friends", "Harder than it looks",
+    "Work in progress, do not verify", "Layout by me, deco by a friend", ""
+};
+
+// Object palette roughly weighted like real levels: blocks and deco dominate, triggers are rare
+const std::vector<int> BLOCK_IDS = {1, 2, 3, 4, 5, 6, 7, 40, 62, 63, 64, 65, 66, 68, 69, 70, 71};
+const std::vector<int> HAZARD_IDS = {8, 9, 39, 61, 103, 135, 392};
+const std::vector<int> DECO_IDS = {18, 19, 20, 21, 41, 48, 49, 113, 114, 115, 503, 504, 505, 1011, 1012, 1013, 1764, 1765};
+const std::vector<int> TRIGGER_IDS = {29, 30, 899, 901, 1006, 1007, 1049, 1268, 1346, 1616};
+
+// Level string header (kS38 color channels plus kA settings), shared by every level
+const std::string LEVEL_HEADER =
+    "kS38,1_40_2_125_3_255_11_255_12_255_13_255_4_-1_6_1000_7_1_15_1_18_0_8_1|"
+    "1_0_2_102_3_255_11_255_12_255_13_255_4_-1_6_1001_7_1_15_1_18_0_8_1|"
+    "1_0_2_102_3_255_11_255_12_255_13_255_4_-1_6_1009_7_1_15_1_18_0_8_1|"
+    "1_255_2_255_3_255_11_255_12_255_13_255_4_-1_6_1002_5_1_7_1_15_1_18_0_8_1|,"
+    "kA13,0,kA15,0,kA16,0,kA14,,kA6,0,kA7,0,kA25,0,kA17,0,kA18,0,kS39,0,kA2,0,kA3,0,kA8,0,"
+    "kA4,0,kA9,0,kA10,0,kA22,0,kA23,0,kA24,0,kA27,1,kA40,1,kA41,1,kA42,1,kA28,0,kA29,0,"
+    "kA31,1,kA32,1,kA36,0,kA43,0,kA44,0,kA45,1,kA33,1,kA34,1,kA35,0,kA37,1,kA38,1,kA39,1,"
+    "kA19,0,kA26,0,kA20,0,kA21,0,kA11,0;";
+
+SyntheticObject randomObject(Random& random, int x) {
+    SyntheticObject object;
+    double kind = random.unit();
+    if (kind < 0.45) {
+        object.id = random.pick(BLOCK_IDS);
+    } else if (kind < 0.6) {
+        object.id = random.pick(HAZARD_IDS);
+    } else if (kind < 0.97) {
+        object.id = random.pick(DECO_IDS);
+        object.colorChannel = random.chance(0.5) ? random.range(1, 20) : 0;
+    } else {
+        object.id = random.pick(TRIGGER_IDS);
+        object.group = random.range(1, 200);
+    }
+
+    // Editor grid is 30 units, with occasional half-block nudges
+    object.x = x + (random.chance(0.1) ? 15 : 0);
+    object.y = 15 + random.range(0, 12) * 30;
+    object.rotation = random.chance(0.2) ? random.range(1, 3) * 90 : 0;
+    return object;
+}
+
+// Builders repeat small structures across a level, which is what makes level strings compressible
+std::vector<SyntheticObject> generateObjects(Random& random, int count, int startX) {
+    std::vector<SyntheticObject> objects;
+    objects.reserve(count);
+
+    int x = startX;
+    while (static_cast<int>(objects.size()) < count) {
+        int motifSize = random.range(4, 24);
+        std::vector<SyntheticObject> motif;
+        for (int i = 0; i < motifSize; i++) {
+            motif.push_back(randomObject(random, random.range(0, 8) * 30));
+        }
+
+        int repeats = random.range(1, 6);
+        for (int r = 0; r < repeats && static_cast<int>(objects.size()) < count; r++) {
+            for (const auto& part : motif) {
+                if (static_cast<int>(objects.size()) >= count) break;
+                auto object = part;
+                object.x += x;
+                objects.push_back(object);
+            }
+            x += 270;
+        }
+    }
+    return objects;
+}
+
+std::string randomName(Random& random) {
+    std::string name = random.pick(NAME_PARTS);
+    if (random.chance(0.6)) name += " " + random.pick(NAME_PARTS);
+    if (random.chance(0.3)) name += " " + std::to_string(random.range(2, 99));
+    return name;
+}
+
+SyntheticLevel generateLevel(Random& random, int id, int minObjects, int maxObjects) {
+    SyntheticLevel level;
+    level.id = id;
+    level.name = randomName(random);
+    level.description = random.pick(DESCRIPTIONS);
+    level.version = random.range(1, 40);
+    level.attempts = random.range(0, 5000);
+    level.secondsEdited = random.range(60, 400000);
+    level.song = random.chance(0.7) ? random.range(1, 1200000) : 0;
+    level.objects = generateObjects(random, random.range(minObjects, maxObjects), 0);
+    return level;
+}
+
+SyntheticOnlineLevel generateOnlineLevel(Random& random) {
+    SyntheticOnlineLevel level;
+    level.id = random.range(128, 110000000);
+    level.name = randomName(random);
+    level.creator = randomName(random);
+    level.creator.erase(std::remove(level.creator.begin(), level.creator.end(), ' '), level.creator.end());
+    level.stars = random.chance(0.4) ? random.range(1, 10) : 0;
+    level.downloads = random.range(0, 50000000);
+    level.likes = random.range(0, 2000000);
+    level.normalPercent = random.range(0, 100);
+    level.attempts = random.range(0, 20000);
+    return level;
+}
+
+std::string objectString(const std::vector<SyntheticObject>& objects) {
+    std::string out = LEVEL_HEADER;
+    out.reserve(LEVEL_HEADER.size() + objects.size() * 24);
+    for (const auto& object : objects) {
+        out += "1," + std::to_string(object.id) + ",2," + std::to_string(object.x) + ",3," + std::to_string(object.y);
+        if (object.rotation) out += ",6," + std::to_string(object.rotation);
+        if (object.colorChannel) out += ",21," + std::to_string(object.colorChannel);
+        if (object.group) out += ",57," + std::to_string(object.group);
+        out += ';';
+    }
+    return out;
+}
+
+void appendXmlText(std::string& out, const std::string& text) {
+    for (char c : text) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            default: out += c;
+        }
+    }
+}
+
+// GD's compact plist: <k>key</k> followed by <s>, <i>, <r>, <t /> or a nested <d>
+void key(std::string& out, const std::string& name) {
+    out += "<k>";
+    appendXmlText(out, name);
+    out += "</k>";
+}
+
+void stringValue(std::string& out, const std::string& name, const std::string& value) {
+    key(out, name);
+    out += "<s>";
+    appendXmlText(out, value);
+    out += "</s>";
+}
+
+void intValue(std::string& out, const std::string& name, int64_t value) {
+    key(out, name);
+    out += "<i>" + std::to_string(value) + "</i>";
+}
+
+void trueValue(std::string& out, const std::string& name) {
+    key(out, name);
+    out += "<t />";
+}
+
+const char* PLIST_HEADER = "<?xml version=\"1.0\"?><plist version=\"1.0\" gjver=\"2.0\"><dict>";
+const char* PLIST_FOOTER = "</dict></plist>";
+
+const std::string& levelString(SyntheticLevel& level, int compressionLevel) {
+    if (level.encodedLevelString.empty()) {
+        level.encodedLevelString = encodeLevelString(objectString(level.objects), compressionLevel);
+    }
+    return level.encodedLevelString;
+}
+
+}
+
+SaveModel generateSave(const GeneratorConfig& config) {
+    Random random(config.seed);
+    SaveModel model;
+    model.compressionLevel = config.compressionLevel;
+    model.playerName = randomName(random);
+    model.playerName.erase(std::remove(model.playerName.begin(), model.playerName.end(), ' '), model.playerName.end());
+    model.playerUserId = random.range(1000, 250000000);
+
+    for (int i = 1; i <= config.statCount; i++) {
+        model.stats[i] = random.range(0, 1000000);
+    }
+    for (int i = 0; i < config.onlineLevelCount; i++) {
+        model.onlineLevels.push_back(generateOnlineLevel(random));
+    }
+
+    size_t estimatedBytes = 0;
+    while (static_cast<int>(model.levels.size()) < config.levelCount ||
+           (config.targetLocalLevelsBytes > 0 && estimatedBytes < config.targetLocalLevelsBytes)) {
+        auto level = generateLevel(random, model.nextLevelId++, config.minObjects, config.maxObjects);
+        // k4 is already compressed, so it passes through the outer gzip + base64 at about 1:1
+        if (config.targetLocalLevelsBytes > 0) {
+            estimatedBytes += levelString(level, config.compressionLevel).size() + 400;
+        }
+        model.levels.push_back(std::move(level));
+    }
+    return model;
+}
+
+void applyEdits(SaveModel& model, const EditConfig& config) {
+    Random random(config.seed);
+
+    for (int i = 0; i < config.deletedLevels && !model.levels.empty(); i++) {
+        model.levels.erase(model.levels.begin() + random.range(0, static_cast<int>(model.levels.size()) - 1));
+    }
+
+    for (auto& level : model.levels) {
+        if (!random.chance(config.editedLevelFraction)) continue;
+
+        for (auto& object : level.objects) {
+            if (!random.chance(config.objectEditFraction)) continue;
+            if (random.chance(0.5)) {
+                object.x += random.range(-2, 2) * 30;
+                object.y = std::max(15, object.y + random.range(-1, 1) * 30);
+            } else {
+                object.colorChannel = random.range(0, 20);
+            }
+        }
+
+        int endX = 0;
+        for (const auto& object : level.objects) endX = std::max(endX, object.x);
+        auto added = generateObjects(random, config.objectsAddedPerLevel, endX + 30);
+        level.objects.insert(level.objects.end(), added.begin(), added.end());
+
+        level.version++;
+        level.attempts += random.range(0, 200);
+        level.secondsEdited += random.range(60, 7200);
+        level.encodedLevelString.clear();
+    }
+
+    // GD lists the newest level first, so new levels shift every k_<index> after them
+    for (int i = 0; i < config.newLevels; i++) {
+        model.levels.insert(model.levels.begin(),
+                            generateLevel(random, model.nextLevelId++, config.newLevelMinObjects, config.newLevelMaxObjects));
+    }
+
+    for (int i = 0; i < config.statChanges && !model.stats.empty(); i++) {
+        auto it = model.stats.begin();
+        std::advance(it, random.range(0, static_cast<int>(model.stats.size()) - 1));
+        it->second += random.range(1, 500);
+    }
+
+    for (int i = 0; i < config.newOnlineLevels; i++) {
+        model.onlineLevels.push_back(generateOnlineLevel(random));
+    }
+}
+
+std::string renderGameManager(const SaveModel& model) {
+    std::string plist = PLIST_HEADER;
+
+    key(plist, "valueKeeper");
+    plist += "<d>";
+    for (int i = 1; i <= 40; i++) {
+        char name[8];
+        std::snprintf(name, sizeof(name), "gv_%04d", i);
+        stringValue(plist, name, "1");
+    }
+    plist += "</d>";
+
+    stringValue(plist, "playerName", model.playerName);
+    intValue(plist, "playerUserID", model.playerUserId);
+    intValue(plist, "playerFrame", 1 + model.playerUserId % 400);
+    intValue(plist, "playerShip", 1 + model.playerUserId % 150);
+    intValue(plist, "playerColor", model.playerUserId % 40);
+    intValue(plist, "playerColor2", (model.playerUserId / 40) % 40);
+
+    key(plist, "GS_value");
+    plist += "<d>";
+    for (const auto& [id, value] : model.stats) {
+        stringValue(plist, std::to_string(id), std::to_string(value));
+    }
+    plist += "</d>";
+
+    key(plist, "GS_completed");
+    plist += "<d>";
+    for (const auto& level : model.onlineLevels) {
+        if (level.normalPercent == 100) stringValue(plist, "c_" + std::to_string(level.id), "1");
+    }
+    plist += "</d>";
+
+    // Saved online levels keep their metadata but not their level strings
+    key(plist, "GLM_03");
+    plist += "<d>";
+    for (const auto& level : model.onlineLevels) {
+        key(plist, std::to_string(level.id));
+        plist += "<d>";
+        intValue(plist, "kCEK", 4);
+        intValue(plist, "k1", level.id);
+        stringValue(plist, "k2", level.name);
+        stringValue(plist, "k5", level.creator);
+        intValue(plist, "k11", level.downloads);
+        intValue(plist, "k18", level.attempts);
+        intValue(plist, "k19", level.normalPercent);
+        intValue(plist, "k22", level.likes);
+        intValue(plist, "k26", level.stars);
+        trueValue(plist, "k13");
+        plist += "</d>";
+    }
+    plist += "</d>";
+
+    intValue(plist, "binaryVersion", 42);
+    trueValue(plist, "showSongMarkers");
+    plist += PLIST_FOOTER;
+
+    return encodeSaveFile(plist, model.compressionLevel);
+}
+
+std::string renderLocalLevels(SaveModel& model) {
+    std::string plist = PLIST_HEADER;
+
+    key(plist, "LLM_01");
+    plist += "<d>";
+    trueValue(plist, "_isArr");
+    for (size_t i = 0; i < model.levels.size(); i++) {
+        auto& level = model.levels[i];
+        key(plist, "k_" + std::to_string(i));
+        plist += "<d>";
+        intValue(plist, "kCEK", 4);
+        stringValue(plist, "k2", level.name);
+        stringValue(plist, "k3", base64Encode(level.description));
+        stringValue(plist, "k4", levelString(level, model.compressionLevel));
+        stringValue(plist, "k5", model.playerName);
+        trueValue(plist, "k13");
+        intValue(plist, "k16", level.version);
+        intValue(plist, "k18", level.attempts);
+        intValue(plist, "k21", 2);
+        intValue(plist, "k45", level.song);
+        intValue(plist, "k50", 42);
+        intValue(plist, "k80", level.secondsEdited);
+        key(plist, "kI1");
+        plist += "<r>" + std::to_string(level.objects.empty() ? 0 : level.objects.back().x) + "</r>";
+        plist += "</d>";
+    }
+    plist += "</d>";
+
+    intValue(plist, "LLM_02", 42);
+    plist += PLIST_FOOTER;
+
+    return encodeSaveFile(plist, model.compressionLevel);
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * BetterSave - Synthetic Save Generator
+ * Builds valid CCGameManager.dat / CCLocalLevels.dat files from a seed, plus edited follow-ups,
+ * so chunking, dedup, delta and compression work can be measured on reproducible data
+ * Created by: sidastuff
+ */
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bettersave::synth {
+
+struct GeneratorConfig {
+    uint64_t seed = 1;
+    int levelCount = 50;           // Editor levels in CCLocalLevels.dat
+    int minObjects = 200;          // Objects per level, uniform in [min, max]
+    int maxObjects = 20000;
+    int onlineLevelCount = 200;    // Saved online levels (metadata only) in CCGameManager.dat
+    int statCount = 40;            // GS_value entries
+    // If set, keeps adding levels until CCLocalLevels.dat reaches roughly this size
+    size_t targetLocalLevelsBytes = 0;
+    int compressionLevel = 6;
+};
+
+struct EditConfig {
+    uint64_t seed = 2;
+    double editedLevelFraction = 0.1;   // Share of levels touched in this session
+    double objectEditFraction = 0.05;   // Share of objects moved/recolored in a touched level
+    int objectsAddedPerLevel = 50;
+    int newLevels = 1;
+    int newLevelMinObjects = 200;
+    int newLevelMaxObjects = 5000;
+    int deletedLevels = 0;
+    int statChanges = 5;
+    int newOnlineLevels = 3;
+};
+
+struct SyntheticObject {
+    int id = 1;
+    int x = 0;
+    int y = 0;
+    int rotation = 0;
+    int colorChannel = 0;
+    int group = 0;
+};
+
+struct SyntheticLevel {
+    int id = 0;
+    std::string name;
+    std::string description;
+    int version = 1;
+    int attempts = 0;
+    int64_t secondsEdited = 0;
+    int song = 0;
+    std::vector<SyntheticObject> objects;
+    // Cached k4 value, cleared when the objects change
+    std::string encodedLevelString;
+};
+
+struct SyntheticOnlineLevel {
+    int id = 0;
+    std::string name;
+    std::string creator;
+    int stars = 0;
+    int downloads = 0;
+    int likes = 0;
+    int normalPercent = 0;
+    int attempts = 0;
+};
+
+// The parts of a save the generator models; everything else is fixed boilerplate
+struct SaveModel {
+    std::string playerName;
+    int playerUserId = 0;
+    std::map<int, int64_t> stats;
+    std::vector<SyntheticLevel> levels;
+    std::vector<SyntheticOnlineLevel> onlineLevels;
+    int nextLevelId = 1;
+    int compressionLevel = 6;
+};
+
+SaveModel generateSave(const GeneratorConfig& config);
+
+// One play/edit session: some levels edited, some created or deleted, stats bumped
+void applyEdits(SaveModel& model, const EditConfig& config);
+
+// Encoded file contents, ready to write to disk
+std::string renderGameManager(const SaveModel& model);
+std::string renderLocalLevels(SaveModel& model);
+
+}
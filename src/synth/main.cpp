@@ -0,0 +1,129 @@
+/**
+ * BetterSave - Save Generator CLI
+ * Writes a reproducible synthetic save and its edited follow-up versions: <out>/v0, <out>/v1, ...
+ * Created by: sidastuff
+ */
+
+#include "GdFormat.hpp"
+#include "SaveGenerator.hpp"
+#include "core/Integrity.hpp"
+#include "core/SaveFiles.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace bettersave::synth;
+
+namespace {
+
+struct Options {
+    std::string outputDir;
+    GeneratorConfig generator;
+    EditConfig edits;
+    int versions = 1;
+    bool verify = false;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: bettersave-gensave <out-dir> [options]\n"
+        "  --seed <n>               Dataset seed (default 1)\n"
+        "  --levels <n>             Editor levels (default 50)\n"
+        "  --min-objects <n>        Objects per level, lower bound (default 200)\n"
+        "  --max-objects <n>        Objects per level, upper bound (default 20000)\n"
+        "  --online-levels <n>      Saved online levels in CCGameManager.dat (default 200)\n"
+        "  --stats <n>              Player stats (default 40)\n"
+        "  --target-mb <n>          Add levels until CCLocalLevels.dat is about this big\n"
+        "  --compression <0-9>      gzip level for the save and level strings (default 6)\n"
+        "  --versions <n>           Edited versions to write after v0 (default 1)\n"
+        "  --edit-fraction <0..1>   Share of levels edited per version (default 0.1)\n"
+        "  --object-edit-fraction <0..1>  Share of objects changed in an edited level (default 0.05)\n"
+        "  --new-levels <n>         Levels created per version (default 1)\n"
+        "  --deleted-levels <n>     Levels deleted per version (default 0)\n"
+        "  --verify                 Decode every written file and check it round-trips\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    if (argc < 2 || argv[1][0] == '-') return false;
+    options.outputDir = argv[1];
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--verify") {
+            options.verify = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "--seed") options.generator.seed = std::strtoull(value, nullptr, 10);
+        else if (arg == "--levels") options.generator.levelCount = std::atoi(value);
+        else if (arg == "--min-objects") options.generator.minObjects = std::atoi(value);
+        else if (arg == "--max-objects") options.generator.maxObjects = std::atoi(value);
+        else if (arg == "--online-levels") options.generator.onlineLevelCount = std::atoi(value);
+        else if (arg == "--stats") options.generator.statCount = std::atoi(value);
+        else if (arg == "--target-mb") options.generator.targetLocalLevelsBytes = static_cast<size_t>(std::atof(value) * 1024 * 1024);
+        else if (arg == "--compression") options.generator.compressionLevel = std::atoi(value);
+        else if (arg == "--versions") options.versions = std::atoi(value);
+        else if (arg == "--edit-fraction") options.edits.editedLevelFraction = std::atof(value);
+        else if (arg == "--object-edit-fraction") options.edits.objectEditFraction = std::atof(value);
+        else if (arg == "--new-levels") options.edits.newLevels = std::atoi(value);
+        else if (arg == "--deleted-levels") options.edits.deletedLevels = std::atoi(value);
+        else return false;
+    }
+    return true;
+}
+
+bool verifyFile(const std::filesystem::path& path, const std::string& data) {
+    auto plist = decodeSaveFile(data);
+    if (!plist || plist->rfind("<?xml", 0) != 0 || plist->find("</plist>") == std::string::npos) {
+        std::cerr << path.string() << ": does not decode to a plist\n";
+        return false;
+    }
+    if (!bettersave::core::validateSaveBytes(data).isValid) {
+        std::cerr << path.string() << ": fails the integrity check\n";
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    auto model = generateSave(options.generator);
+
+    for (int version = 0; version <= options.versions; version++) {
+        if (version > 0) {
+            // Each version's edits are seeded from the dataset seed, so v3 is always the same v3
+            options.edits.seed = options.generator.seed * 1000003 + version;
+            applyEdits(model, options.edits);
+        }
+
+        auto dir = std::filesystem::path(options.outputDir) / ("v" + std::to_string(version));
+        auto gameManager = renderGameManager(model);
+        auto localLevels = renderLocalLevels(model);
+
+        try {
+            std::filesystem::create_directories(dir);
+            bettersave::core::writeFileSynced(dir / bettersave::core::GAME_MANAGER_FILE, gameManager);
+            bettersave::core::writeFileSynced(dir / bettersave::core::LOCAL_LEVELS_FILE, localLevels);
+        } catch (const std::exception& e) {
+            std::cerr << "Could not write " << dir.string() << ": " << e.what() << "\n";
+            return 1;
+        }
+
+        if (options.verify && (!verifyFile(dir / bettersave::core::GAME_MANAGER_FILE, gameManager) ||
+                               !verifyFile(dir / bettersave::core::LOCAL_LEVELS_FILE, localLevels))) {
+            return 1;
+        }
+
+        std::cout << dir.string() << ": " << model.levels.size() << " levels, "
+                  << gameManager.size() << " + " << localLevels.size() << " bytes\n";
+    }
+    return 0;
+}
@@ -0,0 +1,539 @@
+/**
+ * BetterSave - Tests
+ * Round trips of the save pipeline against a store in a temporary directory
+ * Created by: sidastuff
+ */
+
+#include "core/AdaptiveThrottle.hpp"
+#include "core/Cancellation.hpp"
+#include "core/Delta.hpp"
+#include "core/Integrity.hpp"
+#include "core/KeySync.hpp"
+#include "core/Manifest.hpp"
+#include "core/Plist.hpp"
+#include "core/Storage.hpp"
+#include "core/Transfer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace bettersave::core;
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition "\n"; \
+            g_failures++;                                                                   \
+        }                                                                                   \
+    } while (0)
+
+namespace {
+
+const std::string USER = "tester";
+
+// Bytes that don't compress or repeat, so every chunk differs
+std::string randomBytes(size_t size, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::string data(size, '\0');
+    for (auto& byte : data) byte = static_cast<char>(rng());
+    return data;
+}
+
+// A fresh store, removed again when the test ends
+struct TempStore {
+    std::filesystem::path root;
+    DirectoryStorage storage;
+
+    explicit TempStore(const std::string& name)
+        : root(std::filesystem::temp_directory_path() / ("bettersave_tests_" + name + "_" + newGeneration())),
+          storage(root) {}
+    ~TempStore() {
+        std::error_code error;
+        std::filesystem::remove_all(root, error);
+    }
+
+    // Generations on disk, whether or not a manifest points at them
+    std::vector<std::string> generations() const {
+        std::vector<std::string> names;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(root / "users" / USER / "generations", error)) {
+            names.push_back(entry.path().filename().string());
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    // Nodes on disk, shared by every generation
+    size_t nodes() const {
+        std::error_code error;
+        auto entries = std::filesystem::directory_iterator(root / "users" / USER / "keys", error);
+        return error ? 0 : static_cast<size_t>(std::distance(entries, std::filesystem::directory_iterator()));
+    }
+};
+
+// Stops a backup part way: once puts went through, cancels token if there is one, otherwise
+// fails every put after that like a dropped connection
+class InterruptingStorage : public Storage {
+private:
+    Storage& m_inner;
+    size_t m_putsLeft;
+    CancellationToken* m_token;
+
+public:
+    InterruptingStorage(Storage& inner, size_t puts, CancellationToken* token) : m_inner(inner), m_putsLeft(puts), m_token(token) {}
+
+    bool put(const std::string& key, const std::string& body) override {
+        if (m_putsLeft == 0) {
+            if (m_token) m_token->cancel();
+            else return false;
+        } else {
+            m_putsLeft--;
+        }
+        return m_inner.put(key, body);
+    }
+    std::optional<std::string> get(const std::string& key) override { return m_inner.get(key); }
+    bool remove(const std::string& key) override { return m_inner.remove(key); }
+};
+
+void checkRestores(Storage& storage, const std::string& gameManager, const std::string& localLevels,
+                   const SaveFileCodec* codec = nullptr) {
+    auto restored = restoreSave(storage, USER, nullptr, codec);
+    CHECK(restored.success);
+    CHECK(restored.gameManagerData == gameManager);
+    CHECK(restored.localLevelsData == localLevels);
+}
+
+void testBackupRestore() {
+    TempStore store("roundtrip");
+    auto gameManager = randomBytes(700000, 1);
+    auto localLevels = randomBytes(300000, 2);
+    auto backup = backupSave(store.storage, USER, gameManager, localLevels, 1);
+    CHECK(backup.success);
+    CHECK(!backup.manifest.gmGeneration.empty());
+    CHECK(backup.manifest.gmGeneration == backup.manifest.llGeneration);
+    checkRestores(store.storage, gameManager, localLevels);
+}
+
+void testCancelKeepsPreviousSave() {
+    TempStore store("cancel");
+    auto gameManager = randomBytes(700000, 3);
+    auto localLevels = randomBytes(300000, 4);
+    auto first = backupSave(store.storage, USER, gameManager, localLevels, 1);
+    CHECK(first.success);
+
+    // The second save is as large, every one of its chunks lands where the first one's would
+    CancellationToken token;
+    InterruptingStorage interrupting(store.storage, 4, &token);
+    auto second = backupSave(interrupting, USER, randomBytes(700000, 5), randomBytes(300000, 6), 2, false, &token);
+    CHECK(!second.success);
+    CHECK(second.cancelled);
+    CHECK(second.chunksWritten > 0);
+
+    checkRestores(store.storage, gameManager, localLevels);
+    CHECK(store.generations() == std::vector<std::string>{first.manifest.gmGeneration});
+}
+
+void testFailedPutKeepsPreviousSave() {
+    TempStore store("failure");
+    auto gameManager = randomBytes(500000, 7);
+    auto localLevels = randomBytes(500000, 8);
+    CHECK(backupSave(store.storage, USER, gameManager, localLevels, 1).success);
+
+    InterruptingStorage interrupting(store.storage, 3, nullptr);
+    auto second = backupSave(interrupting, USER, randomBytes(500000, 9), localLevels, 2);
+    CHECK(!second.success);
+    CHECK(!second.cancelled);
+
+    checkRestores(store.storage, gameManager, localLevels);
+    CHECK(store.generations().size() == 1);
+}
+
+void testCommitRemovesReplacedGenerations() {
+    TempStore store("replace");
+    auto localLevels = randomBytes(300000, 10);
+    auto first = backupSave(store.storage, USER, randomBytes(400000, 11), localLevels, 1);
+    CHECK(first.success);
+
+    // LL is unchanged and stays in the first generation, GM moves to a new one
+    auto gameManager = randomBytes(400000, 12);
+    auto second = backupSave(store.storage, USER, gameManager, localLevels, 2, true);
+    CHECK(second.success);
+    CHECK(second.localLevelsUnchanged);
+    CHECK(second.manifest.llGeneration == first.manifest.llGeneration);
+    CHECK(second.manifest.gmGeneration != first.manifest.gmGeneration);
+    CHECK(store.generations().size() == 2);
+    checkRestores(store.storage, gameManager, localLevels);
+
+    // Both change, nothing points at either earlier generation anymore
+    auto third = backupSave(store.storage, USER, randomBytes(400000, 13), randomBytes(300000, 14), 3, true);
+    CHECK(third.success);
+    CHECK(store.generations() == std::vector<std::string>{third.manifest.gmGeneration});
+}
+
+void testReplacedKeysOfOldLayout() {
+    // A save from before generations, rewritten in place by a smaller one that keeps LL
+    SaveManifest previous;
+    previous.gmChunks = 3;
+    previous.gmPages = 1;
+    previous.llChunks = 2;
+    previous.llPages = 1;
+    SaveManifest current = previous;
+    current.gmChunks = 2;
+    current.gmGeneration = "0123abcd";
+
+    auto keys = replacedKeys(USER, previous, current);
+    std::vector<std::string> expected = {chunkKey(USER, "", "gm", 0), chunkKey(USER, "", "gm", 1), chunkKey(USER, "", "gm", 2),
+                                         pageKey(USER, "", "gm", 0)};
+    CHECK(keys == expected);
+
+    // Once committed, the next upload's previous generation goes as a whole
+    SaveManifest next = current;
+    next.gmGeneration = "4567cdef";
+    CHECK(replacedKeys(USER, current, next) == std::vector<std::string>{generationKey(USER, "0123abcd")});
+}
+
+// data rebuilt from a patch against base
+std::optional<std::string> patchRoundTrip(const std::string& base, const std::string& data) {
+    return applyPatch(base, computePatch(computeSignature(base, checksumHex(base)), data));
+}
+
+void testPatchRoundTrip() {
+    auto base = randomBytes(200000, 20);
+    size_t blockSize = deltaBlockSize(base.size());
+    CHECK(base.size() % blockSize != 0);
+
+    std::vector<std::string> edits;
+    edits.push_back(base);
+    // Bytes inserted exactly at a block boundary, and replaced right before and after one
+    edits.push_back(base.substr(0, 3 * blockSize) + "inserted" + base.substr(3 * blockSize));
+    auto replaced = base;
+    replaced[5 * blockSize - 1] ^= 1;
+    replaced[5 * blockSize] ^= 1;
+    edits.push_back(replaced);
+    // Cut to whole blocks, and to a shorter last block than the base's
+    edits.push_back(base.substr(0, 10 * blockSize));
+    edits.push_back(base.substr(0, 10 * blockSize + blockSize / 3));
+    // Edited inside the base's own shorter last block, and grown past it
+    auto tail = base;
+    tail[base.size() - 2] ^= 1;
+    edits.push_back(tail);
+    edits.push_back(base + randomBytes(blockSize + 5, 21));
+    // Blocks moved around, and next to nothing left
+    edits.push_back(base.substr(7 * blockSize) + base.substr(0, 7 * blockSize));
+    edits.push_back(base.substr(0, blockSize / 2));
+    edits.push_back("");
+
+    for (const auto& data : edits) {
+        auto rebuilt = patchRoundTrip(base, data);
+        CHECK(rebuilt && *rebuilt == data);
+    }
+
+    // A base shorter than one block has nothing to copy from
+    auto small = randomBytes(100, 22);
+    auto rebuilt = patchRoundTrip(small, small + "more");
+    CHECK(rebuilt && *rebuilt == small + "more");
+}
+
+void testMalformedPatches() {
+    auto base = randomBytes(100000, 23);
+    auto data = base.substr(0, 40000) + "changed" + base.substr(40000);
+    auto patch = computePatch(computeSignature(base, checksumHex(base)), data);
+    CHECK(applyPatch(base, patch) == data);
+
+    CHECK(!applyPatch(base, ""));
+    CHECK(!applyPatch(base, "not a patch"));
+    auto badMagic = patch;
+    badMagic[0] ^= 1;
+    CHECK(!applyPatch(base, badMagic));
+    // Every truncation either cuts an instruction short or leaves the output short
+    for (size_t length = 0; length < patch.size(); length += std::max<size_t>(1, patch.size() / 64)) {
+        CHECK(!applyPatch(base, patch.substr(0, length)));
+    }
+    CHECK(!applyPatch(base, patch.substr(0, patch.size() - 1)));
+    CHECK(!applyPatch(base, patch + '\xff'));
+    // Copies of blocks a shorter base doesn't have
+    CHECK(!applyPatch(base.substr(0, 50000), patch));
+}
+
+void testCancelledPatchKeepsPreviousSave() {
+    TempStore store("patch");
+    DeltaBases bases;
+    auto localLevels = randomBytes(300000, 24);
+    auto base = randomBytes(600000, 25);
+    auto first = backupSave(store.storage, USER, base, localLevels, 1, true, nullptr, &bases);
+    CHECK(first.success);
+
+    auto edited = base;
+    edited.replace(100000, 5, "edit1");
+    auto second = backupSave(store.storage, USER, edited, localLevels, 2, true, nullptr, &bases);
+    CHECK(second.success);
+    CHECK(second.gameManagerPatched);
+    CHECK(second.manifest.gmGeneration == first.manifest.gmGeneration);
+    CHECK(!second.manifest.gmPatchGeneration.empty() && second.manifest.gmPatchGeneration != first.manifest.gmGeneration);
+    checkRestores(store.storage, edited, localLevels);
+
+    // The next patch goes to its own generation, the committed one stays whole
+    auto reedited = base;
+    reedited.replace(400000, 5, "edit2");
+    CancellationToken token;
+    InterruptingStorage interrupting(store.storage, 0, &token);
+    auto cancelled = backupSave(interrupting, USER, reedited, localLevels, 3, true, &token, &bases);
+    CHECK(cancelled.cancelled);
+    checkRestores(store.storage, edited, localLevels);
+
+    auto third = backupSave(store.storage, USER, reedited, localLevels, 3, true, nullptr, &bases);
+    CHECK(third.success);
+    CHECK(third.gameManagerPatched);
+    checkRestores(store.storage, reedited, localLevels);
+    // The base's generation stays, the first patch's goes
+    auto expected = std::vector<std::string>{first.manifest.gmGeneration, third.manifest.gmPatchGeneration};
+    std::sort(expected.begin(), expected.end());
+    CHECK(store.generations() == expected);
+}
+
+
+// A save like CCGameManager.dat in GD's compact tags or in standard plist ones, with a dict of
+// levels large enough to be split into its entries
+std::string makePlist(bool compact, int levels, const std::string& renamed = "") {
+    std::string key = compact ? "k" : "key";
+    std::string dict = compact ? "d" : "dict";
+    std::string text = compact ? "s" : "string";
+    std::string number = compact ? "i" : "integer";
+    std::string yes = compact ? "<t />" : "<true/>";
+    std::string empty = compact ? "<d />" : "<dict/>";
+    // Standard plists are indented, GD writes everything on one line
+    std::string newline = compact ? "" : "\n";
+    auto element = [](const std::string& tag, const std::string& value) { return "<" + tag + ">" + value + "</" + tag + ">"; };
+    auto entry = [&](const std::string& name, const std::string& value) { return newline + element(key, name) + value; };
+
+    std::string plist = compact ? "<?xml version=\"1.0\"?><plist version=\"1.0\" gjver=\"2.0\">"
+                                : "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<plist version=\"1.0\">\n";
+    plist += "<" + dict + ">";
+    plist += entry("bootups", element(number, "12"));
+    plist += entry("hasRP", yes);
+    plist += entry("valueKeeper", empty);
+    std::string list;
+    for (int i = 0; i < levels; i++) {
+        auto name = "k_" + std::to_string(i);
+        std::string level = entry("k2", element(text, name == renamed ? "Renamed" : "Level " + std::to_string(i)));
+        level += entry("k3", element(number, std::to_string(i * 7)));
+        level += entry("k4", yes);
+        list += entry(name, element(dict, level + newline));
+    }
+    plist += entry("GLM_03", element(dict, list + newline));
+    plist += newline + "</" + dict + ">" + newline + "</plist>";
+    return plist;
+}
+
+void testPlistRoundTrip() {
+    for (bool compact : {true, false}) {
+        auto plist = makePlist(compact, 400);
+        for (size_t splitSize : {size_t(64), size_t(1024), PLIST_SPLIT_SIZE}) {
+            auto nodes = splitPlist(plist, splitSize);
+            CHECK(nodes && nodes->size() > 1);
+            CHECK(nodes && joinPlist(*nodes) == plist);
+        }
+        CHECK(!splitPlist(plist.substr(0, plist.size() / 2)));
+    }
+    CHECK(!splitPlist("not a plist"));
+    CHECK(!splitPlist("<?xml version=\"1.0\"?><plist version=\"1.0\"><d /></plist>"));
+}
+
+void testMalformedPages() {
+    IndexPage page;
+    page.first = 0;
+    page.checksums = {"0123abcd", "89abcdef"};
+    auto body = serializePage(page);
+    auto parsed = parsePage(body);
+    CHECK(parsed && parsed->first == 0 && parsed->checksums == page.checksums);
+
+    CHECK(!parsePage(""));
+    CHECK(!parsePage(body.substr(0, body.size() - 1)));
+    CHECK(!parsePage("{\"s\":0}"));
+    CHECK(!parsePage("{\"s\":-1,\"c\":\"0123abcd\"}"));
+    CHECK(!parsePage("{\"s\":0,\"c\":\"\"}"));
+    CHECK(!parsePage("{\"s\":0,\"c\":\"0123abc\"}"));
+    CHECK(!parsePage("{\"s\":0,\"c\":\"0123ABCD\"}"));
+    // Node ids become storage keys, one that isn't hex could point anywhere
+    CHECK(!parsePage(body, NODE_ID_LENGTH * 2));
+    CHECK(!parsePage("{\"s\":0,\"c\":\"../../../keys/ab\"}", NODE_ID_LENGTH));
+
+    IndexPage second;
+    second.first = 2;
+    second.checksums = {"00000000"};
+    auto joined = joinPages({page, second}, 3);
+    CHECK(joined && joined->size() == 3 && (*joined)[2] == "00000000");
+    CHECK(!joinPages({page, second}, 2));
+    CHECK(!joinPages({page, second}, 4));
+    CHECK(!joinPages({second, page}, 3));
+    CHECK(!joinPages({page, page}, 4));
+    second.first = 3;
+    CHECK(!joinPages({page, second}, 3));
+}
+
+// Stands in for GD's encoding, which core doesn't link: the file is its plist, and a node its text
+const SaveFileCodec PLAIN_CODEC = {
+    [](const std::string& file) -> std::optional<std::string> { return file; },
+    [](const std::string& plist) { return plist; },
+};
+
+void testKeySyncRoundTrip() {
+    TempStore store("keys");
+    auto localLevels = randomBytes(200000, 30);
+    auto gameManager = makePlist(true, 400);
+    auto first = backupSave(store.storage, USER, gameManager, localLevels, 1, true, nullptr, nullptr, &PLAIN_CODEC);
+    CHECK(first.success);
+    CHECK(first.gameManagerByKey);
+    CHECK(first.manifest.gmKeyNodes > 1);
+    CHECK(!first.manifest.gmGeneration.empty());
+    CHECK(store.storage.get(pageKey(USER, first.manifest.gmGeneration, KEY_PAGE_PREFIX, 0)).has_value());
+    CHECK(!store.storage.get(pageKey(USER, "", KEY_PAGE_PREFIX, 0)).has_value());
+    checkRestores(store.storage, gameManager, localLevels, &PLAIN_CODEC);
+
+    // One level renamed: its node goes up, the index is written whole to a new generation
+    auto renamed = makePlist(true, 400, "k_123");
+    auto second = backupSave(store.storage, USER, renamed, localLevels, 2, true, nullptr, nullptr, &PLAIN_CODEC);
+    CHECK(second.success);
+    CHECK(second.gameManagerByKey);
+    CHECK(second.keyNodesSent >= 1 && second.keyNodesSent < static_cast<size_t>(second.manifest.gmKeyNodes) / 4);
+    CHECK(second.manifest.gmGeneration != first.manifest.gmGeneration);
+    CHECK(second.manifest.llGeneration == first.manifest.llGeneration);
+    checkRestores(store.storage, renamed, localLevels, &PLAIN_CODEC);
+
+    // However far the next backup gets, the committed index pages are never touched
+    auto again = makePlist(true, 400, "k_321");
+    CancellationToken token;
+    InterruptingStorage cancelling(store.storage, 1, &token);
+    CHECK(backupSave(cancelling, USER, again, localLevels, 3, true, &token, nullptr, &PLAIN_CODEC).cancelled);
+    checkRestores(store.storage, renamed, localLevels, &PLAIN_CODEC);
+    bool committed = false;
+    for (size_t puts = 0; puts < 8 && !committed; puts++) {
+        InterruptingStorage interrupting(store.storage, puts, nullptr);
+        committed = backupSave(interrupting, USER, again, localLevels, 3, true, nullptr, nullptr, &PLAIN_CODEC).success;
+        checkRestores(store.storage, committed ? again : renamed, localLevels, &PLAIN_CODEC);
+    }
+    CHECK(committed);
+}
+
+// Lets another device commit a backup of gameManager right after the backup running on it commits
+class RacingStorage : public Storage {
+private:
+    Storage& m_inner;
+    std::string m_gameManager;
+    std::string m_localLevels;
+    bool m_raced = false;
+
+public:
+    RacingStorage(Storage& inner, std::string gameManager, std::string localLevels)
+        : m_inner(inner), m_gameManager(std::move(gameManager)), m_localLevels(std::move(localLevels)) {}
+
+    bool put(const std::string& key, const std::string& body) override {
+        bool stored = m_inner.put(key, body);
+        if (stored && key == manifestKey(USER) && !m_raced) {
+            m_raced = true;
+            CHECK(backupSave(m_inner, USER, m_gameManager, m_localLevels, 10, true, nullptr, nullptr, &PLAIN_CODEC).success);
+        }
+        return stored;
+    }
+    std::optional<std::string> get(const std::string& key) override { return m_inner.get(key); }
+    bool remove(const std::string& key) override { return m_inner.remove(key); }
+};
+
+void testKeySyncNodes() {
+    TempStore store("nodes");
+    auto localLevels = randomBytes(200000, 31);
+    auto gameManager = makePlist(true, 400);
+    CHECK(backupSave(store.storage, USER, gameManager, localLevels, 1, true, nullptr, nullptr, &PLAIN_CODEC).success);
+    size_t stored = store.nodes();
+    CHECK(stored > 1);
+
+    // A backup that stops short takes the nodes it sent back out, the committed ones stay
+    auto renamed = makePlist(true, 400, "k_5");
+    CancellationToken token;
+    InterruptingStorage cancelling(store.storage, 0, &token);
+    CHECK(backupSave(cancelling, USER, renamed, localLevels, 2, true, &token, nullptr, &PLAIN_CODEC).cancelled);
+    CHECK(store.nodes() == stored);
+    InterruptingStorage failing(store.storage, 1, nullptr);
+    CHECK(!backupSave(failing, USER, renamed, localLevels, 2, true, nullptr, nullptr, &PLAIN_CODEC).success);
+    CHECK(store.nodes() == stored);
+    checkRestores(store.storage, gameManager, localLevels, &PLAIN_CODEC);
+
+    // A committed rename replaces one node
+    CHECK(backupSave(store.storage, USER, renamed, localLevels, 3, true, nullptr, nullptr, &PLAIN_CODEC).success);
+    CHECK(store.nodes() == stored);
+
+    // Another device commits the renamed save again before this backup removes its stale nodes:
+    // the one it still lists stays
+    RacingStorage racing(store.storage, renamed, localLevels);
+    CHECK(backupSave(racing, USER, makePlist(true, 400, "k_6"), localLevels, 4, true, nullptr, nullptr, &PLAIN_CODEC).success);
+    checkRestores(store.storage, renamed, localLevels, &PLAIN_CODEC);
+    CHECK(store.nodes() == stored);
+}
+
+void testThrottleBaselines() {
+    using namespace std::chrono_literals;
+    ThrottleConfig config;
+    AdaptiveThrottle throttle(config);
+    auto now = AdaptiveThrottle::Clock::now();
+    auto respond = [&](std::chrono::milliseconds latency, size_t bytes) {
+        now += 100ms;
+        return throttle.onResponse(200, latency, bytes, std::nullopt, now);
+    };
+
+    // Manifest and page reads set the small baseline, chunks sized to take far longer aren't spikes
+    for (int i = 0; i < 6; i++) CHECK(respond(60ms, 300) == AdaptiveThrottle::Signal::Ok);
+    for (int i = 0; i < 200; i++) CHECK(respond(250ms, 200000) == AdaptiveThrottle::Signal::Ok);
+    // Nor is a chunk twice the size taking twice as long
+    for (int i = 0; i < 20; i++) CHECK(respond(500ms, 400000) == AdaptiveThrottle::Signal::Ok);
+    CHECK(throttle.rate() == config.maxRate);
+    CHECK(throttle.concurrency() == config.maxConcurrency);
+
+    // A real spike still backs off
+    CHECK(respond(2000ms, 300) == AdaptiveThrottle::Signal::LatencySpike);
+    CHECK(throttle.rate() < config.maxRate);
+    CHECK(respond(60ms, 300) == AdaptiveThrottle::Signal::Ok);
+
+    // A server that stays slower becomes the new baseline, and the throttle climbs back
+    int spikes = 0;
+    for (int i = 0; i < 300; i++) {
+        if (respond(400ms, 300) == AdaptiveThrottle::Signal::LatencySpike) spikes++;
+    }
+    CHECK(spikes > 0 && spikes < config.spikesBeforeRebase);
+    CHECK(throttle.rate() == config.maxRate);
+    CHECK(throttle.concurrency() == config.maxConcurrency);
+}
+
+}
+
+int main() {
+    const std::vector<std::pair<const char*, std::function<void()>>> tests = {
+        {"backup_restore", testBackupRestore},
+        {"cancel_keeps_previous_save", testCancelKeepsPreviousSave},
+        {"failed_put_keeps_previous_save", testFailedPutKeepsPreviousSave},
+        {"commit_removes_replaced_generations", testCommitRemovesReplacedGenerations},
+        {"replaced_keys_of_old_layout", testReplacedKeysOfOldLayout},
+        {"patch_round_trip", testPatchRoundTrip},
+        {"malformed_patches", testMalformedPatches},
+        {"cancelled_patch_keeps_previous_save", testCancelledPatchKeepsPreviousSave},
+        {"plist_round_trip", testPlistRoundTrip},
+        {"malformed_pages", testMalformedPages},
+        {"key_sync_round_trip", testKeySyncRoundTrip},
+        {"key_sync_nodes", testKeySyncNodes},
+        {"throttle_baselines", testThrottleBaselines},
+    };
+    for (const auto& [name, test] : tests) {
+        int before = g_failures;
+        test();
+        std::cout << (g_failures == before ? "ok     " : "FAILED ") << name << "\n";
+    }
+    return g_failures == 0 ? 0 : 1;
+}